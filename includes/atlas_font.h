@@ -0,0 +1,119 @@
+#ifndef _ATLAS_FONT_H_
+#define _ATLAS_FONT_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define ATLAS_FONT_t struct atlas_font_t
+#define ATLAS_HEADER_t struct atlas_header_t
+#define ATLAS_GLYPH_t struct atlas_glyph_t
+#define ATLAS_KERN_t struct atlas_kern_t
+
+#define ATLAS_MAGIC     0x54414246
+#define ATLAS_VERSION   1
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Layout of an atlas file (little endian): header, glyphs sorted by code
+// point, kerning pairs sorted by (left, right), then the coverage bitmaps.
+// Bitmaps are trimmed to the ink of the glyph, A8 stores one byte per pixel,
+// A4 two pixels per byte (high nibble first), rows are padded to a byte.
+struct atlas_header_t
+{
+    uint32_t    magic;
+    uint16_t    version;
+    uint8_t     bpp;
+    uint8_t     pad;
+    uint16_t    line_height;
+    uint16_t    space_advance;
+    uint32_t    nglyphs;
+    uint32_t    nkern;
+    uint32_t    glyph_off;
+    uint32_t    kern_off;
+    uint32_t    bitmap_off;
+};
+
+
+// off_x;off_y is the position of the bitmap from the pen, at the top of the
+// line box.
+struct atlas_glyph_t
+{
+    uint32_t    cp;
+    uint16_t    w;
+    uint16_t    h;
+    int16_t     off_x;
+    int16_t     off_y;
+    uint16_t    advance;
+    uint16_t    pad;
+    uint32_t    offset;
+};
+
+
+struct atlas_kern_t
+{
+    uint32_t    left;
+    uint32_t    right;
+    int16_t     adjust;
+    int16_t     pad;
+};
+
+
+struct atlas_font_t
+{
+    int                     fd;
+    size_t                  map_size;
+    const uint8_t*          data;
+    const ATLAS_HEADER_t*   hdr;
+    const ATLAS_GLYPH_t*    glyphs;
+    const ATLAS_KERN_t*     kerns;
+    const uint8_t*          bitmaps;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Map a glyph atlas file produced by the fbatlas tool.
+// * @param: *font: the structure to initialize.
+// * @param: *path: path of the atlas file.
+// * @return: 1 in case of an error, 0 otherwise.
+int atlas_load(ATLAS_FONT_t* font, const char* path);
+
+// * Unmap the atlas.
+// * @param: *font: the atlas to free.
+void atlas_free(ATLAS_FONT_t* font);
+
+// * Return the glyph of a code point.
+// * @param: *font: the atlas where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: the glyph, NULL if the atlas does not have it.
+const ATLAS_GLYPH_t* atlas_glyph(ATLAS_FONT_t* font, uint32_t cp);
+
+// * Return the kerning adjustment between two code points.
+// * @param: *font : the atlas.
+// * @param: left  : the code point on the left.
+// * @param: right : the code point on the right.
+// * @return: the adjustment to add to the advance, in pixels.
+int atlas_kern(ATLAS_FONT_t* font, uint32_t left, uint32_t right);
+
+// * Blend a UTF-8 string over the screen, the background is kept.
+// * @param: *fb  : the framebuffer where the string is drawn.
+// * @param: *font: the atlas to use.
+// * @param: *str : the UTF-8 string to draw.
+// * @param: x    : x position of the pen.
+// * @param: y    : y position of the top of the line.
+// * @param: color: color of the letters.
+// * @return: the x position of the pen after the string.
+int atlas_print_utf8(FRAMEBUFFER_t* fb, ATLAS_FONT_t* font, const char* str,
+                     int x, int y, COLOR_t color);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _BLIT_H_
+#define _BLIT_H_
+
+#include <stdint.h>
+
+#include "graphics.h"
+#include "colors.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+
+// Filters of the scaled and rotated blits.
+#define BLIT_NEAREST    0
+#define BLIT_BILINEAR   1
+
+// Source coordinates are 16.16 fixed point.
+#define BLIT_SHIFT      16
+#define BLIT_ONE        (1 << BLIT_SHIFT)
+
+// Widest and tallest source of blit_scaled, its coordinates are unsigned
+// 16.16 in 32 bits.
+#define BLIT_SRC_MAX    0xFFFF
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Return the sine and cosine of an angle in 16.16 fixed point.
+// * @param: angle: the angle in degrees, any value.
+// * @param: *s   : sine of the angle.
+// * @param: *c   : cosine of the angle.
+void blit_sincos(int angle, int32_t* s, int32_t* c);
+
+// * Draw a RECT_CP_t stretched to w * h pixels. The destination is clipped
+// * once, the rows only step the source coordinates. A source wider or
+// * taller than BLIT_SRC_MAX is not drawn.
+// * @param: *fb   : FRAMEBUFFER_t where the copy will be drawn.
+// * @param: *src  : the RECT_CP_t to draw.
+// * @param: x     : x coordinate of the top-left corner, can be off screen.
+// * @param: y     : y coordinate of the top-left corner, can be off screen.
+// * @param: w     : width of the drawn rectangle.
+// * @param: h     : height of the drawn rectangle.
+// * @param: filter: BLIT_NEAREST or BLIT_BILINEAR.
+void blit_scaled(FRAMEBUFFER_t* fb, RECT_CP_t* src, int x, int y,
+                 uint_t w, uint_t h, int filter);
+
+// * Draw a RECT_CP_t rotated clockwise around a pivot. Each row only draws
+// * the span that maps inside the source, computed before the row.
+// * @param: *fb   : FRAMEBUFFER_t where the copy will be drawn.
+// * @param: *src  : the RECT_CP_t to draw.
+// * @param: cx    : x coordinate of the pivot on screen.
+// * @param: cy    : y coordinate of the pivot on screen.
+// * @param: px    : x coordinate of the pivot in the source.
+// * @param: py    : y coordinate of the pivot in the source.
+// * @param: angle : rotation in degrees, any value.
+// * @param: filter: BLIT_NEAREST or BLIT_BILINEAR.
+void blit_rotated(FRAMEBUFFER_t* fb, RECT_CP_t* src, int cx, int cy,
+                  int px, int py, int angle, int filter);
+
+#endif
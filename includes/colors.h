@@ -2,6 +2,7 @@
 #ifndef _COLOR_H_
 #define _COLOR_H_
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stdint.h>
 
@@ -27,9 +28,31 @@
 // * _ DEFINITIONS _____________________________________________________________
 #define COLOR_t uint16_t 
 
+#define PALETTE_SIZE 16
+
+// Convert 8 bits r, g, b components to a 16 bits color (truncating).
+#define RGB888_TO_565(r, g, b) \
+    ((COLOR_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3)))
+
 // * _ FUNCTIONS _______________________________________________________________
+
+// * Return a color of the active palette.
+// * @param: c: index of the color (0 - 15), out of range index return the last
+// *           color of the palette.
+// * @return: the 16 bits color.
 unsigned short palette(int c); 
 
+// * Swap the active palette, the table is used in place and must stay valid.
+// * @param: *table: PALETTE_SIZE colors, NULL to restore the default palette.
+void palette_set(const COLOR_t* table);
+
+// * Load a palette from a text file containing one RRGGBB hex color per line.
+// * @param: *path : path of the palette file.
+// * @param: *table: PALETTE_SIZE colors filled with the file content, missing
+// *                 entries keep their value.
+// * @return: 1 in case of an error, 0 otherwise.
+int palette_load(const char* path, COLOR_t* table);
+
 // * Return a color from r, g, b value. (r: 5 bits, g: 6bits, b: 5bits). 
 // * @param: r: 5 bits red value. 
 // * @param: g: 6 bits green value. 
@@ -45,4 +68,60 @@ COLOR_t color_from_rgb(uint8_t r, uint8_t g, uint8_t b);
 // * @return: the 16 bits blended color. 
 COLOR_t blend_16bits_color(COLOR_t src, COLOR_t dst, uint8_t alpha);
 
+// * Blend a color over another one with a 5 bits alpha, the three components
+// * are blended at once in a 32 bits word.
+// * @param: bg   : the color of the pixel under.
+// * @param: fg   : the color drawn over it.
+// * @param: alpha: opacity of fg (0 to 32).
+// * @return: the 16 bits blended color.
+static inline COLOR_t blend_565_a5(COLOR_t bg, COLOR_t fg, uint8_t alpha)
+{
+    uint32_t b;
+    uint32_t f;
+
+    // Spread the color as -g-r-b so each component has room to overflow.
+    b = (bg | ((uint32_t)bg << 16)) & 0x07E0F81F;
+    f = (fg | ((uint32_t)fg << 16)) & 0x07E0F81F;
+    b = ((((f - b) * alpha) >> 5) + b) & 0x07E0F81F;
+    return (COLOR_t)((b >> 16) | b);
+}
+
+// * Return a color from 8 bits r, g, b value with 4x4 ordered dithering.
+// * @param: r: 8 bits red value.
+// * @param: g: 8 bits green value.
+// * @param: b: 8 bits blue value.
+// * @param: x: x position of the pixel on screen.
+// * @param: y: y position of the pixel on screen.
+// * @return: the 16 bits color.
+COLOR_t color_from_rgb888_dither(uint8_t r, uint8_t g, uint8_t b,
+                                 unsigned int x, unsigned int y);
+
+// * Convert a span of packed 24 bits RGB pixels into 16 bits colors.
+// * @param: *dst  : destination of the n converted colors.
+// * @param: *src  : n pixels stored as r, g, b bytes.
+// * @param: n     : number of pixels to convert.
+// * @param: x     : x position of the first pixel on screen (for dithering).
+// * @param: y     : y position of the span on screen (for dithering).
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void rgb888_to_565_span(COLOR_t* dst, const uint8_t* src, unsigned int n,
+                        unsigned int x, unsigned int y, int dither);
+
+// * Convert a span of 32 bits ARGB pixels into 16 bits colors, alpha is
+// * ignored.
+// * @param: *dst  : destination of the n converted colors.
+// * @param: *src  : n pixels stored as 0xAARRGGBB words.
+// * @param: n     : number of pixels to convert.
+// * @param: x     : x position of the first pixel on screen (for dithering).
+// * @param: y     : y position of the span on screen (for dithering).
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void argb8888_to_565_span(COLOR_t* dst, const uint32_t* src, unsigned int n,
+                          unsigned int x, unsigned int y, int dither);
+
+// * Expand a span of 16 bits colors into packed 24 bits RGB pixels, the low
+// * bits are filled by replicating the high ones so white stays 0xFFFFFF.
+// * @param: *dst: destination of the n pixels stored as r, g, b bytes.
+// * @param: *src: n colors to convert.
+// * @param: n   : number of pixels to convert.
+void rgb565_to_888_span(uint8_t* dst, const COLOR_t* src, unsigned int n);
+
 #endif
\ No newline at end of file
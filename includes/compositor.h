@@ -0,0 +1,146 @@
+#ifndef _COMPOSITOR_H_
+#define _COMPOSITOR_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "surface.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define LAYER_t struct layer_t
+#define COMPOSITOR_t struct compositor_t
+
+// Side of the screen tiles the damage is tracked with, a 32x32 tile of 16
+// bits pixels is 2 KB.
+#define COMPOSITOR_TILE     32
+
+#define LAYER_NONE          -1
+#define LAYER_OPAQUE        255
+
+// Flags of layer_add().
+#define LAYER_ALPHA_PIXEL   0x01
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// view is a framebuffer over the pixels of the layer, every primitive can
+// render into it, then layer_damage() tells the compositor what changed.
+// alpha is NULL or one 0..255 coverage per pixel, multiplied by opacity.
+struct layer_t
+{
+    FRAMEBUFFER_t   view;
+    COLOR_t*        pix;
+    uint8_t*        alpha;
+    int             x;
+    int             y;
+    uint_t          w;
+    uint_t          h;
+    int             z;
+    uint8_t         visible;
+    uint8_t         opacity;
+};
+
+
+// order holds the layer ids sorted from the bottom to the top, layers with
+// the same z are stacked in creation order. damage has one byte per tile.
+// Screen pixels covered by no layer are filled with bgcolor.
+struct compositor_t
+{
+    FRAMEBUFFER_t*  fb;
+    LAYER_t*        layers;
+    int*            order;
+    uint_t          nlayers;
+    uint_t          max_layers;
+    COLOR_t         bgcolor;
+
+    uint_t          tiles_x;
+    uint_t          tiles_y;
+    uint8_t*        damage;
+
+    unsigned long   tiles_composited;
+    unsigned long   pixels_blended;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize a compositor without any layer, the whole screen is damaged.
+// * @param: *comp      : the structure to initialize.
+// * @param: *fb        : the framebuffer that receives the final image.
+// * @param: max_layers : maximum number of layers.
+// * @param: bgcolor    : color of the pixels covered by no layer.
+// * @return: 1 in case of an error, 0 otherwise.
+int compositor_init(COMPOSITOR_t* comp, FRAMEBUFFER_t* fb, uint_t max_layers,
+                    COLOR_t bgcolor);
+
+// * Free the compositor and the pixels of every layer.
+// * @param: *comp: the compositor to free.
+void compositor_free(COMPOSITOR_t* comp);
+
+// * Add a visible and opaque layer cleared to black, at 0;0.
+// * @param: *comp : the compositor.
+// * @param: w     : width of the layer.
+// * @param: h     : height of the layer.
+// * @param: z     : stacking order, higher is on top.
+// * @param: flags : LAYER_ALPHA_PIXEL to allocate a per-pixel alpha plane,
+// *                cleared to transparent.
+// * @return: the id of the layer, LAYER_NONE in case of an error.
+int layer_add(COMPOSITOR_t* comp, uint_t w, uint_t h, int z, uint_t flags);
+
+// * Return a layer of the compositor.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @return: the layer, NULL if the id is not valid.
+LAYER_t* layer_get(COMPOSITOR_t* comp, int id);
+
+// * Notify that an area of a layer has been redrawn.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @param: x    : x coordinate of the area in the layer.
+// * @param: y    : y coordinate of the area in the layer.
+// * @param: w    : width of the area.
+// * @param: h    : height of the area.
+void layer_damage(COMPOSITOR_t* comp, int id, uint_t x, uint_t y, uint_t w,
+                  uint_t h);
+
+// * Move a layer, the old and the new areas are damaged.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @param: x    : new x position on screen, can be negative.
+// * @param: y    : new y position on screen, can be negative.
+void layer_move(COMPOSITOR_t* comp, int id, int x, int y);
+
+// * Change the stacking order of a layer.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @param: z    : new stacking order.
+void layer_set_z(COMPOSITOR_t* comp, int id, int z);
+
+// * Show or hide a layer, the layers below are uncovered without being
+// * redrawn by the caller.
+// * @param: *comp   : the compositor.
+// * @param: id      : id of the layer.
+// * @param: visible : 1 to show the layer, 0 to hide it.
+void layer_set_visible(COMPOSITOR_t* comp, int id, int visible);
+
+// * Set the global opacity of a layer.
+// * @param: *comp   : the compositor.
+// * @param: id      : id of the layer.
+// * @param: opacity : 0 (invisible) to LAYER_OPAQUE.
+void layer_set_opacity(COMPOSITOR_t* comp, int id, uint8_t opacity);
+
+// * Damage the whole screen.
+// * @param: *comp: the compositor.
+void compositor_damage_all(COMPOSITOR_t* comp);
+
+// * Recomposite the damaged tiles into the framebuffer. In each tile row the
+// * layers under the topmost opaque layer covering the row are skipped.
+// * @param: *comp: the compositor.
+// * @return: the number of tiles composited.
+uint_t compositor_render(COMPOSITOR_t* comp);
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef _CONSOLE_H_
+#define _CONSOLE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "colors.h"
+#include "iso_font.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define CONSOLE_CELL_t struct console_cell_t
+#define CONSOLE_t struct console_t
+
+// Attribute of a cell: foreground palette index in the low 4 bits,
+// background palette index in the high 4 bits.
+#define CONSOLE_ATTR(fg, bg)    ((uint8_t)(((bg) & 0x0F) << 4 | ((fg) & 0x0F)))
+#define CONSOLE_ATTR_FG(a)      ((a) & 0x0F)
+#define CONSOLE_ATTR_BG(a)      ((a) >> 4)
+
+// Default attribute, white on black.
+#define CONSOLE_ATTR_DEFAULT    CONSOLE_ATTR(15, 0)
+
+#define CONSOLE_TAB             8
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+struct console_cell_t
+{
+    uint8_t     ch;
+    uint8_t     attr;
+};
+
+
+// cells is a ring of max_lines lines of cols cells, allocated once. head is
+// the slot of the oldest line and the newest one is head + nlines - 1, the
+// line being written. view is the number of lines the viewport is scrolled
+// back from the newest one, 0 follows the live tail.
+struct console_t
+{
+    FRAMEBUFFER_t*  fb;
+    uint_t          x;
+    uint_t          y;
+    uint_t          cols;
+    uint_t          rows;
+
+    CONSOLE_CELL_t* cells;
+    uint_t          max_lines;
+    uint_t          head;
+    uint_t          nlines;
+    uint_t          col;
+    uint_t          view;
+    uint8_t         attr;
+
+    unsigned long   lines_dropped;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize a console over an area of the screen, and clear it.
+// * @param: *con     : the structure to initialize.
+// * @param: *fb      : the framebuffer where the console is drawn.
+// * @param: x        : x coordinate of the area.
+// * @param: y        : y coordinate of the area.
+// * @param: w        : width of the area, in pixels.
+// * @param: h        : height of the area, in pixels.
+// * @param: max_lines: lines kept in the scrollback, at least the rows of
+// *                    the area.
+// * @return: 1 in case of an error, 0 otherwise.
+int console_init(CONSOLE_t* con, FRAMEBUFFER_t* fb, uint_t x, uint_t y,
+                 uint_t w, uint_t h, uint_t max_lines);
+
+// * Free the scrollback of the console.
+// * @param: *con: the console to free.
+void console_free(CONSOLE_t* con);
+
+// * Set the attribute of the next chars.
+// * @param: *con: the console.
+// * @param: fg  : palette index of the letters.
+// * @param: bg  : palette index of the background.
+void console_set_attr(CONSOLE_t* con, uint8_t fg, uint8_t bg);
+
+// * Write a char, '\n', '\r' and '\t' are handled and a line wraps at the
+// * right edge. The char is drawn only when the viewport follows the tail.
+// * @param: *con: the console.
+// * @param: c   : the char.
+void console_putc(CONSOLE_t* con, char c);
+
+// * Write n chars of a buffer.
+// * @param: *con: the console.
+// * @param: *buf: the chars.
+// * @param: n   : number of chars.
+void console_write(CONSOLE_t* con, const char* buf, size_t n);
+
+// * Write a string.
+// * @param: *con: the console.
+// * @param: *str: the string.
+void console_puts(CONSOLE_t* con, const char* str);
+
+// * Move the viewport in the scrollback and redraw it if it moved.
+// * @param: *con: the console.
+// * @param: n   : lines to scroll back, negative to go toward the tail.
+void console_scroll(CONSOLE_t* con, int n);
+
+// * Scroll the viewport one page back.
+// * @param: *con: the console.
+void console_page_up(CONSOLE_t* con);
+
+// * Scroll the viewport one page toward the tail.
+// * @param: *con: the console.
+void console_page_down(CONSOLE_t* con);
+
+// * Draw the whole viewport from the scrollback, after the area has been
+// * overwritten.
+// * @param: *con: the console.
+void console_redraw(CONSOLE_t* con);
+
+#endif
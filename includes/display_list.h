@@ -0,0 +1,101 @@
+#ifndef _DISPLAY_LIST_H_
+#define _DISPLAY_LIST_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "iso_font.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define DISPLAY_LIST_t struct display_list_t
+#define DL_CMD_t struct dl_cmd_t
+
+#define DL_CMD_FILL 0
+#define DL_CMD_TEXT 1
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Recorded primitive, x0;y0 - x1;y1 is its bounding box clipped to the screen.
+struct dl_cmd_t
+{
+    uint8_t     type;
+    uint8_t     live;
+    COLOR_t     fgcolor;
+    COLOR_t     bgcolor;
+    uint_t      x0;
+    uint_t      y0;
+    uint_t      x1;
+    uint_t      y1;
+    const char* str;
+};
+
+
+// The counters are cumulative over every submit, reset them by hand.
+struct display_list_t
+{
+    FRAMEBUFFER_t*  fb;
+    DL_CMD_t*       cmds;
+    uint_t          ncmds;
+    uint_t          max_cmds;
+
+    unsigned long   pixels_drawn;
+    unsigned long   pixels_saved;
+    uint_t          cmds_culled;
+    uint_t          cmds_merged;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize an empty display list.
+// * @param: *dl      : the structure to initialize.
+// * @param: *fb      : the framebuffer where the list will be rasterized.
+// * @param: max_cmds : maximum number of commands recorded between submits.
+// * @return: 1 in case of an error, 0 otherwise.
+int dl_init(DISPLAY_LIST_t* dl, FRAMEBUFFER_t* fb, uint_t max_cmds);
+
+// * Free the memory used by the display list.
+// * @param: *dl: the display list to free.
+void dl_free(DISPLAY_LIST_t* dl);
+
+// * Record a fill of the entire screen.
+// * @param: *dl  : the display list where the command is recorded.
+// * @param: color: color of the screen.
+// * @return: 1 if the list is full, 0 otherwise.
+int dl_fill_screen(DISPLAY_LIST_t* dl, COLOR_t color);
+
+// * Record a filled rectangle.
+// * @param: *dl  : the display list where the command is recorded.
+// * @param: x    : start x coordinate.
+// * @param: y    : start y coordinate.
+// * @param: w    : width of the rectangle.
+// * @param: h    : height of the rectangle.
+// * @param: color: color of the rectangle.
+// * @return: 1 if the list is full, 0 otherwise.
+int dl_draw_rect(DISPLAY_LIST_t* dl, uint_t x, uint_t y,
+                 uint_t w, uint_t h, COLOR_t color);
+
+// * Record a string drawn on a single line, the string must stay valid until
+// * the list is submitted.
+// * @param: *dl    : the display list where the command is recorded.
+// * @param: *str   : the string to draw.
+// * @param: x      : x position of the first char.
+// * @param: y      : y position of the first char.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the chars.
+// * @return: 1 if the list is full, 0 otherwise.
+int dl_print_str(DISPLAY_LIST_t* dl, const char* str, uint_t x, uint_t y,
+                 COLOR_t fgcolor, COLOR_t bgcolor);
+
+// * Optimize and rasterize the recorded commands, then empty the list.
+// * Commands fully covered by a later rectangle are culled, consecutive fills
+// * of the same color are merged and the list is sorted by scanline without
+// * reordering overlapping commands.
+// * @param: *dl: the display list to submit.
+void dl_submit(DISPLAY_LIST_t* dl);
+
+#endif
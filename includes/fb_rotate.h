@@ -0,0 +1,65 @@
+#ifndef _FB_ROTATE_H_
+#define _FB_ROTATE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "fb_trace.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define ROTATION_t struct rotation_t
+
+// Take the orientation from vinfo.rotate (FB_ROTATE_UR, CW, UD, CCW).
+#define ROTATION_FROM_VINFO  -1
+
+// Side of the square tiles transposed at once on flush, two 16x16 tiles of
+// 16 bits pixels fit in 1 KB of cache.
+#define ROTATION_BLOCK       16
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// view is the logical framebuffer every primitive renders into, its pixels
+// are the shadow buffer (or the screen itself without rotation).
+struct rotation_t
+{
+    FRAMEBUFFER_t*  fb;
+    FRAMEBUFFER_t   view;
+    COLOR_t*        shadow;
+    uint_t          degrees;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Set up a logical orientation of the screen. The logical picture is
+// * turned clockwise by degrees when it is flushed to the panel.
+// * @param: *rot   : the structure to initialize.
+// * @param: *fb    : the physical framebuffer.
+// * @param: degrees: 0, 90, 180, 270 or ROTATION_FROM_VINFO.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_rotation_init(ROTATION_t* rot, FRAMEBUFFER_t* fb, int degrees);
+
+// * Free the shadow buffer of the rotation.
+// * @param: *rot: the rotation to free.
+void fb_rotation_free(ROTATION_t* rot);
+
+// * Copy the whole logical view onto the panel.
+// * @param: *rot: the rotation to flush.
+void fb_rotation_flush(ROTATION_t* rot);
+
+// * Copy an area of the logical view onto the panel, the area is rotated
+// * ROTATION_BLOCK x ROTATION_BLOCK pixels at a time.
+// * @param: *rot: the rotation to flush.
+// * @param: x   : logical x coordinate of the top-left corner of the area.
+// * @param: y   : logical y coordinate of the top-left corner of the area.
+// * @param: w   : width of the area.
+// * @param: h   : height of the area.
+void fb_rotation_flush_rect(ROTATION_t* rot, uint_t x, uint_t y,
+                            uint_t w, uint_t h);
+
+#endif
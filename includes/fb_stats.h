@@ -0,0 +1,99 @@
+#ifndef _FB_STATS_H_
+#define _FB_STATS_H_
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define FB_STAT_t struct fb_stat_t
+
+// Environment variable that enables the counters at runtime.
+#define FB_STATS_ENV "FBTOOLS_STATS"
+
+// Primitives instrumented in graphics.c, and the strip chart push whose
+// pixels counter holds the samples pushed.
+#define STAT_FILL_SCREEN     0
+#define STAT_DRAW_PIXEL      1
+#define STAT_GET_PIXEL       2
+#define STAT_PRINT_CHAR      3
+#define STAT_PRINT_STR       4
+#define STAT_SCROLL          5
+#define STAT_COPY_RECT       6
+#define STAT_WRITE_RECT      7
+#define STAT_WRITE_RECT_A    8
+#define STAT_H_LINE          9
+#define STAT_V_LINE          10
+#define STAT_LINE            11
+#define STAT_RECT            12
+#define STAT_WRITE_RECT_K    13
+#define STAT_STRIP_PUSH      14
+#define STAT_COUNT_MAX       15
+
+// Only the outermost primitive is recorded, so draw_rect does not also count
+// the draw_h_line and draw_pixel calls it is made of. The same probes feed the
+// trace recorder (fb_trace.h), without FB_STATS nor FB_TRACE the macros expand
+// to nothing.
+#if defined(FB_STATS) || defined(FB_TRACE)
+#define STAT_BEGIN()            uint64_t stat_t0 = fb_stats_begin()
+#define STAT_END(id, px, rd)    fb_stats_end((id), (px), (rd), stat_t0)
+#define STAT_COUNT(id, px, rd)  fb_stats_count((id), (px), (rd))
+#else
+#define STAT_BEGIN()
+#define STAT_END(id, px, rd)
+#define STAT_COUNT(id, px, rd)
+#endif
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+struct fb_stat_t
+{
+    unsigned long   calls;
+    unsigned long   pixels;
+    unsigned long   bytes_read;
+    uint64_t        ns;
+};
+
+
+// Name of each primitive, indexed by STAT_* id.
+extern const char* FB_STAT_NAMES[STAT_COUNT_MAX];
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Enable the counters if FBTOOLS_STATS is set and dump them on SIGUSR1.
+void fb_stats_init(void);
+
+// * Enable or disable the counters at runtime.
+// * @param: enable: 1 to enable the counters, 0 to disable them.
+void fb_stats_enable(int enable);
+
+// * Clear every counter.
+void fb_stats_reset(void);
+
+// * Print the counters of each primitive.
+// * @param: *out: the stream where the counters are printed.
+void fb_stats_dump(FILE* out);
+
+// * Start measuring a primitive.
+// * @return: the start time in ns, 0 when nested or disabled.
+uint64_t fb_stats_begin(void);
+
+// * Stop measuring a primitive and add it to the counters.
+// * @param: id   : index of the primitive.
+// * @param: px   : number of pixels written.
+// * @param: rd   : number of bytes read back from the framebuffer.
+// * @param: t0   : value returned by fb_stats_begin.
+void fb_stats_end(int id, unsigned long px, unsigned long rd, uint64_t t0);
+
+// * Count a primitive too small to be timed.
+// * @param: id   : index of the primitive.
+// * @param: px   : number of pixels written.
+// * @param: rd   : number of bytes read back from the framebuffer.
+void fb_stats_count(int id, unsigned long px, unsigned long rd);
+
+#endif
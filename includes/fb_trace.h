@@ -0,0 +1,113 @@
+#ifndef _FB_TRACE_H_
+#define _FB_TRACE_H_
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "fb_stats.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define TRACE_REC_t struct trace_rec_t
+
+// Environment variable holding the path of the Chrome trace written on exit.
+#define FB_TRACE_ENV        "FBTOOLS_TRACE"
+#define FB_TRACE_DEFAULT_N  4096
+
+// Environment variable that also mirrors the spans to ftrace when set, a
+// write per span is too slow to be on by default.
+#define FB_TRACE_MARKER_ENV  "FBTOOLS_TRACE_MARKER"
+
+#define FB_TRACE_MARKER      "/sys/kernel/tracing/trace_marker"
+#define FB_TRACE_MARKER_OLD  "/sys/kernel/debug/tracing/trace_marker"
+
+// Spans that are not primitives, they follow the STAT_* ids of fb_stats.h.
+#define TRACE_INIT_FB   (STAT_COUNT_MAX + 0)
+#define TRACE_FRAME     (STAT_COUNT_MAX + 1)
+#define TRACE_FLUSH     (STAT_COUNT_MAX + 2)
+#define TRACE_PRESENT   (STAT_COUNT_MAX + 3)
+#define TRACE_ID_MAX    (STAT_COUNT_MAX + 4)
+
+#define TRACE_PH_SPAN    'X'
+#define TRACE_PH_INSTANT 'i'
+
+// Primitives of graphics.c are traced by the STAT_* probes, these macros are
+// for the other spans. Without FB_TRACE they expand to nothing.
+#ifdef FB_TRACE
+#define TRACE_BEGIN()       uint64_t trace_t0 = fb_trace_now()
+#define TRACE_END(id)       fb_trace_span((id), trace_t0, fb_trace_now())
+#define TRACE_INSTANT(id)   fb_trace_instant((id))
+#else
+#define TRACE_BEGIN()
+#define TRACE_END(id)
+#define TRACE_INSTANT(id)
+#endif
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Fixed size record stored in the ring, times are in ns.
+struct trace_rec_t
+{
+    uint64_t    ts;
+    uint64_t    dur;
+    uint16_t    id;
+    uint8_t     phase;
+    uint8_t     pad[5];
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Start tracing if FBTOOLS_TRACE is set, and mirror the spans to ftrace
+// * if FBTOOLS_TRACE_MARKER is set too.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_trace_init(void);
+
+// * Allocate the ring and start recording, the oldest records are overwritten
+// * once the ring is full.
+// * @param: capacity: number of records kept.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_trace_start(unsigned int capacity);
+
+// * Mirror the recorded spans to trace_marker, or stop mirroring them. Each
+// * span costs a write to the kernel.
+// * @param: enable: 1 to mirror, 0 to stop.
+// * @return: 1 if trace_marker can not be opened, 0 otherwise.
+int fb_trace_marker(int enable);
+
+// * Stop recording, free the ring and stop mirroring to ftrace.
+void fb_trace_stop(void);
+
+// * Check if the recorder is running.
+// * @return: 1 if recording, 0 otherwise.
+int fb_trace_enabled(void);
+
+// * Return the monotonic clock in ns, or 0 when not recording.
+// * @return: the current time.
+uint64_t fb_trace_now(void);
+
+// * Record a span.
+// * @param: id: the span id (STAT_* or TRACE_*).
+// * @param: t0: start time in ns.
+// * @param: t1: end time in ns.
+void fb_trace_span(int id, uint64_t t0, uint64_t t1);
+
+// * Record an instant event.
+// * @param: id: the event id (STAT_* or TRACE_*).
+void fb_trace_instant(int id);
+
+// * Write the records in the Chrome trace event JSON format.
+// * @param: *path: path of the output file.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_trace_export(const char* path);
+
+// * Export to the path given by FBTOOLS_TRACE, then stop recording.
+void fb_trace_finish(void);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef _FLOOD_FILL_H_
+#define _FLOOD_FILL_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define FLOOD_SPAN_t struct flood_span_t
+#define FLOOD_FILL_t struct flood_fill_t
+
+// Default number of spans of the stack, 4 KB.
+#define FLOOD_DEFAULT_SPANS 512
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// A row y to scan between xl and xr, found from the row y - dy.
+struct flood_span_t
+{
+    uint16_t    y;
+    uint16_t    xl;
+    uint16_t    xr;
+    int16_t     dy;
+};
+
+
+// spans is the pending span stack, allocated once with a fixed capacity so a
+// fill never recurses nor allocates. max_used is the deepest the stack went
+// since the init, to size the capacity.
+struct flood_fill_t
+{
+    FLOOD_SPAN_t*   spans;
+    uint_t          capacity;
+    uint_t          used;
+    uint_t          max_used;
+
+    unsigned long   pixels;
+    unsigned long   overflows;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize the span stack of the flood fill.
+// * @param: *ff     : the structure to initialize.
+// * @param: capacity: number of spans of the stack, 0 for
+// *                   FLOOD_DEFAULT_SPANS.
+// * @return: 1 in case of an error, 0 otherwise.
+int flood_fill_init(FLOOD_FILL_t* ff, uint_t capacity);
+
+// * Free the span stack of the flood fill.
+// * @param: *ff: the flood fill to free.
+void flood_fill_free(FLOOD_FILL_t* ff);
+
+// * Fill the area of same color pixels (4-connected) around a point. Rows are
+// * scanned and filled a span at a time. When a shadow copy of the screen is
+// * given, the pixels are read from it and written to both, so the
+// * framebuffer is never read.
+// * @param: *ff    : the flood fill.
+// * @param: *fb    : FRAMEBUFFER_t where the area is filled.
+// * @param: *shadow: copy of the screen with the same stride, NULL to read
+// *                  fb->screen.
+// * @param: x      : x coordinate of the seed.
+// * @param: y      : y coordinate of the seed.
+// * @param: color  : the fill color.
+// * @return: 1 if the stack overflowed and the area was not entirely filled,
+// *          0 otherwise.
+int flood_fill(FLOOD_FILL_t* ff, FRAMEBUFFER_t* fb, COLOR_t* shadow, uint_t x,
+               uint_t y, COLOR_t color);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef _FRAME_CLOCK_H_
+#define _FRAME_CLOCK_H_
+
+#include <sys/ioctl.h>
+#include <linux/fb.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+
+#include "graphics.h"
+#include "fb_trace.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define FRAME_CLOCK_t struct frame_clock_t
+
+#ifndef FBIO_WAITFORVSYNC
+#define FBIO_WAITFORVSYNC _IOW('F', 0x20, uint32_t)
+#endif
+
+#define FRAME_DEFAULT_FPS   30
+
+// A measured vblank period outside of these bounds means the driver does not
+// really wait, the timer is used instead.
+#define FRAME_VBLANK_MIN_NS 2000000ULL
+#define FRAME_VBLANK_MAX_NS 100000000ULL
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Times are CLOCK_MONOTONIC ns. next is the absolute deadline of the current
+// frame, it only moves by whole periods so the pacing never drifts.
+struct frame_clock_t
+{
+    FRAMEBUFFER_t*  fb;
+    int             vsync;
+    uint64_t        vblank_ns;
+    uint64_t        period_ns;
+    uint64_t        next;
+    uint64_t        begin;
+    uint64_t        frames;
+    uint64_t        missed;
+    uint64_t        render_ns;
+    uint64_t        render_max_ns;
+    uint64_t        idle_ns;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize a frame clock. FBIO_WAITFORVSYNC is used when the driver
+// * supports it, the period is then rounded to a whole number of vblanks.
+// * @param: *clk: the structure to initialize.
+// * @param: *fb : the framebuffer that is presented, its fd is used for vsync.
+// * @param: fps : target frame rate, 0 for FRAME_DEFAULT_FPS.
+// * @return: 1 in case of an error, 0 otherwise.
+int frame_clock_init(FRAME_CLOCK_t* clk, FRAMEBUFFER_t* fb, uint_t fps);
+
+// * Mark the start of the rendering of a frame.
+// * @param: *clk: the frame clock.
+void begin_frame(FRAME_CLOCK_t* clk);
+
+// * Mark the end of the rendering and wait for the deadline of the frame,
+// * with the next vblank or an absolute clock_nanosleep.
+// * @param: *clk: the frame clock.
+// * @return: the number of deadlines missed by this frame, animations should
+// *          advance by 1 + this value.
+uint_t end_frame(FRAME_CLOCK_t* clk);
+
+// * Reset the statistics of the clock.
+// * @param: *clk: the frame clock.
+void frame_clock_reset(FRAME_CLOCK_t* clk);
+
+// * Print the frame statistics.
+// * @param: *clk: the frame clock.
+// * @param: *out: the stream where the statistics are written.
+void frame_clock_dump(FRAME_CLOCK_t* clk, FILE* out);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _GRADIENT_H_
+#define _GRADIENT_H_
+
+#include <stdint.h>
+
+#include "graphics.h"
+#include "colors.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+
+// Gradient parameter in 16.16 fixed point, 0 is the first color and
+// GRADIENT_ONE the second one.
+#define GRADIENT_SHIFT  16
+#define GRADIENT_ONE    (1 << GRADIENT_SHIFT)
+
+// Pixels generated at once in 0xRRGGBB before the conversion to 16 bits.
+#define GRADIENT_CHUNK  64
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Fill a rectangle with a linear gradient going from (gx0, gy0) to
+// * (gx1, gy1), the colors are clamped before and after the end points.
+// * Colors are 0xRRGGBB so the ramp keeps its precision until the 16 bits
+// * conversion.
+// * @param: *fb   : FRAMEBUFFER_t where the gradient will be rendered.
+// * @param: x     : start x coordinate of the rectangle.
+// * @param: y     : start y coordinate of the rectangle.
+// * @param: w     : width of the rectangle.
+// * @param: h     : height of the rectangle.
+// * @param: gx0   : x coordinate of the first color.
+// * @param: gy0   : y coordinate of the first color.
+// * @param: rgb0  : first color.
+// * @param: gx1   : x coordinate of the second color.
+// * @param: gy1   : y coordinate of the second color.
+// * @param: rgb1  : second color.
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void fill_gradient_linear(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
+                          uint_t w, uint_t h, int gx0, int gy0, uint32_t rgb0,
+                          int gx1, int gy1, uint32_t rgb1, int dither);
+
+// * Fill a rectangle with a radial gradient, rgb0 at the center and rgb1 from
+// * radius outwards.
+// * @param: *fb   : FRAMEBUFFER_t where the gradient will be rendered.
+// * @param: x     : start x coordinate of the rectangle.
+// * @param: y     : start y coordinate of the rectangle.
+// * @param: w     : width of the rectangle.
+// * @param: h     : height of the rectangle.
+// * @param: cx    : x coordinate of the center.
+// * @param: cy    : y coordinate of the center.
+// * @param: radius: radius of the gradient in pixels.
+// * @param: rgb0  : color at the center.
+// * @param: rgb1  : color at the radius.
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void fill_gradient_radial(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
+                          uint_t w, uint_t h, int cx, int cy, uint_t radius,
+                          uint32_t rgb0, uint32_t rgb1, int dither);
+
+#endif
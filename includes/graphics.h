@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "colors.h"
 
@@ -22,6 +23,13 @@ extern unsigned int NOC;
 #define RECT_CP_t struct rect_cp_t
 #define uint_t unsigned int
 
+// Scaled text, biggest integer scale. Expanded glyphs are kept in a 2-way
+// set associative cache, consecutive chars fall in consecutive sets so the
+// digits and ':' fit together.
+#define TEXT_SCALE_MAX    8
+#define GLYPH_CACHE_SETS  8
+#define GLYPH_CACHE_WAYS  2
+
 
 // * __ STRUCTURE DEFINITIONS __________________________________________________
 struct framebuffer_t
@@ -114,7 +122,8 @@ void put_char(FRAMEBUFFER_t* fb, char c, COLOR_t fgcolor, COLOR_t bgcolor);
 void scroll_screen(FRAMEBUFFER_t* fb);
 
 
-// * Draw a ACSII a string on the screen at position x, y. 
+// * Draw a ACSII a string on the screen at position x, y. A char that does
+// * not fit on the line, or '\n', moves to the next line at x. 
 // * @param: str  : the char to draw. 
 // * @param: x    : x position the draw the char. 
 // * @param: y    : y position the draw the char. 
@@ -123,6 +132,30 @@ void print_str_coord(FRAMEBUFFER_t* fb, char* str, uint_t x, uint_t y,
                  COLOR_t fgcolor, COLOR_t bgcolor); 
 
 
+// * Draw a ACSII character scaled by an integer factor at position x, y. The
+// * scaled glyph is expanded once and cached, then drawn with row copies.
+// * @param: c      : the char to draw. 
+// * @param: x      : x position where to the draw the char. 
+// * @param: y      : y position where to the draw the char. 
+// * @param: scale  : scale factor (1 to TEXT_SCALE_MAX). 
+// * @param: fgcolor: color of the letter. 
+// * @param: bgcolor: color of the background of the char. 
+void print_char_coord_scaled(FRAMEBUFFER_t* fb, char c, uint_t x, uint_t y, 
+                             uint_t scale, COLOR_t fgcolor, COLOR_t bgcolor); 
+
+
+// * Draw a ACSII string scaled by an integer factor at position x, y. A char
+// * that does not fit on the line, or '\n', moves to the next line at x. 
+// * @param: str    : the string to draw. 
+// * @param: x      : x position of the first char. 
+// * @param: y      : y position of the first char. 
+// * @param: scale  : scale factor (1 to TEXT_SCALE_MAX). 
+// * @param: fgcolor: color of the letters. 
+// * @param: bgcolor: color of the background of the chars. 
+void print_str_coord_scaled(FRAMEBUFFER_t* fb, char* str, uint_t x, uint_t y, 
+                            uint_t scale, COLOR_t fgcolor, COLOR_t bgcolor); 
+
+
 // * Put a string on the screen at global cursor position. 
 // * @param: c      : the char to draw. 
 // * @param: fgcolor: color of the letter. 
@@ -168,6 +201,19 @@ void write_rect_alpha(FRAMEBUFFER_t* fb, void* buf, uint_t x,
                       uint_t y, uint8_t alpha); 
 
 
+// * Paste a rectangle of pixel previously copied, the pixels of the key 
+// * color are transparent. The rectangle is clipped to the screen. 
+// * @param: *fb: The framebuffer where the area will be pasted. 
+// * @param: buf: The RECT_CP_t buffer that contains data that will be drawn. 
+// * @param: x  : x coordinate of the top-left corner where the copy will be 
+// *              drawn. 
+// * @param: y  : y coordinate of the top-left corner where the copy will be 
+// *              drawn. 
+// * @param: key: the transparent color. 
+void write_rect_keyed(FRAMEBUFFER_t* fb, void* buf, uint_t x, uint_t y, 
+                      COLOR_t key); 
+
+
 // * Draw an horizontal line on screen. 
 // * @param: *fb  : FRAMEBUFFER_t where the line will be rendered. 
 // * @param: x    : start x coordinate. 
@@ -210,6 +256,37 @@ void draw_rect(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
                uint_t w, uint_t h, COLOR_t color); 
 
 
+// * Fill the area x0;y0 - x1;y1 (excluded) clipped to the screen, the first 
+// * row is filled and copied to the others. 
+// * @param: *fb  : FRAMEBUFFER_t where the area is filled. 
+// * @param: x0   : left edge of the area. 
+// * @param: y0   : top edge of the area. 
+// * @param: x1   : right edge of the area (excluded). 
+// * @param: y1   : bottom edge of the area (excluded). 
+// * @param: color: color of the area. 
+void fill_area(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0, uint_t x1, uint_t y1, 
+               COLOR_t color); 
+
+
+// * Draw the part of a string inside the area x0;y0 - x1;y1 (excluded), 
+// * clipped to the screen. The string is laid on one line from x, y, so a 
+// * clipped string, or a string split between tiles, is drawn row by row 
+// * without drawing whole glyphs. 
+// * @param: *fb    : FRAMEBUFFER_t where the string is drawn. 
+// * @param: *str   : the string. 
+// * @param: x      : x coordinate of the first char. 
+// * @param: y      : y coordinate of the first char. 
+// * @param: x0     : left edge of the area. 
+// * @param: y0     : top edge of the area. 
+// * @param: x1     : right edge of the area (excluded). 
+// * @param: y1     : bottom edge of the area (excluded). 
+// * @param: fgcolor: color of the letters. 
+// * @param: bgcolor: color of the background of the letters. 
+void print_str_area(FRAMEBUFFER_t* fb, const char* str, uint_t x, uint_t y, 
+                    uint_t x0, uint_t y0, uint_t x1, uint_t y1, 
+                    COLOR_t fgcolor, COLOR_t bgcolor); 
+
+
 // * Draw the piet_mondrian style painting onto the screen. Be aware, it will 
 // * clear the entire screen.
 // * @param: *fb: FRAMEBUFFER_t where it will be rendered.  
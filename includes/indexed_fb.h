@@ -0,0 +1,159 @@
+#ifndef _INDEXED_FB_H_
+#define _INDEXED_FB_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "colors.h"
+#include "iso_font.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define INDEXED_FB_t struct indexed_fb_t
+
+// Bits per pixel of the back buffer.
+#define INDEXED_4BPP    4
+#define INDEXED_8BPP    8
+
+// Entries of the palette. The first PALETTE_SIZE ones are the colors of
+// palette(), 16 - 231 a 6x6x6 color cube and 232 - 255 a gray ramp. In 4 bpp
+// only the first PALETTE_SIZE can be drawn.
+#define INDEXED_COLORS  256
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// A back buffer of palette indices the size of the screen, stride bytes per
+// row. In 4 bpp the low nibble of a byte is the left pixel. dirty has a byte
+// per row drawn since the last flush. pairs is the expansion of a 4 bpp byte
+// into its two pixels.
+struct indexed_fb_t
+{
+    FRAMEBUFFER_t*  fb;
+    uint8_t*        pix;
+    uint8_t*        dirty;
+    uint_t          w;
+    uint_t          h;
+    uint_t          stride;
+    uint_t          bpp;
+
+    COLOR_t         lut[INDEXED_COLORS];
+    COLOR_t         pairs[256][2];
+
+    unsigned long   rows_flushed;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize a back buffer of palette indices for the screen, cleared to
+// * the index 0. Every row is dirty so the first flush draws the screen.
+// * @param: *ifb: the structure to initialize.
+// * @param: *fb : the framebuffer where the back buffer is flushed.
+// * @param: bpp : INDEXED_4BPP or INDEXED_8BPP.
+// * @return: 1 in case of an error, 0 otherwise.
+int indexed_fb_init(INDEXED_FB_t* ifb, FRAMEBUFFER_t* fb, uint_t bpp);
+
+// * Free the back buffer.
+// * @param: *ifb: the back buffer to free.
+void indexed_fb_free(INDEXED_FB_t* ifb);
+
+// * Change a color of the palette, every row is flushed again if it changed.
+// * @param: *ifb : the back buffer.
+// * @param: index: the index of the color.
+// * @param: color: the new color.
+void indexed_fb_set_color(INDEXED_FB_t* ifb, uint8_t index, COLOR_t color);
+
+// * Copy the colors of palette() to the first PALETTE_SIZE entries, after the
+// * active palette has been swapped.
+// * @param: *ifb: the back buffer.
+void indexed_fb_sync_palette(INDEXED_FB_t* ifb);
+
+// * Expand the dirty rows to the screen through the palette.
+// * @param: *ifb: the back buffer.
+// * @return: the number of rows written.
+uint_t indexed_fb_flush(INDEXED_FB_t* ifb);
+
+// * Draw a pixel in the back buffer.
+// * @param: *ifb : the back buffer.
+// * @param: x    : x coordinate of the pixel.
+// * @param: y    : y coordinate of the pixel.
+// * @param: index: palette index of the pixel.
+void indexed_draw_pixel(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint8_t index);
+
+// * Return the palette index of a pixel of the back buffer.
+// * @param: *ifb: the back buffer.
+// * @param: x   : x coordinate of the pixel.
+// * @param: y   : y coordinate of the pixel.
+// * @return: the index, 0 out of the screen.
+uint8_t indexed_get_pixel(INDEXED_FB_t* ifb, uint_t x, uint_t y);
+
+// * Draw a filled rectangle in the back buffer, clipped to the screen.
+// * @param: *ifb : the back buffer.
+// * @param: x    : start x coordinate.
+// * @param: y    : start y coordinate.
+// * @param: w    : width of the rectangle.
+// * @param: h    : height of the rectangle.
+// * @param: index: palette index of the rectangle.
+void indexed_fill_rect(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint_t w,
+                       uint_t h, uint8_t index);
+
+// * Fill the whole back buffer.
+// * @param: *ifb : the back buffer.
+// * @param: index: palette index of the screen.
+void indexed_fill(INDEXED_FB_t* ifb, uint8_t index);
+
+// * Draw a horizontal line in the back buffer, clipped to the screen.
+// * @param: *ifb : the back buffer.
+// * @param: x    : start x coordinate.
+// * @param: y    : y coordinate of the line.
+// * @param: w    : length of the line.
+// * @param: index: palette index of the line.
+void indexed_draw_h_line(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint_t w,
+                         uint8_t index);
+
+// * Draw a vertical line in the back buffer, clipped to the screen.
+// * @param: *ifb : the back buffer.
+// * @param: x    : x coordinate of the line.
+// * @param: y    : start y coordinate.
+// * @param: h    : length of the line.
+// * @param: index: palette index of the line.
+void indexed_draw_v_line(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint_t h,
+                         uint8_t index);
+
+// * Draw a line between two points in the back buffer, in any direction.
+// * Pixels out of the screen are skipped.
+// * @param: *ifb : the back buffer.
+// * @param: x0   : x coordinate of the first point.
+// * @param: y0   : y coordinate of the first point.
+// * @param: x1   : x coordinate of the last point.
+// * @param: y1   : y coordinate of the last point.
+// * @param: index: palette index of the line.
+void indexed_draw_line(INDEXED_FB_t* ifb, uint_t x0, uint_t y0, uint_t x1,
+                       uint_t y1, uint8_t index);
+
+// * Draw a char of the built-in font in the back buffer.
+// * @param: *ifb: the back buffer.
+// * @param: c   : the char.
+// * @param: x   : x coordinate of the top-left corner.
+// * @param: y   : y coordinate of the top-left corner.
+// * @param: fg  : palette index of the letter.
+// * @param: bg  : palette index of the background.
+void indexed_print_char(INDEXED_FB_t* ifb, char c, uint_t x, uint_t y,
+                        uint8_t fg, uint8_t bg);
+
+// * Draw a string of the built-in font in the back buffer. A char that does
+// * not fit on the line, or '\n', moves to the next line at x.
+// * @param: *ifb: the back buffer.
+// * @param: *str: the string.
+// * @param: x   : x coordinate of the first char.
+// * @param: y   : y coordinate of the first char.
+// * @param: fg  : palette index of the letters.
+// * @param: bg  : palette index of the background.
+void indexed_print_str(INDEXED_FB_t* ifb, const char* str, uint_t x, uint_t y,
+                       uint8_t fg, uint8_t bg);
+
+#endif
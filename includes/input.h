@@ -0,0 +1,197 @@
+#ifndef _INPUT_H_
+#define _INPUT_H_
+
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define INPUT_t struct input_t
+#define INPUT_DEV_t struct input_dev_t
+#define CURSOR_t struct cursor_t
+
+#define INPUT_DEV_PATH      "/dev/input/event%u"
+#define INPUT_MAX_DEVICES   4
+#define INPUT_SCAN_DEVICES  16
+
+// Events read at once from a device.
+#define INPUT_BATCH         32
+
+#define INPUT_BUTTON_LEFT   0x01
+#define INPUT_BUTTON_RIGHT  0x02
+#define INPUT_BUTTON_TOUCH  0x04
+
+// Record sizes of a replay file, the layouts of struct input_event (little
+// endian) on 32 bits targets: u32 sec, u32 usec, u16 type, u16 code,
+// s32 value, and on 64 bits hosts where sec and usec are u64.
+#define INPUT_REC_32        16
+#define INPUT_REC_64        24
+
+// Records checked to tell the two layouts apart when the size fits both.
+#define INPUT_REC_PROBE     8
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Absolute axes of a device are scaled from abs_min;abs_max to the screen.
+// mono is 0 when the device keeps CLOCK_REALTIME timestamps, the arrival
+// time is then used for the latency.
+struct input_dev_t
+{
+    int         fd;
+    int         mono;
+    int         abs_min[2];
+    int         abs_max[2];
+};
+
+
+// Pointer state built from the events. pending is the time (CLOCK_MONOTONIC
+// ns) of the oldest event not presented yet, 0 if none. A replay file holds
+// the events as produced by cat /dev/input/eventN, recorded on a 32 or a
+// 64 bits system (replay_rec is the record size), and is played back with
+// its original timing.
+struct input_t
+{
+    INPUT_DEV_t         devs[INPUT_MAX_DEVICES];
+    uint_t              ndevs;
+    uint_t              xres;
+    uint_t              yres;
+
+    int                 replay_fd;
+    INPUT_DEV_t         replay_dev;
+    uint_t              replay_rec;
+    struct input_event  replay_ev;
+    uint64_t            replay_time;
+    int                 replay_has_ev;
+    uint64_t            replay_start;
+    uint64_t            replay_base;
+
+    int                 x;
+    int                 y;
+    int                 new_x;
+    int                 new_y;
+    uint_t              buttons;
+    uint_t              new_buttons;
+    uint64_t            pending;
+    uint64_t            frame_pending;
+
+    unsigned long       events;
+    unsigned long       latency_count;
+    uint64_t            latency_total_ns;
+    uint64_t            latency_max_ns;
+};
+
+
+// The save-under is allocated once with the size of the sprite, pixels of
+// the key color are transparent.
+struct cursor_t
+{
+    COLOR_t*    sprite;
+    COLOR_t*    save;
+    uint_t      w;
+    uint_t      h;
+    int         hot_x;
+    int         hot_y;
+    COLOR_t     key;
+
+    int         drawn;
+    uint_t      save_x;
+    uint_t      save_y;
+    uint_t      save_w;
+    uint_t      save_h;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Open every pointer device (relative or absolute axes) in non-blocking
+// * mode, their timestamps are switched to CLOCK_MONOTONIC.
+// * @param: *in: the structure to initialize.
+// * @param: *fb: the framebuffer, its size bounds the pointer.
+// * @return: 1 if no device can be used, 0 otherwise.
+int input_open(INPUT_t* in, FRAMEBUFFER_t* fb);
+
+// * Use a recorded event file instead of the devices. Absolute coordinates
+// * are taken as screen coordinates unless a range is set. A file whose size
+// * is not a whole number of records is rejected.
+// * @param: *in  : the structure to initialize.
+// * @param: *fb  : the framebuffer, its size bounds the pointer.
+// * @param: *path: path of the recorded events.
+// * @return: 1 in case of an error, 0 otherwise.
+int input_open_replay(INPUT_t* in, FRAMEBUFFER_t* fb, const char* path);
+
+// * Set the range of the absolute axes of a replay file.
+// * @param: *in : the input.
+// * @param: xmin: value of the left border.
+// * @param: xmax: value of the right border.
+// * @param: ymin: value of the top border.
+// * @param: ymax: value of the bottom border.
+void input_set_abs_range(INPUT_t* in, int xmin, int xmax, int ymin,
+                         int ymax);
+
+// * Close the devices or the replay file.
+// * @param: *in: the input to close.
+void input_close(INPUT_t* in);
+
+// * Read every event available without blocking and update the pointer on
+// * each SYN_REPORT.
+// * @param: *in: the input.
+// * @return: 1 if the pointer moved or a button changed, 0 otherwise.
+int input_poll(INPUT_t* in);
+
+// * Record the latency of the pending events, to call right after the frame
+// * showing them has been flushed to the screen.
+// * @param: *in: the input.
+void input_presented(INPUT_t* in);
+
+// * Print the input-to-photon latency statistics.
+// * @param: *in : the input.
+// * @param: *out: the stream where the statistics are written.
+void input_dump_latency(INPUT_t* in, FILE* out);
+
+// * Initialize a cursor and its save-under buffer.
+// * @param: *cur  : the structure to initialize.
+// * @param: *pix  : w * h pixels of the sprite, NULL for the default arrow.
+// * @param: w     : width of the sprite.
+// * @param: h     : height of the sprite.
+// * @param: key   : transparent color of the sprite.
+// * @param: hot_x : x coordinate of the pointing pixel in the sprite.
+// * @param: hot_y : y coordinate of the pointing pixel in the sprite.
+// * @return: 1 in case of an error, 0 otherwise.
+int cursor_init(CURSOR_t* cur, const COLOR_t* pix, uint_t w, uint_t h,
+                COLOR_t key, int hot_x, int hot_y);
+
+// * Free the buffers of the cursor.
+// * @param: *cur: the cursor to free.
+void cursor_free(CURSOR_t* cur);
+
+// * Draw the cursor pointing at x, y after saving the pixels under it.
+// * @param: *fb : the framebuffer where the cursor is drawn.
+// * @param: *cur: the cursor.
+// * @param: x   : x coordinate of the pointed pixel.
+// * @param: y   : y coordinate of the pointed pixel.
+void cursor_show(FRAMEBUFFER_t* fb, CURSOR_t* cur, int x, int y);
+
+// * Restore the pixels under the cursor.
+// * @param: *fb : the framebuffer where the cursor is drawn.
+// * @param: *cur: the cursor.
+void cursor_hide(FRAMEBUFFER_t* fb, CURSOR_t* cur);
+
+// * Move the cursor, only the old and the new rectangles are written.
+// * @param: *fb : the framebuffer where the cursor is drawn.
+// * @param: *cur: the cursor.
+// * @param: x   : x coordinate of the pointed pixel.
+// * @param: y   : y coordinate of the pointed pixel.
+void cursor_move(FRAMEBUFFER_t* fb, CURSOR_t* cur, int x, int y);
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef _POINTS_H_
+#define _POINTS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define POINT_t struct point_t
+#define POINT_SORT_t struct point_sort_t
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Coordinates are signed so points out of the screen can be given, they are
+// clipped.
+struct point_t
+{
+    int16_t     x;
+    int16_t     y;
+};
+
+
+// Scratch memory to draw points row by row: rows counts the points of each
+// row of the screen, offsets and colors receive the points sorted by row.
+// A batch of more than capacity points is drawn in several passes.
+struct point_sort_t
+{
+    uint_t*     rows;
+    uint_t      nrows;
+    uint32_t*   offsets;
+    COLOR_t*    colors;
+    uint_t      capacity;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Draw points of the same color. The bounds of the whole array are checked
+// * first, the points are not checked one by one when it is on the screen.
+// * @param: *fb   : FRAMEBUFFER_t where the points are drawn.
+// * @param: *pts  : the points.
+// * @param: n     : number of points.
+// * @param: color : color of the points.
+// * @return: the number of points drawn.
+uint_t draw_points(FRAMEBUFFER_t* fb, const POINT_t* pts, uint_t n,
+                   COLOR_t color);
+
+// * Draw points with a color each. The bounds of the whole array are checked
+// * first, the points are not checked one by one when it is on the screen.
+// * @param: *fb    : FRAMEBUFFER_t where the points are drawn.
+// * @param: *pts   : the points.
+// * @param: *colors: color of each point.
+// * @param: n      : number of points.
+// * @return: the number of points drawn.
+uint_t draw_points_colors(FRAMEBUFFER_t* fb, const POINT_t* pts,
+                          const COLOR_t* colors, uint_t n);
+
+// * Initialize the scratch memory to draw points row by row.
+// * @param: *sort   : the structure to initialize.
+// * @param: *fb     : FRAMEBUFFER_t where the points will be drawn.
+// * @param: capacity: most points sorted at once.
+// * @return: 1 in case of an error, 0 otherwise.
+int point_sort_init(POINT_SORT_t* sort, FRAMEBUFFER_t* fb, uint_t capacity);
+
+// * Free the scratch memory of the sort.
+// * @param: *sort: the structure to free.
+void point_sort_free(POINT_SORT_t* sort);
+
+// * Draw points sorted by row, so the screen is written from top to bottom
+// * whatever the order of the points. Worth it for large batches in random
+// * order on a framebuffer that is slow to access out of order, in cached
+// * memory the sort costs more than it saves. The order of points on the
+// * same pixel is kept.
+// * @param: *sort  : the scratch memory of the sort.
+// * @param: *fb    : FRAMEBUFFER_t where the points are drawn.
+// * @param: *pts   : the points.
+// * @param: *colors: color of each point, NULL to use color.
+// * @param: n      : number of points.
+// * @param: color  : color of the points when colors is NULL.
+// * @return: the number of points drawn.
+uint_t draw_points_sorted(POINT_SORT_t* sort, FRAMEBUFFER_t* fb,
+                          const POINT_t* pts, const COLOR_t* colors,
+                          uint_t n, COLOR_t color);
+
+#endif
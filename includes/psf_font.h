@@ -0,0 +1,131 @@
+#ifndef _PSF_FONT_H_
+#define _PSF_FONT_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define PSF_FONT_t struct psf_font_t
+#define PSF_MAP_t struct psf_map_t
+#define PSF2_HEADER_t struct psf2_header_t
+
+#define PSF2_MAGIC          0x864AB572
+#define PSF2_HAS_UNICODE    0x01
+#define PSF2_SEPARATOR      0xFF
+#define PSF2_STARTSEQ       0xFE
+
+// Code points below this value are looked up in a direct table (Latin, Greek
+// and Cyrillic), the others with a binary search.
+#define PSF_DIRECT_MAX      0x800
+#define PSF_NO_GLYPH        0xFFFF
+
+// Biggest glyph width and height accepted, in pixels.
+#define PSF_SIZE_MAX        256
+
+#define UTF8_REPLACEMENT    0xFFFD
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Header of a PSF2 font file, every field is little endian.
+struct psf2_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headersize;
+    uint32_t flags;
+    uint32_t length;
+    uint32_t charsize;
+    uint32_t height;
+    uint32_t width;
+};
+
+
+// Code point to glyph index, sorted by code point.
+struct psf_map_t
+{
+    uint32_t cp;
+    uint32_t glyph;
+};
+
+
+struct psf_font_t
+{
+    int             fd;
+    size_t          map_size;
+    const uint8_t*  data;
+    const uint8_t*  glyphs;
+    uint_t          nglyphs;
+    uint_t          charsize;
+    uint_t          width;
+    uint_t          height;
+    uint_t          row_bytes;
+    uint_t          fallback;
+    uint16_t*       direct;
+    PSF_MAP_t*      map;
+    uint_t          nmap;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Map a PSF2 font file and index its unicode table.
+// * @param: *font: the structure to initialize.
+// * @param: *path: path of the uncompressed .psf font.
+// * @return: 1 in case of an error, 0 otherwise.
+int psf_load(PSF_FONT_t* font, const char* path);
+
+// * Unmap the font and free its index.
+// * @param: *font: the font to free.
+void psf_free(PSF_FONT_t* font);
+
+// * Return the glyph index of a code point.
+// * @param: *font: the font where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: the glyph index, the replacement glyph if the font has none.
+uint_t psf_glyph_index(PSF_FONT_t* font, uint32_t cp);
+
+// * Tell whether the font has a glyph of its own for a code point.
+// * @param: *font: the font where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: 1 if the code point is mapped, 0 if it would use the fallback.
+int psf_has_glyph(PSF_FONT_t* font, uint32_t cp);
+
+// * Decode the next UTF-8 code point of a string and advance the string.
+// * @param: **str: the string, moved after the decoded sequence.
+// * @return: the code point, UTF8_REPLACEMENT for an invalid sequence.
+uint32_t utf8_decode(const char** str);
+
+// * Draw a unicode code point on the screen at position x, y.
+// * @param: *fb    : the framebuffer where the glyph is drawn.
+// * @param: *font  : the font to use.
+// * @param: cp     : the code point to draw.
+// * @param: x      : x position of the glyph.
+// * @param: y      : y position of the glyph.
+// * @param: fgcolor: color of the letter.
+// * @param: bgcolor: color of the background of the glyph.
+void psf_print_char(FRAMEBUFFER_t* fb, PSF_FONT_t* font, uint32_t cp,
+                    uint_t x, uint_t y, COLOR_t fgcolor, COLOR_t bgcolor);
+
+// * Draw a UTF-8 string on a single line at position x, y.
+// * @param: *fb    : the framebuffer where the string is drawn.
+// * @param: *font  : the font to use.
+// * @param: *str   : the UTF-8 string to draw.
+// * @param: x      : x position of the first glyph.
+// * @param: y      : y position of the first glyph.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the glyphs.
+// * @return: the x position after the last glyph drawn.
+uint_t psf_print_utf8(FRAMEBUFFER_t* fb, PSF_FONT_t* font, const char* str,
+                      uint_t x, uint_t y, COLOR_t fgcolor, COLOR_t bgcolor);
+
+#endif
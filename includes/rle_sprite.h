@@ -0,0 +1,105 @@
+#ifndef _RLE_SPRITE_H_
+#define _RLE_SPRITE_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define RLE_SPRITE_t struct rle_sprite_t
+#define RLE_HEADER_t struct rle_header_t
+
+#define RLE_MAGIC       0x4C524246
+#define RLE_VERSION     1
+
+// An op is one 16 bits word, the type in the 2 high bits and the number of
+// pixels in the others. SOLID is followed by its color, LITERAL by count
+// colors.
+#define RLE_SKIP        0x0000
+#define RLE_SOLID       0x4000
+#define RLE_LITERAL     0x8000
+#define RLE_TYPE_MASK   0xC000
+#define RLE_COUNT_MASK  0x3FFF
+
+// Shortest run of a color stored as SOLID rather than inside a literal.
+#define RLE_MIN_SOLID   3
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Layout of a sprite (little endian): header, h row offsets (in words from
+// the first op), then the ops. The ops of a row cover exactly w pixels.
+struct rle_header_t
+{
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    key;
+    uint16_t    w;
+    uint16_t    h;
+    uint32_t    nwords;
+};
+
+
+// data is either mapped from a file (fd >= 0) or a buffer owned by the
+// caller, such as a const array kept in flash.
+struct rle_sprite_t
+{
+    int                     fd;
+    size_t                  map_size;
+    const uint8_t*          data;
+    const RLE_HEADER_t*     hdr;
+    const uint32_t*         rows;
+    const uint16_t*         ops;
+    uint_t                  w;
+    uint_t                  h;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Encode pixels into a sprite, pixels of the key color are transparent.
+// * @param: *pix : w * h pixels.
+// * @param: w    : width of the picture.
+// * @param: h    : height of the picture.
+// * @param: key  : transparent color.
+// * @param: *size: filled with the size of the sprite in bytes.
+// * @return: the sprite data to free(), NULL in case of an error.
+uint8_t* rle_sprite_encode(const COLOR_t* pix, uint_t w, uint_t h,
+                           COLOR_t key, size_t* size);
+
+// * Use sprite data already in memory, every row is checked once here so the
+// * blitter does not check the ops.
+// * @param: *sprite: the structure to initialize.
+// * @param: *data  : the sprite data, it must stay valid and 4 bytes aligned.
+// * @param: size   : size of the data in bytes.
+// * @return: 1 in case of an error, 0 otherwise.
+int rle_sprite_from_memory(RLE_SPRITE_t* sprite, const void* data,
+                           size_t size);
+
+// * Map a sprite file produced by fbrle.
+// * @param: *sprite: the structure to initialize.
+// * @param: *path  : path of the sprite file.
+// * @return: 1 in case of an error, 0 otherwise.
+int rle_sprite_open(RLE_SPRITE_t* sprite, const char* path);
+
+// * Unmap a sprite file, a sprite from memory is only forgotten.
+// * @param: *sprite: the sprite to close.
+void rle_sprite_close(RLE_SPRITE_t* sprite);
+
+// * Draw a sprite clipped to the screen. Transparent runs are skipped, solid
+// * runs are filled and literal runs are copied with memcpy.
+// * @param: *fb    : the framebuffer where the sprite is drawn.
+// * @param: *sprite: the sprite.
+// * @param: x      : x coordinate of the top-left corner, can be negative.
+// * @param: y      : y coordinate of the top-left corner, can be negative.
+void rle_sprite_draw(FRAMEBUFFER_t* fb, RLE_SPRITE_t* sprite, int x, int y);
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef _SHM_SURFACE_H_
+#define _SHM_SURFACE_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "surface.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define SHM_SURFACE_t struct shm_surface_t
+#define SHM_HEADER_t struct shm_header_t
+
+#define SHM_SURFACE_MAGIC    0x46425348
+#define SHM_SURFACE_NAME_MAX 64
+
+// Tries of the compositor to take the lock of a surface before skipping it
+// for the frame.
+#define SHM_LOCK_SPINS       1000
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Header stored at the beginning of the shared mapping, the pixels follow it.
+// The damage rectangle is the union of every area notified by the client
+// since the last composite, x0 >= x1 means nothing to redraw.
+struct shm_header_t
+{
+    uint32_t            magic;
+    uint32_t            w;
+    uint32_t            h;
+    volatile uint32_t   lock;
+    uint32_t            dmg_x0;
+    uint32_t            dmg_y0;
+    uint32_t            dmg_x1;
+    uint32_t            dmg_y1;
+};
+
+
+// lock_skips counts the composites skipped because the lock was held.
+struct shm_surface_t
+{
+    int             fd;
+    int             owner;
+    char            name[SHM_SURFACE_NAME_MAX];
+    size_t          map_size;
+    SHM_HEADER_t*   hdr;
+    COLOR_t*        buf;
+    uint_t          w;
+    uint_t          h;
+
+    unsigned long   lock_skips;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Create a named shared memory surface that a client can render into. It
+// * fails if the name is already in use, a stale name left by a crash must be
+// * removed with shm_unlink() first.
+// * @param: *surf: the structure to initialize.
+// * @param: *name: name of the shared memory object (ex: "/gauge0").
+// * @param: w    : width of the surface in pixels.
+// * @param: h    : height of the surface in pixels.
+// * @return: 1 in case of an error, 0 otherwise.
+int shm_surface_create(SHM_SURFACE_t* surf, const char* name,
+                       uint_t w, uint_t h);
+
+// * Open a shared memory surface previously created by a client.
+// * @param: *surf: the structure to initialize.
+// * @param: *name: name of the shared memory object.
+// * @return: 1 in case of an error, 0 otherwise.
+int shm_surface_open(SHM_SURFACE_t* surf, const char* name);
+
+// * Unmap the surface and close it, the creator also unlink the name.
+// * @param: *surf: the surface to close.
+void shm_surface_close(SHM_SURFACE_t* surf);
+
+// * Fill a FRAMEBUFFER_t over the shared pixels with surface_as_framebuffer,
+// * so the client renders with the usual drawing functions.
+// * @param: *surf: the surface to render into.
+// * @param: *fb  : the framebuffer structure to fill.
+void shm_surface_as_framebuffer(SHM_SURFACE_t* surf, FRAMEBUFFER_t* fb);
+
+// * Notify the compositor that an area of the surface has been redrawn.
+// * @param: *surf: the surface that has been modified.
+// * @param: x    : x coordinate of the top-left corner of the damage.
+// * @param: y    : y coordinate of the top-left corner of the damage.
+// * @param: w    : width of the damaged area.
+// * @param: h    : height of the damaged area.
+void shm_surface_damage(SHM_SURFACE_t* surf, uint_t x, uint_t y,
+                        uint_t w, uint_t h);
+
+// * Blit the damaged area of the surface directly from the shared mapping
+// * onto the screen and clear the damage. Nothing is drawn when the client
+// * keeps the lock of the header, the damage is then left for the next call.
+// * @param: *fb  : the framebuffer where the surface will be composited.
+// * @param: *surf: the surface to composite.
+// * @param: x    : x coordinate of the surface on the screen.
+// * @param: y    : y coordinate of the surface on the screen.
+// * @return: the number of pixels written, 0 if there was nothing to do.
+uint_t shm_surface_composite(FRAMEBUFFER_t* fb, SHM_SURFACE_t* surf,
+                             uint_t x, uint_t y);
+
+#endif
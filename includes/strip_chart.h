@@ -0,0 +1,106 @@
+#ifndef _STRIP_CHART_H_
+#define _STRIP_CHART_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "fb_stats.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define STRIP_CHART_t struct strip_chart_t
+
+// SWEEP writes the columns left to right and wraps like an oscilloscope, with
+// a blank gap ahead of the newest column, only the new columns are written.
+// SCROLL keeps the newest column on the right: the columns are drawn in a
+// shadow of the area used as a ring, and the whole area is copied to the
+// screen once per push, without reading it.
+#define STRIP_SWEEP     0
+#define STRIP_SCROLL    1
+
+// Width of the blank gap ahead of the newest column in SWEEP mode.
+#define STRIP_GAP       4
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// lo and hi are a ring of w columns, the rows (relative to y) between which
+// each column is drawn. head is the index of the next column to write, it is
+// also the oldest column once ncols == w. A column covers spc samples, their
+// min and max are kept while it is not complete. In SCROLL mode, shadow holds
+// h rows of w pixels, its column i is the column i of the ring.
+struct strip_chart_t
+{
+    FRAMEBUFFER_t*  fb;
+    uint_t          x;
+    uint_t          y;
+    uint_t          w;
+    uint_t          h;
+    uint8_t         mode;
+    COLOR_t         fgcolor;
+    COLOR_t         bgcolor;
+
+    int             vmin;
+    int             vmax;
+    int64_t         scale;
+    uint_t          spc;
+
+    uint16_t*       lo;
+    uint16_t*       hi;
+    uint_t          head;
+    uint_t          ncols;
+    COLOR_t*        shadow;
+
+    uint_t          acc;
+    int             acc_min;
+    int             acc_max;
+    int             last;
+
+    unsigned long   samples;
+    unsigned long   columns;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize a strip chart over an area of the screen, and clear it.
+// * @param: *chart : the structure to initialize.
+// * @param: *fb    : the framebuffer where the chart is drawn.
+// * @param: x      : x coordinate of the area.
+// * @param: y      : y coordinate of the area.
+// * @param: w      : width of the area, one column per pixel.
+// * @param: h      : height of the area.
+// * @param: vmin   : value drawn on the bottom row.
+// * @param: vmax   : value drawn on the top row.
+// * @param: spc    : samples per column, their min and max are drawn.
+// * @param: mode   : STRIP_SWEEP or STRIP_SCROLL.
+// * @param: fgcolor: color of the trace.
+// * @param: bgcolor: color of the background.
+// * @return: 1 in case of an error, 0 otherwise.
+int strip_chart_init(STRIP_CHART_t* chart, FRAMEBUFFER_t* fb, uint_t x,
+                     uint_t y, uint_t w, uint_t h, int vmin, int vmax,
+                     uint_t spc, uint8_t mode, COLOR_t fgcolor,
+                     COLOR_t bgcolor);
+
+// * Free the column ring and the shadow of the chart.
+// * @param: *chart: the chart to free.
+void strip_chart_free(STRIP_CHART_t* chart);
+
+// * Add a batch of samples and draw the columns they complete. Consecutive
+// * columns are joined so the trace has no holes.
+// * @param: *chart  : the chart.
+// * @param: *samples: the samples, oldest first.
+// * @param: n       : number of samples.
+// * @return: the number of columns completed.
+uint_t strip_chart_push(STRIP_CHART_t* chart, const int16_t* samples,
+                        uint_t n);
+
+// * Draw the whole chart from the column ring, after the area has been
+// * overwritten.
+// * @param: *chart: the chart.
+void strip_chart_redraw(STRIP_CHART_t* chart);
+
+#endif
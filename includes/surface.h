@@ -0,0 +1,135 @@
+#ifndef _SURFACE_H_
+#define _SURFACE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define SURFACE_t struct surface_t
+
+#define SURFACE_RGB565  0
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Pixels of row y start at pix + y * stride. A surface either owns its pixels
+// (surface_init) or is a view over a framebuffer, a RECT_CP_t or another
+// surface, the view never frees them.
+struct surface_t
+{
+    COLOR_t*    pix;
+    uint_t      w;
+    uint_t      h;
+    uint_t      stride;
+    uint8_t     format;
+    uint8_t     owner;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Allocate an off-screen surface cleared to black.
+// * @param: *surf: the structure to initialize.
+// * @param: w    : width of the surface.
+// * @param: h    : height of the surface.
+// * @return: 1 in case of an error, 0 otherwise.
+int surface_init(SURFACE_t* surf, uint_t w, uint_t h);
+
+// * Free the pixels of a surface that owns them.
+// * @param: *surf: the surface to free.
+void surface_free(SURFACE_t* surf);
+
+// * Make a surface view over contiguous pixels, rows of w pixels.
+// * @param: *surf: the structure to initialize.
+// * @param: *pix : the pixels.
+// * @param: w    : width of the pixels.
+// * @param: h    : height of the pixels.
+void surface_from_pixels(SURFACE_t* surf, COLOR_t* pix, uint_t w, uint_t h);
+
+// * Make a surface view over the pixels of a framebuffer.
+// * @param: *surf: the structure to initialize.
+// * @param: *fb  : the framebuffer.
+void surface_from_framebuffer(SURFACE_t* surf, FRAMEBUFFER_t* fb);
+
+// * Make a surface view over the pixels of a RECT_CP_t.
+// * @param: *surf: the structure to initialize.
+// * @param: *cp  : the copied rectangle.
+void surface_from_rect(SURFACE_t* surf, RECT_CP_t* cp);
+
+// * Make a surface view over an area of another surface, clipped to it.
+// * @param: *surf: the structure to initialize.
+// * @param: *src : the parent surface.
+// * @param: x    : x coordinate of the area in the parent.
+// * @param: y    : y coordinate of the area in the parent.
+// * @param: w    : width of the area.
+// * @param: h    : height of the area.
+void surface_sub(SURFACE_t* surf, SURFACE_t* src, uint_t x, uint_t y,
+                 uint_t w, uint_t h);
+
+// * Fill a FRAMEBUFFER_t that points to the surface pixels so every drawing
+// * function can render into it. Never call free_framebuffer on it.
+// * @param: *surf: the surface to render into.
+// * @param: *fb  : the framebuffer structure to fill.
+// * @return: 1 if the rows of the surface are not contiguous (a sub-surface
+// *          narrower than its parent), 0 otherwise.
+int surface_as_framebuffer(SURFACE_t* surf, FRAMEBUFFER_t* fb);
+
+// * Fill an area of a surface, clipped to it.
+// * @param: *surf : the surface.
+// * @param: x     : x coordinate of the area.
+// * @param: y     : y coordinate of the area.
+// * @param: w     : width of the area.
+// * @param: h     : height of the area.
+// * @param: color : the fill color.
+void surface_fill(SURFACE_t* surf, uint_t x, uint_t y, uint_t w, uint_t h,
+                  COLOR_t color);
+
+// * Copy an area of a surface into another one, clipped to both. Each row is
+// * a single memcpy, a whole contiguous area is copied at once and areas that
+// * overlap in the same buffer are handled.
+// * @param: *dst: the destination surface.
+// * @param: dx  : x coordinate in the destination, can be negative.
+// * @param: dy  : y coordinate in the destination, can be negative.
+// * @param: *src: the source surface.
+// * @param: sx  : x coordinate of the area in the source.
+// * @param: sy  : y coordinate of the area in the source.
+// * @param: w   : width of the area.
+// * @param: h   : height of the area.
+void surface_blit(SURFACE_t* dst, int dx, int dy, SURFACE_t* src, uint_t sx,
+                  uint_t sy, uint_t w, uint_t h);
+
+// * Copy an area of a surface into another one, pixels of the key color are
+// * not copied.
+// * @param: *dst: the destination surface.
+// * @param: dx  : x coordinate in the destination, can be negative.
+// * @param: dy  : y coordinate in the destination, can be negative.
+// * @param: *src: the source surface.
+// * @param: sx  : x coordinate of the area in the source.
+// * @param: sy  : y coordinate of the area in the source.
+// * @param: w   : width of the area.
+// * @param: h   : height of the area.
+// * @param: key : transparent color of the source.
+void surface_blit_keyed(SURFACE_t* dst, int dx, int dy, SURFACE_t* src,
+                        uint_t sx, uint_t sy, uint_t w, uint_t h,
+                        COLOR_t key);
+
+// * Blend an area of a surface over another one with a global transparency.
+// * @param: *dst : the destination surface.
+// * @param: dx   : x coordinate in the destination, can be negative.
+// * @param: dy   : y coordinate in the destination, can be negative.
+// * @param: *src : the source surface.
+// * @param: sx   : x coordinate of the area in the source.
+// * @param: sy   : y coordinate of the area in the source.
+// * @param: w    : width of the area.
+// * @param: h    : height of the area.
+// * @param: alpha: opacity of the source (0 to 255).
+void surface_blit_alpha(SURFACE_t* dst, int dx, int dy, SURFACE_t* src,
+                        uint_t sx, uint_t sy, uint_t w, uint_t h,
+                        uint8_t alpha);
+
+#endif
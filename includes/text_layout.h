@@ -0,0 +1,125 @@
+#ifndef _TEXT_LAYOUT_H_
+#define _TEXT_LAYOUT_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "iso_font.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define TEXT_LINE_t struct text_line_t
+#define TEXT_LAYOUT_t struct text_layout_t
+#define TEXT_CACHE_t struct text_cache_t
+
+#define TEXT_ALIGN_LEFT     0
+#define TEXT_ALIGN_CENTER   1
+#define TEXT_ALIGN_RIGHT    2
+
+// Longest string laid out (longer strings are truncated) and most lines of
+// a box.
+#define TEXT_MAX            256
+#define TEXT_MAX_LINES      32
+
+#define TEXT_ELLIPSIS       "..."
+#define TEXT_ELLIPSIS_LEN   3
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Bytes start;start + len of the text, trailing blanks excluded. ellipsis is
+// set on the last line of a text that does not fit in the box.
+struct text_line_t
+{
+    uint16_t    start;
+    uint16_t    len;
+    uint16_t    ellipsis;
+};
+
+
+// A layout of the text in the box x;y w*h with the built-in font, lines are
+// greedy word wrapped and a word longer than a line is cut.
+struct text_layout_t
+{
+    char            text[TEXT_MAX];
+    uint_t          len;
+    uint_t          x;
+    uint_t          y;
+    uint_t          w;
+    uint_t          h;
+    uint8_t         align;
+    uint8_t         used;
+    unsigned long   stamp;
+    TEXT_LINE_t     lines[TEXT_MAX_LINES];
+    uint_t          nlines;
+};
+
+
+// Layouts are looked up by box, the least recently used one is replaced.
+struct text_cache_t
+{
+    TEXT_LAYOUT_t*  layouts;
+    uint_t          nlayouts;
+    unsigned long   clock;
+
+    unsigned long   hits;
+    unsigned long   partial;
+    unsigned long   misses;
+    unsigned long   lines_laid;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize an empty layout cache.
+// * @param: *cache   : the structure to initialize.
+// * @param: nlayouts : number of layouts kept, one per text box on screen.
+// * @return: 1 in case of an error, 0 otherwise.
+int text_cache_init(TEXT_CACHE_t* cache, uint_t nlayouts);
+
+// * Free the layouts of the cache.
+// * @param: *cache: the cache to free.
+void text_cache_free(TEXT_CACHE_t* cache);
+
+// * Return the layout of a string in a box. The same string in the same box
+// * is not laid out again, a changed string is laid out again from the line
+// * before the first changed one.
+// * @param: *cache: the layout cache.
+// * @param: *str  : the string, '\n' starts a new line.
+// * @param: x     : x coordinate of the box.
+// * @param: y     : y coordinate of the box.
+// * @param: w     : width of the box.
+// * @param: h     : height of the box.
+// * @param: align : TEXT_ALIGN_LEFT, CENTER or RIGHT.
+// * @return: the layout, valid until the next call.
+const TEXT_LAYOUT_t* text_layout(TEXT_CACHE_t* cache, const char* str,
+                                 uint_t x, uint_t y, uint_t w, uint_t h,
+                                 uint8_t align);
+
+// * Draw a layout, the whole box is painted so the previous text is erased.
+// * @param: *fb     : the framebuffer where the text is drawn.
+// * @param: *layout : the layout.
+// * @param: fgcolor : color of the letters.
+// * @param: bgcolor : color of the box.
+void text_draw(FRAMEBUFFER_t* fb, const TEXT_LAYOUT_t* layout,
+               COLOR_t fgcolor, COLOR_t bgcolor);
+
+// * Lay out and draw a string in a box.
+// * @param: *fb     : the framebuffer where the text is drawn.
+// * @param: *cache  : the layout cache.
+// * @param: *str    : the string, '\n' starts a new line.
+// * @param: x       : x coordinate of the box.
+// * @param: y       : y coordinate of the box.
+// * @param: w       : width of the box.
+// * @param: h       : height of the box.
+// * @param: align   : TEXT_ALIGN_LEFT, CENTER or RIGHT.
+// * @param: fgcolor : color of the letters.
+// * @param: bgcolor : color of the box.
+void print_text_box(FRAMEBUFFER_t* fb, TEXT_CACHE_t* cache, const char* str,
+                    uint_t x, uint_t y, uint_t w, uint_t h, uint8_t align,
+                    COLOR_t fgcolor, COLOR_t bgcolor);
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef _TILE_POOL_H_
+#define _TILE_POOL_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef FB_THREADS
+#include <pthread.h>
+#endif
+
+#include "graphics.h"
+#include "iso_font.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define TILE_POOL_t struct tile_pool_t
+#define TILE_CMD_t struct tile_cmd_t
+#define TILE_QUEUE_t struct tile_queue_t
+
+#define TILE_DEFAULT_W 64
+#define TILE_DEFAULT_H 64
+
+#define TILE_CMD_FILL  0
+#define TILE_CMD_ALPHA 1
+#define TILE_CMD_TEXT  2
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Recorded draw command, x0;y0 - x1;y1 is its bounding box on screen.
+struct tile_cmd_t
+{
+    uint8_t     type;
+    uint8_t     alpha;
+    COLOR_t     fgcolor;
+    COLOR_t     bgcolor;
+    uint_t      x0;
+    uint_t      y0;
+    uint_t      x1;
+    uint_t      y1;
+    const void* data;
+};
+
+
+// Range of tiles owned by a worker, other workers steal from it when their own
+// range is exhausted.
+struct tile_queue_t
+{
+    struct tile_pool_t* pool;
+    volatile uint_t     next;
+    uint_t              end;
+};
+
+
+struct tile_pool_t
+{
+    FRAMEBUFFER_t*  fb;
+    uint_t          tile_w;
+    uint_t          tile_h;
+    uint_t          tiles_x;
+    uint_t          tiles_y;
+    uint_t          ntiles;
+    TILE_CMD_t*     cmds;
+    uint_t          ncmds;
+    uint_t          max_cmds;
+
+#ifdef FB_THREADS
+    uint_t*         bin_start;
+    uint_t*         bin_cmds;
+    uint_t          bin_cap;
+    uint_t          nthreads;
+    pthread_t*      threads;
+    TILE_QUEUE_t*   queues;
+    pthread_mutex_t lock;
+    pthread_cond_t  start_cond;
+    pthread_cond_t  done_cond;
+    uint_t          generation;
+    uint_t          running;
+    int             quit;
+#endif
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize the tile pool. Without FB_THREADS every command is drawn as soon
+// * as it is issued and no thread nor command list is created.
+// * @param: *pool    : the structure to initialize.
+// * @param: *fb      : the framebuffer where the commands will be rendered.
+// * @param: nthreads : number of rendering threads, including the caller.
+// * @param: max_cmds : maximum number of commands recorded between flushes.
+// * @return: 1 in case of an error, 0 otherwise.
+int tile_pool_init(TILE_POOL_t* pool, FRAMEBUFFER_t* fb,
+                   uint_t nthreads, uint_t max_cmds);
+
+// * Stop the workers and free the memory used by the pool.
+// * @param: *pool: the pool to free.
+void tile_pool_free(TILE_POOL_t* pool);
+
+// * Record a filled rectangle.
+// * @param: *pool : the pool where the command is recorded.
+// * @param: x     : start x coordinate.
+// * @param: y     : start y coordinate.
+// * @param: w     : width of the rectangle.
+// * @param: h     : height of the rectangle.
+// * @param: color : color of the rectangle.
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_draw_rect(TILE_POOL_t* pool, uint_t x, uint_t y,
+                   uint_t w, uint_t h, COLOR_t color);
+
+// * Record a fill of the entire screen.
+// * @param: *pool : the pool where the command is recorded.
+// * @param: color : color of the screen.
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_fill_screen(TILE_POOL_t* pool, COLOR_t color);
+
+// * Record a paste of a RECT_CP_t with transparency, the buffer must stay valid
+// * until the next flush.
+// * @param: *pool : the pool where the command is recorded.
+// * @param: *cp   : the RECT_CP_t buffer that contains data that will be drawn.
+// * @param: x     : x coordinate of the top-left corner.
+// * @param: y     : y coordinate of the top-left corner.
+// * @param: alpha : the value of transparency we want to apply (0 to 255).
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_write_rect_alpha(TILE_POOL_t* pool, RECT_CP_t* cp,
+                          uint_t x, uint_t y, uint8_t alpha);
+
+// * Record a string drawn on a single line, the string must stay valid until
+// * the next flush.
+// * @param: *pool  : the pool where the command is recorded.
+// * @param: *str   : the string to draw.
+// * @param: x      : x position of the first char.
+// * @param: y      : y position of the first char.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the chars.
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_print_str(TILE_POOL_t* pool, const char* str, uint_t x, uint_t y,
+                   COLOR_t fgcolor, COLOR_t bgcolor);
+
+// * Bin the recorded commands by tile and rasterize every tile, the call
+// * returns once the whole frame is drawn. Tiles are disjoint and each one runs
+// * its commands in submission order so the output is deterministic.
+// * @param: *pool: the pool to flush.
+void tile_pool_flush(TILE_POOL_t* pool);
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef _WIDGET_H_
+#define _WIDGET_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "graphics.h"
+#include "iso_font.h"
+#include "blit.h"
+
+
+// * __ DEFINITIONS ____________________________________________________________
+#define WIDGET_t struct widget_t
+#define WIDGET_TREE_t struct widget_tree_t
+#define WIDGET_RECT_t struct widget_rect_t
+
+#define WIDGET_PANEL    0
+#define WIDGET_LABEL    1
+#define WIDGET_NUMBER   2
+#define WIDGET_BAR      3
+#define WIDGET_GAUGE    4
+
+#define WIDGET_NONE     -1
+#define WIDGET_TEXT_MAX 32
+
+// Space between the border of a label or a readout and its text.
+#define WIDGET_PADDING  2
+
+
+// * __ STRUCTURE DEFINITIONS __________________________________________________
+
+// Screen area x0;y0 - x1;y1, x0 >= x1 or y0 >= y1 means empty.
+struct widget_rect_t
+{
+    uint_t  x0;
+    uint_t  y0;
+    uint_t  x1;
+    uint_t  y1;
+};
+
+
+// bounds are screen coordinates clipped to the parent, damage is the part of
+// the bounds to repaint on the next render. text is the string of a label
+// and the unit printed after the value of a number.
+struct widget_t
+{
+    uint8_t         type;
+    uint8_t         visible;
+    uint8_t         shown;
+    int             parent;
+    WIDGET_RECT_t   bounds;
+    WIDGET_RECT_t   damage;
+    COLOR_t         fgcolor;
+    COLOR_t         bgcolor;
+    int             value;
+    int             min;
+    int             max;
+    char            text[WIDGET_TEXT_MAX];
+};
+
+
+// Widgets are stored in creation order, a parent is always before its
+// children so the array order is the painting order.
+struct widget_tree_t
+{
+    FRAMEBUFFER_t*  fb;
+    WIDGET_t*       widgets;
+    uint_t          nwidgets;
+    uint_t          max_widgets;
+
+    uint_t          widgets_drawn;
+    unsigned long   pixels_drawn;
+};
+
+
+// * __ FUNCTIONS ______________________________________________________________
+
+// * Initialize an empty widget tree.
+// * @param: *tree       : the structure to initialize.
+// * @param: *fb         : the framebuffer where the widgets are rendered.
+// * @param: max_widgets : maximum number of widgets of the tree.
+// * @return: 1 in case of an error, 0 otherwise.
+int widget_tree_init(WIDGET_TREE_t* tree, FRAMEBUFFER_t* fb,
+                     uint_t max_widgets);
+
+// * Free the memory used by the widget tree.
+// * @param: *tree: the tree to free.
+void widget_tree_free(WIDGET_TREE_t* tree);
+
+// * Add a widget to the tree, it is fully invalidated.
+// * @param: *tree  : the tree where the widget is added.
+// * @param: parent : id of the parent, WIDGET_NONE for a root widget.
+// * @param: type   : WIDGET_PANEL, LABEL, NUMBER, BAR or GAUGE.
+// * @param: x      : x position relative to the parent.
+// * @param: y      : y position relative to the parent.
+// * @param: w      : width of the widget.
+// * @param: h      : height of the widget.
+// * @param: fgcolor: color of the text, bar or needle.
+// * @param: bgcolor: color of the background.
+// * @return: the id of the widget, WIDGET_NONE in case of an error.
+int widget_add(WIDGET_TREE_t* tree, int parent, uint8_t type, uint_t x,
+               uint_t y, uint_t w, uint_t h, COLOR_t fgcolor,
+               COLOR_t bgcolor);
+
+// * Set the text of a label or the unit of a number.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @param: *text: the new text, truncated to WIDGET_TEXT_MAX - 1 chars.
+void widget_set_text(WIDGET_TREE_t* tree, int id, const char* text);
+
+// * Set the value of a number, bar or gauge. Only the pixels that change are
+// * invalidated: the digits of a number, the columns between the old and the
+// * new end of a bar, the old and new needle of a gauge.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @param: value: the new value, clamped to the range of bars and gauges.
+void widget_set_value(WIDGET_TREE_t* tree, int id, int value);
+
+// * Set the range of a bar or a gauge.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @param: min  : value of an empty bar.
+// * @param: max  : value of a full bar.
+void widget_set_range(WIDGET_TREE_t* tree, int id, int min, int max);
+
+// * Show or hide a widget and its children. A hidden widget is repainted by
+// * its parent, a hidden root widget keeps its pixels.
+// * @param: *tree  : the tree of the widget.
+// * @param: id     : id of the widget.
+// * @param: visible: 1 to show the widget, 0 to hide it.
+void widget_set_visible(WIDGET_TREE_t* tree, int id, int visible);
+
+// * Invalidate the whole widget.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+void widget_invalidate(WIDGET_TREE_t* tree, int id);
+
+// * Repaint the invalidated widgets clipped to their damage, the widgets
+// * drawn over a repainted area are repainted too.
+// * @param: *tree: the tree to render.
+// * @return: the number of widgets repainted.
+uint_t widget_render(WIDGET_TREE_t* tree);
+
+#endif
@@ -4,39 +4,161 @@
 #include "utils.h"
 #include "graphics.h"
 #include "iso_font.h"
+#include "fb_stats.h"
+#include "fb_trace.h"
+#include "fb_rotate.h"
+#include "strip_chart.h"
 
 #define FB_INTERFACE "/dev/fb0"
 
+// Strip chart benchmark: samples pushed, in batches, and samples per column.
+#define BENCH_SAMPLES 1000000
+#define BENCH_BATCH   1000
+#define BENCH_SPC     10
+
 // Cursor row and col coordinates. 
 uint_t NOR; 
 uint_t NOC; 
 
 
-int main(void)
+// * Push a triangle wave into a strip chart over the bottom half of the
+// * screen and print the samples drawn per second.
+// * @param: *fb : FRAMEBUFFER_t where the chart is drawn.
+// * @param: mode: STRIP_SWEEP or STRIP_SCROLL.
+static void bench_strip_chart(FRAMEBUFFER_t* fb, uint8_t mode)
+{
+    STRIP_CHART_t chart; 
+    struct timespec t0; 
+    struct timespec t1; 
+    int16_t samples[BENCH_BATCH]; 
+    uint64_t ns; 
+    uint_t i; 
+    uint_t j; 
+
+    if (strip_chart_init(&chart, fb, 0, fb->vinfo.yres / 2, fb->vinfo.xres, 
+                         fb->vinfo.yres / 2, -1024, 1023, BENCH_SPC, mode, 
+                         GREEN, BLACK))
+        return; 
+
+    clock_gettime(CLOCK_MONOTONIC, &t0); 
+    for (i = 0; i < BENCH_SAMPLES; i += BENCH_BATCH)
+    {
+        for (j = 0; j < BENCH_BATCH; j++)
+            samples[j] = ((i + j) & 2047) < 1024 ? ((i + j) & 1023) - 512 
+                                                 : 511 - ((i + j) & 1023); 
+
+        strip_chart_push(&chart, samples, BENCH_BATCH); 
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1); 
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ULL 
+         + t1.tv_nsec - t0.tv_nsec; 
+    printf("~STRIP CHART (%s): %u samples in %lu us, %lu samples/s\n", 
+           mode == STRIP_SCROLL ? "scroll" : "sweep", BENCH_SAMPLES, 
+           (unsigned long)(ns / 1000), 
+           (unsigned long)(BENCH_SAMPLES * 1000000000ULL / (ns ? ns : 1))); 
+    strip_chart_free(&chart); 
+    return; 
+}
+
+
+int main(int argc, char** argv)
 {
 
     FRAMEBUFFER_t display; 
+    FRAMEBUFFER_t* fb; 
+    ROTATION_t rotation; 
+    char* text; 
+    int degrees; 
+    int show_info; 
+    int show_stats; 
+    int bench; 
     int retval; 
+    int opt; 
+
+    text = "bye :)"; 
+    show_info = 0; 
+    show_stats = 0; 
+    bench = 0; 
+    degrees = 0; 
+    fb_stats_init(); 
+    fb_trace_init(); 
+
+    while ((opt = getopt(argc, argv, "bhir:st:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                bench = 1; 
+                break; 
+
+            case 'i':
+                show_info = 1; 
+                break; 
+
+            case 'r':
+                degrees = atoi(optarg); 
+                break; 
+
+            case 's':
+                show_stats = 1; 
+                fb_stats_enable(1); 
+                break; 
+
+            case 't':
+                text = optarg; 
+                break; 
+
+            default:
+                print_help(); 
+                return opt != 'h'; 
+        }
+    }
 
     retval = init_framebuffer(&display, FB_INTERFACE); 
     if (retval)
         return 1; 
     
+    if (show_info)
+        display_info(&display); 
     
-    NOR = (display.vinfo.yres / ISO_CHAR_HEIGHT) - 1; 
+    // Everything is drawn in the logical orientation, then flushed. 
+    if (fb_rotation_init(&rotation, &display, degrees))
+    {
+        free_framebuffer(&display); 
+        return 1; 
+    }
+
+    fb = &rotation.view; 
+    NOR = (fb->vinfo.yres / ISO_CHAR_HEIGHT) - 1; 
     NOC = 0; 
 
-    fill_screen(&display, BLACK); 
+    fill_screen(fb, BLACK); 
+    fb_rotation_flush(&rotation); 
 
     // put_text(&display, "printing text test: \nLorem ipsum dolor sit amet, consectetur adipiscing elit. Suspendisse tincidunt risus neque, in pretium ante condimentum id. Nunc gravida semper purus, in commodo velit volutpat eget\n", WHITE, BLACK); 
     sleep(3); 
 
-    draw_piet_mondrian(&display); 
+    draw_piet_mondrian(fb); 
+    fb_rotation_flush(&rotation); 
     sleep(3); 
 
-    fill_screen(&display, BLACK); 
-    put_text(&display, "bye :)", WHITE, BLACK); 
+    if (bench)
+    {
+        bench_strip_chart(fb, STRIP_SWEEP); 
+        bench_strip_chart(fb, STRIP_SCROLL); 
+        fb_rotation_flush(&rotation); 
+    }
+
+    fill_screen(fb, BLACK); 
+    put_text(fb, text, WHITE, BLACK); 
+    fb_rotation_flush(&rotation); 
+
+    if (show_stats)
+        fb_stats_dump(stdout); 
 
+    fb_trace_finish(); 
+    fb_rotation_free(&rotation); 
     free_framebuffer(&display); 
     return 0; 
 }
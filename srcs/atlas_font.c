@@ -0,0 +1,280 @@
+#include "atlas_font.h"
+#include "psf_font.h"
+
+
+// * Blend the coverage bitmap of a glyph at position x, y.
+// * @param: *fb   : the framebuffer where the glyph is drawn.
+// * @param: *font : the atlas that holds the bitmap.
+// * @param: *g    : the glyph to draw.
+// * @param: x     : x position of the top-left corner of the bitmap.
+// * @param: y     : y position of the top-left corner of the bitmap.
+// * @param: color : color of the letter.
+static void atlas_draw_glyph(FRAMEBUFFER_t* fb, ATLAS_FONT_t* font,
+                             const ATLAS_GLYPH_t* g, int x, int y,
+                             COLOR_t color)
+{
+    const uint8_t* bits;
+    COLOR_t*       dst;
+    uint_t         pitch;
+    uint_t         cov;
+    int            i0;
+    int            i1;
+    int            j0;
+    int            j1;
+    int            i;
+    int            j;
+
+    // Clip the bitmap once against the screen.
+    i0 = y < 0 ? -y : 0;
+    j0 = x < 0 ? -x : 0;
+    i1 = g->h;
+    j1 = g->w;
+    if (y + i1 > (int)fb->vinfo.yres)
+        i1 = (int)fb->vinfo.yres - y;
+
+    if (x + j1 > (int)fb->vinfo.xres)
+        j1 = (int)fb->vinfo.xres - x;
+
+    if (i0 >= i1 || j0 >= j1)
+        return;
+
+    pitch = font->hdr->bpp == 4 ? (g->w + 1) / 2 : g->w;
+    for (i = i0; i < i1; i++)
+    {
+        bits = font->bitmaps + g->offset + i * pitch;
+        dst = fb->screen + (y + i) * fb->vinfo.xres + x;
+        for (j = j0; j < j1; j++)
+        {
+            if (font->hdr->bpp == 4)
+            {
+                cov = (bits[j >> 1] >> (j & 1 ? 0 : 4)) & 0x0F;
+                cov |= cov << 4;
+            }
+
+            else
+                cov = bits[j];
+
+            // Empty and fully covered pixels need no blending.
+            if (!cov)
+                continue;
+
+            if (cov == 0xFF)
+                dst[j] = color;
+
+            else
+                dst[j] = blend_565_a5(dst[j], color, (cov + 4) >> 3);
+        }
+    }
+
+    return;
+}
+
+
+// * Check that the bitmap of every glyph is inside the file.
+// * @param: *font: the atlas, its tables already checked.
+// * @param: *hdr : the header of the atlas.
+// * @return: 1 if a bitmap is out of the file, 0 otherwise.
+static int atlas_check_bitmaps(ATLAS_FONT_t* font, const ATLAS_HEADER_t* hdr)
+{
+    const ATLAS_GLYPH_t* g;
+    uint64_t             pitch;
+    uint_t               i;
+
+    g = (const ATLAS_GLYPH_t*)(font->data + hdr->glyph_off);
+    for (i = 0; i < hdr->nglyphs; i++, g++)
+    {
+        pitch = hdr->bpp == 4 ? (g->w + 1) / 2 : g->w;
+        if ((uint64_t)hdr->bitmap_off + g->offset + pitch * g->h
+            > font->map_size)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+// * Map a glyph atlas file produced by the fbatlas tool.
+// * @param: *font: the structure to initialize.
+// * @param: *path: path of the atlas file.
+// * @return: 1 in case of an error, 0 otherwise.
+int atlas_load(ATLAS_FONT_t* font, const char* path)
+{
+    const ATLAS_HEADER_t* hdr;
+    struct stat           st;
+    void*                 addr;
+
+    memset(font, 0, sizeof(ATLAS_FONT_t));
+    font->fd = open(path, O_RDONLY);
+    if (font->fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening atlas %s failed.\x1b[0m\n", path);
+        return 1;
+    }
+
+    if (fstat(font->fd, &st) || (size_t)st.st_size < sizeof(ATLAS_HEADER_t))
+    {
+        printf("\x1b[1;31m~[ERROR] Atlas %s is too small.\x1b[0m\n", path);
+        atlas_free(font);
+        return 1;
+    }
+
+    addr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, font->fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        printf("\x1b[1;31m~[ERROR] Mapping atlas %s failed.\x1b[0m\n", path);
+        atlas_free(font);
+        return 1;
+    }
+
+    font->data = (const uint8_t*)addr;
+    font->map_size = st.st_size;
+
+    // Check that every table and every glyph bitmap is inside the file.
+    hdr = (const ATLAS_HEADER_t*)font->data;
+    if (hdr->magic != ATLAS_MAGIC || hdr->version != ATLAS_VERSION
+        || (hdr->bpp != 4 && hdr->bpp != 8)
+        || hdr->glyph_off + (uint64_t)hdr->nglyphs * sizeof(ATLAS_GLYPH_t)
+            > font->map_size
+        || hdr->kern_off + (uint64_t)hdr->nkern * sizeof(ATLAS_KERN_t)
+            > font->map_size
+        || hdr->bitmap_off > font->map_size
+        || atlas_check_bitmaps(font, hdr))
+    {
+        printf("\x1b[1;31m~[ERROR] %s is not a glyph atlas.\x1b[0m\n", path);
+        atlas_free(font);
+        return 1;
+    }
+
+    font->hdr = hdr;
+    font->glyphs = (const ATLAS_GLYPH_t*)(font->data + hdr->glyph_off);
+    font->kerns = (const ATLAS_KERN_t*)(font->data + hdr->kern_off);
+    font->bitmaps = font->data + hdr->bitmap_off;
+    return 0;
+}
+
+
+// * Unmap the atlas.
+// * @param: *font: the atlas to free.
+void atlas_free(ATLAS_FONT_t* font)
+{
+    if (font->data)
+    {
+        munmap((void*)font->data, font->map_size);
+        font->data = NULL;
+        font->hdr = NULL;
+    }
+
+    if (font->fd >= 0)
+    {
+        close(font->fd);
+        font->fd = -1;
+    }
+
+    return;
+}
+
+
+// * Return the glyph of a code point.
+// * @param: *font: the atlas where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: the glyph, NULL if the atlas does not have it.
+const ATLAS_GLYPH_t* atlas_glyph(ATLAS_FONT_t* font, uint32_t cp)
+{
+    uint_t lo;
+    uint_t hi;
+    uint_t mid;
+
+    lo = 0;
+    hi = font->hdr->nglyphs;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (font->glyphs[mid].cp == cp)
+            return &font->glyphs[mid];
+
+        if (font->glyphs[mid].cp < cp)
+            lo = mid + 1;
+
+        else
+            hi = mid;
+    }
+
+    return NULL;
+}
+
+
+// * Return the kerning adjustment between two code points.
+// * @param: *font : the atlas.
+// * @param: left  : the code point on the left.
+// * @param: right : the code point on the right.
+// * @return: the adjustment to add to the advance, in pixels.
+int atlas_kern(ATLAS_FONT_t* font, uint32_t left, uint32_t right)
+{
+    const ATLAS_KERN_t* k;
+    uint_t              lo;
+    uint_t              hi;
+    uint_t              mid;
+
+    lo = 0;
+    hi = font->hdr->nkern;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        k = &font->kerns[mid];
+        if (k->left == left && k->right == right)
+            return k->adjust;
+
+        if (k->left < left || (k->left == left && k->right < right))
+            lo = mid + 1;
+
+        else
+            hi = mid;
+    }
+
+    return 0;
+}
+
+
+// * Blend a UTF-8 string over the screen, the background is kept.
+// * @param: *fb  : the framebuffer where the string is drawn.
+// * @param: *font: the atlas to use.
+// * @param: *str : the UTF-8 string to draw.
+// * @param: x    : x position of the pen.
+// * @param: y    : y position of the top of the line.
+// * @param: color: color of the letters.
+// * @return: the x position of the pen after the string.
+int atlas_print_utf8(FRAMEBUFFER_t* fb, ATLAS_FONT_t* font, const char* str,
+                     int x, int y, COLOR_t color)
+{
+    const ATLAS_GLYPH_t* g;
+    uint32_t             prev;
+    uint32_t             cp;
+
+    if (!str)
+        return x;
+
+    prev = 0;
+    while (*str && x < (int)fb->vinfo.xres)
+    {
+        cp = utf8_decode(&str);
+        if (prev && font->hdr->nkern)
+            x += atlas_kern(font, prev, cp);
+
+        // Code points without glyph advance like a space.
+        g = atlas_glyph(font, cp);
+        if (!g)
+        {
+            x += font->hdr->space_advance;
+            prev = 0;
+            continue;
+        }
+
+        if (g->w && g->h)
+            atlas_draw_glyph(fb, font, g, x + g->off_x, y + g->off_y, color);
+
+        x += g->advance;
+        prev = cp;
+    }
+
+    return x;
+}
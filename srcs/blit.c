@@ -0,0 +1,350 @@
+#include "blit.h"
+
+
+// sin() of 0 to 90 degrees in 16.16 fixed point.
+static const int32_t SIN_DEG[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987,
+    9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+    18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607,
+    26656, 27697, 28729, 29753, 30767, 31772, 32768, 33754,
+    34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930,
+    48703, 49461, 50203, 50931, 51643, 52339, 53020, 53684,
+    54332, 54963, 55578, 56175, 56756, 57319, 57865, 58393,
+    58903, 59396, 59870, 60326, 60764, 61183, 61584, 61966,
+    62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446,
+    65496, 65526, 65536
+};
+
+
+// * Return the sine and cosine of an angle in 16.16 fixed point.
+// * @param: angle: the angle in degrees, any value.
+// * @param: *s   : sine of the angle.
+// * @param: *c   : cosine of the angle.
+void blit_sincos(int angle, int32_t* s, int32_t* c)
+{
+    angle %= 360;
+    if (angle < 0)
+        angle += 360;
+
+    if (angle <= 90)
+    {
+        *s = SIN_DEG[angle];
+        *c = SIN_DEG[90 - angle];
+    }
+
+    else if (angle <= 180)
+    {
+        *s = SIN_DEG[180 - angle];
+        *c = -SIN_DEG[angle - 90];
+    }
+
+    else if (angle <= 270)
+    {
+        *s = -SIN_DEG[angle - 180];
+        *c = -SIN_DEG[270 - angle];
+    }
+
+    else
+    {
+        *s = -SIN_DEG[360 - angle];
+        *c = SIN_DEG[angle - 270];
+    }
+
+    return;
+}
+
+
+// * Divide rounding toward minus infinity.
+// * @param: a: the dividend.
+// * @param: b: the divisor, not 0.
+// * @return: floor(a / b).
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q;
+
+    q = a / b;
+    if ((a % b) && ((a < 0) != (b < 0)))
+        q--;
+
+    return q;
+}
+
+
+// * Restrict the steps [*k0, *k1) to the ones where lo <= p + k * dp < hi.
+// * @param: p  : coordinate at step 0.
+// * @param: dp : coordinate increment between two steps.
+// * @param: lo : lowest valid coordinate.
+// * @param: hi : end of the valid coordinates.
+// * @param: *k0: first step, raised if needed.
+// * @param: *k1: end of the steps, lowered if needed.
+static void blit_span(int64_t p, int64_t dp, int64_t lo, int64_t hi,
+                      int64_t* k0, int64_t* k1)
+{
+    int64_t a;
+    int64_t b;
+
+    if (!dp)
+    {
+        if (p < lo || p >= hi)
+            *k1 = *k0;
+
+        return;
+    }
+
+    if (dp > 0)
+    {
+        a = -floor_div(p - lo, dp);
+        b = -floor_div(p - hi, dp);
+    }
+
+    else
+    {
+        a = floor_div(p - hi, -dp) + 1;
+        b = floor_div(p - lo, -dp) + 1;
+    }
+
+    *k0 = a > *k0 ? a : *k0;
+    *k1 = b < *k1 ? b : *k1;
+    return;
+}
+
+
+// * Sample a RECT_CP_t between four pixels, the weights are reduced to 5 bits
+// * so the components are blended at once.
+// * @param: *src: the pixels.
+// * @param: w   : width of the pixels.
+// * @param: u   : x coordinate (16.16), lower than (w - 1) << 16.
+// * @param: v   : y coordinate (16.16), lower than (h - 1) << 16.
+// * @return: the filtered color.
+static inline COLOR_t blit_bilinear(const COLOR_t* src, uint_t w,
+                                    uint32_t u, uint32_t v)
+{
+    const COLOR_t* p;
+    COLOR_t        top;
+    COLOR_t        bottom;
+    uint8_t        fx;
+    uint8_t        fy;
+
+    p = src + (v >> BLIT_SHIFT) * w + (u >> BLIT_SHIFT);
+    fx = (u >> (BLIT_SHIFT - 5)) & 31;
+    fy = (v >> (BLIT_SHIFT - 5)) & 31;
+    top = blend_565_a5(p[0], p[1], fx);
+    bottom = blend_565_a5(p[w], p[w + 1], fx);
+    return blend_565_a5(top, bottom, fy);
+}
+
+
+// * Draw a RECT_CP_t stretched to w * h pixels. The destination is clipped
+// * once, the rows only step the source coordinates. A source wider or
+// * taller than BLIT_SRC_MAX is not drawn.
+// * @param: *fb   : FRAMEBUFFER_t where the copy will be drawn.
+// * @param: *src  : the RECT_CP_t to draw.
+// * @param: x     : x coordinate of the top-left corner, can be off screen.
+// * @param: y     : y coordinate of the top-left corner, can be off screen.
+// * @param: w     : width of the drawn rectangle.
+// * @param: h     : height of the drawn rectangle.
+// * @param: filter: BLIT_NEAREST or BLIT_BILINEAR.
+void blit_scaled(FRAMEBUFFER_t* fb, RECT_CP_t* src, int x, int y,
+                 uint_t w, uint_t h, int filter)
+{
+    const COLOR_t* row;
+    COLOR_t*       dst;
+    uint32_t       u0;
+    uint32_t       v0;
+    uint32_t       du;
+    uint32_t       dv;
+    uint32_t       u;
+    int            i0;
+    int            i1;
+    int            j0;
+    int            j1;
+    int            i;
+    int            j;
+
+    if (!src || !src->w || !src->h || !w || !h || src->w > BLIT_SRC_MAX
+        || src->h > BLIT_SRC_MAX)
+        return;
+
+    // Clip the destination once, the source start is moved accordingly.
+    i0 = y < 0 ? -y : 0;
+    j0 = x < 0 ? -x : 0;
+    i1 = (int64_t)y + h > fb->vinfo.yres ? (int)fb->vinfo.yres - y : (int)h;
+    j1 = (int64_t)x + w > fb->vinfo.xres ? (int)fb->vinfo.xres - x : (int)w;
+    if (i0 >= i1 || j0 >= j1)
+        return;
+
+    if (src->w < 2 || src->h < 2)
+        filter = BLIT_NEAREST;
+
+    if (filter == BLIT_BILINEAR)
+    {
+        // The corners map on the corners and the coordinates stay below the
+        // last pixel, so the right and bottom neighbours always exist.
+        du = w > 1 ? (((src->w - 1) << BLIT_SHIFT) - 1) / (w - 1) : 0;
+        dv = h > 1 ? (((src->h - 1) << BLIT_SHIFT) - 1) / (h - 1) : 0;
+        u0 = 0;
+        v0 = 0;
+    }
+
+    else
+    {
+        // Sample the center of each destination pixel.
+        du = (src->w << BLIT_SHIFT) / w;
+        dv = (src->h << BLIT_SHIFT) / h;
+        u0 = du / 2;
+        v0 = dv / 2;
+    }
+
+    u0 += j0 * du;
+    dst = fb->screen + (y + i0) * fb->vinfo.xres + x + j0;
+    for (i = i0; i < i1; i++)
+    {
+        u = u0;
+        if (filter == BLIT_BILINEAR)
+        {
+            for (j = j0; j < j1; j++, u += du)
+                dst[j - j0] = blit_bilinear(src->buf, src->w, u, v0 + i * dv);
+        }
+
+        else
+        {
+            row = src->buf + ((v0 + i * dv) >> BLIT_SHIFT) * src->w;
+            for (j = j0; j < j1; j++, u += du)
+                dst[j - j0] = row[u >> BLIT_SHIFT];
+        }
+
+        dst += fb->vinfo.xres;
+    }
+
+    return;
+}
+
+
+// * Draw a RECT_CP_t rotated clockwise around a pivot. Each row only draws
+// * the span that maps inside the source, computed before the row.
+// * @param: *fb   : FRAMEBUFFER_t where the copy will be drawn.
+// * @param: *src  : the RECT_CP_t to draw.
+// * @param: cx    : x coordinate of the pivot on screen.
+// * @param: cy    : y coordinate of the pivot on screen.
+// * @param: px    : x coordinate of the pivot in the source.
+// * @param: py    : y coordinate of the pivot in the source.
+// * @param: angle : rotation in degrees, any value.
+// * @param: filter: BLIT_NEAREST or BLIT_BILINEAR.
+void blit_rotated(FRAMEBUFFER_t* fb, RECT_CP_t* src, int cx, int cy,
+                  int px, int py, int angle, int filter)
+{
+    COLOR_t* dst;
+    int32_t  s;
+    int32_t  c;
+    int32_t  u;
+    int32_t  v;
+    int64_t  rx;
+    int64_t  ry;
+    int64_t  px_min;
+    int64_t  px_max;
+    int64_t  py_min;
+    int64_t  py_max;
+    int64_t  x0;
+    int64_t  x1;
+    int64_t  y0;
+    int64_t  y1;
+    int64_t  k0;
+    int64_t  k1;
+    int      k;
+    int64_t  yy;
+    int64_t  hi_u;
+    int64_t  hi_v;
+    int64_t  bias;
+    int64_t  u_row;
+    int64_t  v_row;
+    int      n;
+
+    if (!src || !src->w || !src->h)
+        return;
+
+    if (src->w < 2 || src->h < 2)
+        filter = BLIT_NEAREST;
+
+    blit_sincos(angle, &s, &c);
+
+    // Bounding box of the rotated corners, clipped to the screen.
+    px_min = INT64_MAX;
+    px_max = INT64_MIN;
+    py_min = INT64_MAX;
+    py_max = INT64_MIN;
+    for (n = 0; n < 4; n++)
+    {
+        rx = (n & 1 ? (int64_t)src->w : 0) - px;
+        ry = (n & 2 ? (int64_t)src->h : 0) - py;
+        k0 = (c * rx - s * ry) >> BLIT_SHIFT;
+        k1 = (s * rx + c * ry) >> BLIT_SHIFT;
+        px_min = k0 < px_min ? k0 : px_min;
+        px_max = k0 > px_max ? k0 : px_max;
+        py_min = k1 < py_min ? k1 : py_min;
+        py_max = k1 > py_max ? k1 : py_max;
+    }
+
+    x0 = cx + px_min - 1;
+    x1 = cx + px_max + 2;
+    y0 = cy + py_min - 1;
+    y1 = cy + py_max + 2;
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > fb->vinfo.xres ? fb->vinfo.xres : x1;
+    y1 = y1 > fb->vinfo.yres ? fb->vinfo.yres : y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    // Bilinear sampling needs the right and bottom neighbours, nearest
+    // sampling rounds to the closest pixel.
+    if (filter == BLIT_BILINEAR)
+    {
+        hi_u = (int64_t)(src->w - 1) << BLIT_SHIFT;
+        hi_v = (int64_t)(src->h - 1) << BLIT_SHIFT;
+        bias = 0;
+    }
+
+    else
+    {
+        hi_u = (int64_t)src->w << BLIT_SHIFT;
+        hi_v = (int64_t)src->h << BLIT_SHIFT;
+        bias = BLIT_ONE / 2;
+    }
+
+    // Inverse rotation of the screen pixel, the source moves by (c, -s)
+    // along a row and by (s, c) between rows.
+    for (yy = y0; yy < y1; yy++)
+    {
+        u_row = ((int64_t)px << BLIT_SHIFT) + bias + c * (x0 - cx)
+                + s * (yy - cy);
+        v_row = ((int64_t)py << BLIT_SHIFT) + bias - s * (x0 - cx)
+                + c * (yy - cy);
+
+        k0 = 0;
+        k1 = x1 - x0;
+        blit_span(u_row, c, 0, hi_u, &k0, &k1);
+        blit_span(v_row, -s, 0, hi_v, &k0, &k1);
+        if (k0 >= k1)
+            continue;
+
+        u = (int32_t)(u_row + k0 * c);
+        v = (int32_t)(v_row - k0 * s);
+        dst = fb->screen + yy * fb->vinfo.xres + x0;
+        if (filter == BLIT_BILINEAR)
+        {
+            for (k = k0; k < k1; k++, u += c, v -= s)
+                dst[k] = blit_bilinear(src->buf, src->w, u, v);
+        }
+
+        else
+        {
+            for (k = k0; k < k1; k++, u += c, v -= s)
+                dst[k] = src->buf[(v >> BLIT_SHIFT) * src->w
+                                  + (u >> BLIT_SHIFT)];
+        }
+    }
+
+    return;
+}
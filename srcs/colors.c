@@ -1,43 +1,79 @@
 #include "colors.h"
 
 
+// Default 16 colors palette and the one currently used by palette().
+static const COLOR_t DEFAULT_PALETTE[PALETTE_SIZE] = {
+    BLACK, DRED, DGREE, DBLUE, DYELL, DMAGE, DCYAN, DGREY,
+    RED, GREEN, BLUE, YELLOW, MAGEN, CYAN, GREY, WHITE
+};
+
+static const COLOR_t* active_palette = DEFAULT_PALETTE;
+
+// 4x4 Bayer matrix scaled to the quantization step of 5 bits (0 - 7) and
+// 6 bits (0 - 3) channels.
+static const uint8_t DITHER_5[4][4] = {
+    {0, 4, 1, 5}, {6, 2, 7, 3}, {1, 5, 0, 4}, {7, 3, 6, 2}
+};
+
+static const uint8_t DITHER_6[4][4] = {
+    {0, 2, 0, 2}, {3, 1, 3, 1}, {0, 2, 0, 2}, {3, 1, 3, 1}
+};
+
+
+// * Return a color of the active palette.
+// * @param: c: index of the color (0 - 15), out of range index return the last
+// *           color of the palette.
+// * @return: the 16 bits color.
 unsigned short palette(int c)
 {
-  switch(c) 
-  {
-    case 0:
-      return BLACK;
-    case 1:
-      return DRED;
-    case 2:
-      return DGREE;
-    case 3:
-      return DBLUE;
-    case 4:
-      return DYELL;
-    case 5:
-      return DMAGE;
-    case 6:
-      return DCYAN;
-    case 7:
-      return DGREY;
-    case 8:
-      return RED;
-    case 9:
-      return GREEN;
-    case 10:
-      return BLUE;
-    case 11:
-      return YELLOW;
-    case 12:
-      return MAGEN;
-    case 13:
-      return CYAN;
-    case 14:
-      return GREY;
-    default:
-      return WHITE;
-  }
+    if (c < 0 || c >= PALETTE_SIZE)
+        c = PALETTE_SIZE - 1;
+
+    return active_palette[c];
+}
+
+
+// * Swap the active palette, the table is used in place and must stay valid.
+// * @param: *table: PALETTE_SIZE colors, NULL to restore the default palette.
+void palette_set(const COLOR_t* table)
+{
+    active_palette = table ? table : DEFAULT_PALETTE;
+    return;
+}
+
+
+// * Load a palette from a text file containing one RRGGBB hex color per line.
+// * @param: *path : path of the palette file.
+// * @param: *table: PALETTE_SIZE colors filled with the file content, missing
+// *                 entries keep their value.
+// * @return: 1 in case of an error, 0 otherwise.
+int palette_load(const char* path, COLOR_t* table)
+{
+    FILE*        file;
+    char         line[64];
+    unsigned int rgb;
+    int          i;
+
+    file = fopen(path, "r");
+    if (!file)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening palette %s failed.\x1b[0m\n", path);
+        return 1;
+    }
+
+    // Skip empty lines and comments starting with '#'.
+    i = 0;
+    while (i < PALETTE_SIZE && fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, " %6x", &rgb) != 1)
+            continue;
+
+        table[i] = RGB888_TO_565(rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF);
+        i++;
+    }
+
+    fclose(file);
+    return 0;
 }
 
 
@@ -85,4 +121,141 @@ COLOR_t blend_16bits_color(COLOR_t src, COLOR_t dst, uint8_t alpha)
     uint8_t out_b = (dst_b * (255 - alpha) + src_b * alpha) / 255;
 
     return (out_r << 11) | (out_g << 5) | out_b;
+}
+
+
+// * Add a dithering offset to an 8 bits component, saturating at 255.
+// * @param: v: the component.
+// * @param: d: the offset.
+// * @return: the offset component.
+static inline uint8_t dither_add(uint8_t v, uint8_t d)
+{
+    return v + d > 255 ? 255 : v + d;
+}
+
+
+// * Return a color from 8 bits r, g, b value with 4x4 ordered dithering.
+// * @param: r: 8 bits red value.
+// * @param: g: 8 bits green value.
+// * @param: b: 8 bits blue value.
+// * @param: x: x position of the pixel on screen.
+// * @param: y: y position of the pixel on screen.
+// * @return: the 16 bits color.
+COLOR_t color_from_rgb888_dither(uint8_t r, uint8_t g, uint8_t b,
+                                 unsigned int x, unsigned int y)
+{
+    uint8_t d5;
+    uint8_t d6;
+
+    d5 = DITHER_5[y & 3][x & 3];
+    d6 = DITHER_6[y & 3][x & 3];
+
+    return RGB888_TO_565(dither_add(r, d5), dither_add(g, d6),
+                         dither_add(b, d5));
+}
+
+
+// * Convert a span of packed 24 bits RGB pixels into 16 bits colors.
+// * @param: *dst  : destination of the n converted colors.
+// * @param: *src  : n pixels stored as r, g, b bytes.
+// * @param: n     : number of pixels to convert.
+// * @param: x     : x position of the first pixel on screen (for dithering).
+// * @param: y     : y position of the span on screen (for dithering).
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void rgb888_to_565_span(COLOR_t* dst, const uint8_t* src, unsigned int n,
+                        unsigned int x, unsigned int y, int dither)
+{
+    const uint8_t* d5;
+    const uint8_t* d6;
+    unsigned int   i;
+
+    if (!dither)
+    {
+        for (i = 0; i < n; i++, src += 3)
+            dst[i] = RGB888_TO_565(src[0], src[1], src[2]);
+
+        return;
+    }
+
+    // The matrix row only depends on y, fetch it once for the whole span.
+    d5 = DITHER_5[y & 3];
+    d6 = DITHER_6[y & 3];
+    for (i = 0; i < n; i++, x++, src += 3)
+        dst[i] = RGB888_TO_565(dither_add(src[0], d5[x & 3]),
+                               dither_add(src[1], d6[x & 3]),
+                               dither_add(src[2], d5[x & 3]));
+
+    return;
+}
+
+
+// * Convert a span of 32 bits ARGB pixels into 16 bits colors, alpha is
+// * ignored.
+// * @param: *dst  : destination of the n converted colors.
+// * @param: *src  : n pixels stored as 0xAARRGGBB words.
+// * @param: n     : number of pixels to convert.
+// * @param: x     : x position of the first pixel on screen (for dithering).
+// * @param: y     : y position of the span on screen (for dithering).
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void argb8888_to_565_span(COLOR_t* dst, const uint32_t* src, unsigned int n,
+                          unsigned int x, unsigned int y, int dither)
+{
+    const uint8_t* d5;
+    const uint8_t* d6;
+    uint32_t       p;
+    unsigned int   i;
+
+    if (!dither)
+    {
+        // Shift each component in place, no need to unpack them.
+        for (i = 0; i < n; i++)
+        {
+            p = src[i];
+            dst[i] = ((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0)
+                   | ((p >> 3) & 0x001F);
+        }
+
+        return;
+    }
+
+    d5 = DITHER_5[y & 3];
+    d6 = DITHER_6[y & 3];
+    for (i = 0; i < n; i++, x++)
+    {
+        p = src[i];
+        dst[i] = RGB888_TO_565(dither_add((p >> 16) & 0xFF, d5[x & 3]),
+                               dither_add((p >> 8) & 0xFF, d6[x & 3]),
+                               dither_add(p & 0xFF, d5[x & 3]));
+    }
+
+    return;
+}
+
+
+// * Expand a span of 16 bits colors into packed 24 bits RGB pixels, the low
+// * bits are filled by replicating the high ones so white stays 0xFFFFFF.
+// * @param: *dst: destination of the n pixels stored as r, g, b bytes.
+// * @param: *src: n colors to convert.
+// * @param: n   : number of pixels to convert.
+void rgb565_to_888_span(uint8_t* dst, const COLOR_t* src, unsigned int n)
+{
+    COLOR_t      c;
+    uint8_t      r;
+    uint8_t      g;
+    uint8_t      b;
+    unsigned int i;
+
+    for (i = 0; i < n; i++, dst += 3)
+    {
+        c = src[i];
+        r = (c >> 11) & 0x1F;
+        g = (c >> 5) & 0x3F;
+        b = c & 0x1F;
+
+        dst[0] = (r << 3) | (r >> 2);
+        dst[1] = (g << 2) | (g >> 4);
+        dst[2] = (b << 3) | (b >> 2);
+    }
+
+    return;
 }
\ No newline at end of file
@@ -0,0 +1,437 @@
+#include "compositor.h"
+
+
+// * Mark the tiles under a screen area as damaged.
+// * @param: *comp: the compositor.
+// * @param: x0   : left border of the area, can be negative.
+// * @param: y0   : top border of the area, can be negative.
+// * @param: x1   : right border of the area (excluded).
+// * @param: y1   : bottom border of the area (excluded).
+static void compositor_damage(COMPOSITOR_t* comp, int x0, int y0, int x1,
+                              int y1)
+{
+    uint_t ty;
+
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > (int)comp->fb->vinfo.xres ? (int)comp->fb->vinfo.xres : x1;
+    y1 = y1 > (int)comp->fb->vinfo.yres ? (int)comp->fb->vinfo.yres : y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    for (ty = y0 / COMPOSITOR_TILE; ty <= (uint_t)(y1 - 1) / COMPOSITOR_TILE;
+         ty++)
+        memset(comp->damage + ty * comp->tiles_x + x0 / COMPOSITOR_TILE, 1,
+               (x1 - 1) / COMPOSITOR_TILE - x0 / COMPOSITOR_TILE + 1);
+
+    return;
+}
+
+
+// * Damage the whole area of a layer on screen.
+// * @param: *comp : the compositor.
+// * @param: *layer: the layer.
+static void layer_damage_all(COMPOSITOR_t* comp, LAYER_t* layer)
+{
+    compositor_damage(comp, layer->x, layer->y, layer->x + (int)layer->w,
+                      layer->y + (int)layer->h);
+    return;
+}
+
+
+// * Sort the stacking order by z, then by creation order.
+// * @param: *comp: the compositor.
+static void compositor_sort(COMPOSITOR_t* comp)
+{
+    uint_t i;
+    uint_t j;
+    int    id;
+
+    for (i = 1; i < comp->nlayers; i++)
+    {
+        id = comp->order[i];
+        j = i;
+        while (j > 0 && (comp->layers[comp->order[j - 1]].z
+                         > comp->layers[id].z
+                         || (comp->layers[comp->order[j - 1]].z
+                             == comp->layers[id].z
+                             && comp->order[j - 1] > id)))
+        {
+            comp->order[j] = comp->order[j - 1];
+            j--;
+        }
+
+        comp->order[j] = id;
+    }
+
+    return;
+}
+
+
+// * Initialize a compositor without any layer, the whole screen is damaged.
+// * @param: *comp      : the structure to initialize.
+// * @param: *fb        : the framebuffer that receives the final image.
+// * @param: max_layers : maximum number of layers.
+// * @param: bgcolor    : color of the pixels covered by no layer.
+// * @return: 1 in case of an error, 0 otherwise.
+int compositor_init(COMPOSITOR_t* comp, FRAMEBUFFER_t* fb, uint_t max_layers,
+                    COLOR_t bgcolor)
+{
+    memset(comp, 0, sizeof(COMPOSITOR_t));
+    comp->fb = fb;
+    comp->max_layers = max_layers;
+    comp->bgcolor = bgcolor;
+    comp->tiles_x = (fb->vinfo.xres + COMPOSITOR_TILE - 1) / COMPOSITOR_TILE;
+    comp->tiles_y = (fb->vinfo.yres + COMPOSITOR_TILE - 1) / COMPOSITOR_TILE;
+    comp->layers = calloc(max_layers, sizeof(LAYER_t));
+    comp->order = malloc(sizeof(int) * max_layers);
+    comp->damage = malloc(comp->tiles_x * comp->tiles_y);
+    if (!comp->layers || !comp->order || !comp->damage)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the compositor failed.\x1b[0m\n");
+        compositor_free(comp);
+        return 1;
+    }
+
+    compositor_damage_all(comp);
+    return 0;
+}
+
+
+// * Free the compositor and the pixels of every layer.
+// * @param: *comp: the compositor to free.
+void compositor_free(COMPOSITOR_t* comp)
+{
+    uint_t i;
+
+    for (i = 0; comp->layers && i < comp->nlayers; i++)
+    {
+        free(comp->layers[i].pix);
+        free(comp->layers[i].alpha);
+    }
+
+    free(comp->layers);
+    free(comp->order);
+    free(comp->damage);
+    comp->layers = NULL;
+    comp->order = NULL;
+    comp->damage = NULL;
+    comp->nlayers = 0;
+    return;
+}
+
+
+// * Add a visible and opaque layer cleared to black, at 0;0.
+// * @param: *comp : the compositor.
+// * @param: w     : width of the layer.
+// * @param: h     : height of the layer.
+// * @param: z     : stacking order, higher is on top.
+// * @param: flags : LAYER_ALPHA_PIXEL to allocate a per-pixel alpha plane,
+// *                cleared to transparent.
+// * @return: the id of the layer, LAYER_NONE in case of an error.
+int layer_add(COMPOSITOR_t* comp, uint_t w, uint_t h, int z, uint_t flags)
+{
+    SURFACE_t surf;
+    LAYER_t*  layer;
+
+    if (comp->nlayers >= comp->max_layers || !w || !h)
+        return LAYER_NONE;
+
+    layer = &comp->layers[comp->nlayers];
+    memset(layer, 0, sizeof(LAYER_t));
+    layer->pix = calloc(w * h, sizeof(COLOR_t));
+    if (flags & LAYER_ALPHA_PIXEL)
+        layer->alpha = calloc(w * h, 1);
+
+    if (!layer->pix || ((flags & LAYER_ALPHA_PIXEL) && !layer->alpha))
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating a layer failed.\x1b[0m\n");
+        free(layer->pix);
+        free(layer->alpha);
+        return LAYER_NONE;
+    }
+
+    layer->w = w;
+    layer->h = h;
+    layer->z = z;
+    layer->visible = 1;
+    layer->opacity = LAYER_OPAQUE;
+
+    surface_from_pixels(&surf, layer->pix, w, h);
+    surface_as_framebuffer(&surf, &layer->view);
+
+    comp->order[comp->nlayers] = comp->nlayers;
+    comp->nlayers++;
+    compositor_sort(comp);
+    layer_damage_all(comp, layer);
+    return comp->nlayers - 1;
+}
+
+
+// * Return a layer of the compositor.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @return: the layer, NULL if the id is not valid.
+LAYER_t* layer_get(COMPOSITOR_t* comp, int id)
+{
+    if (id < 0 || (uint_t)id >= comp->nlayers)
+        return NULL;
+
+    return &comp->layers[id];
+}
+
+
+// * Notify that an area of a layer has been redrawn.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @param: x    : x coordinate of the area in the layer.
+// * @param: y    : y coordinate of the area in the layer.
+// * @param: w    : width of the area.
+// * @param: h    : height of the area.
+void layer_damage(COMPOSITOR_t* comp, int id, uint_t x, uint_t y, uint_t w,
+                  uint_t h)
+{
+    LAYER_t* layer;
+
+    layer = layer_get(comp, id);
+    if (!layer || !layer->visible || x >= layer->w || y >= layer->h)
+        return;
+
+    w = w > layer->w - x ? layer->w - x : w;
+    h = h > layer->h - y ? layer->h - y : h;
+    compositor_damage(comp, layer->x + (int)x, layer->y + (int)y,
+                      layer->x + (int)(x + w), layer->y + (int)(y + h));
+    return;
+}
+
+
+// * Move a layer, the old and the new areas are damaged.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @param: x    : new x position on screen, can be negative.
+// * @param: y    : new y position on screen, can be negative.
+void layer_move(COMPOSITOR_t* comp, int id, int x, int y)
+{
+    LAYER_t* layer;
+
+    layer = layer_get(comp, id);
+    if (!layer || (layer->x == x && layer->y == y))
+        return;
+
+    if (layer->visible)
+        layer_damage_all(comp, layer);
+
+    layer->x = x;
+    layer->y = y;
+    if (layer->visible)
+        layer_damage_all(comp, layer);
+
+    return;
+}
+
+
+// * Change the stacking order of a layer.
+// * @param: *comp: the compositor.
+// * @param: id   : id of the layer.
+// * @param: z    : new stacking order.
+void layer_set_z(COMPOSITOR_t* comp, int id, int z)
+{
+    LAYER_t* layer;
+
+    layer = layer_get(comp, id);
+    if (!layer || layer->z == z)
+        return;
+
+    layer->z = z;
+    compositor_sort(comp);
+    if (layer->visible)
+        layer_damage_all(comp, layer);
+
+    return;
+}
+
+
+// * Show or hide a layer, the layers below are uncovered without being
+// * redrawn by the caller.
+// * @param: *comp   : the compositor.
+// * @param: id      : id of the layer.
+// * @param: visible : 1 to show the layer, 0 to hide it.
+void layer_set_visible(COMPOSITOR_t* comp, int id, int visible)
+{
+    LAYER_t* layer;
+
+    layer = layer_get(comp, id);
+    if (!layer || layer->visible == !!visible)
+        return;
+
+    layer->visible = !!visible;
+    layer_damage_all(comp, layer);
+    return;
+}
+
+
+// * Set the global opacity of a layer.
+// * @param: *comp   : the compositor.
+// * @param: id      : id of the layer.
+// * @param: opacity : 0 (invisible) to LAYER_OPAQUE.
+void layer_set_opacity(COMPOSITOR_t* comp, int id, uint8_t opacity)
+{
+    LAYER_t* layer;
+
+    layer = layer_get(comp, id);
+    if (!layer || layer->opacity == opacity)
+        return;
+
+    layer->opacity = opacity;
+    if (layer->visible)
+        layer_damage_all(comp, layer);
+
+    return;
+}
+
+
+// * Damage the whole screen.
+// * @param: *comp: the compositor.
+void compositor_damage_all(COMPOSITOR_t* comp)
+{
+    memset(comp->damage, 1, comp->tiles_x * comp->tiles_y);
+    return;
+}
+
+
+// * Draw a row of a layer over the screen.
+// * @param: *layer: the layer.
+// * @param: *dst  : first screen pixel of the span.
+// * @param: x     : screen x coordinate of the span.
+// * @param: y     : screen y coordinate of the span.
+// * @param: n     : length of the span, inside the layer.
+static void layer_blend_span(LAYER_t* layer, COLOR_t* dst, int x, int y,
+                             uint_t n)
+{
+    const COLOR_t* src;
+    const uint8_t* alpha;
+    uint_t         op;
+    uint_t         a;
+    uint_t         i;
+
+    src = layer->pix + (y - layer->y) * layer->w + (x - layer->x);
+    op = (layer->opacity * 32 + 127) / 255;
+    if (!layer->alpha)
+    {
+        if (op == 32)
+            memcpy(dst, src, sizeof(COLOR_t) * n);
+
+        else
+            for (i = 0; i < n; i++)
+                dst[i] = blend_565_a5(dst[i], src[i], op);
+
+        return;
+    }
+
+    alpha = layer->alpha + (src - layer->pix);
+    for (i = 0; i < n; i++)
+    {
+        a = (alpha[i] * op + 128) >> 8;
+        if (a == 32)
+            dst[i] = src[i];
+
+        else if (a)
+            dst[i] = blend_565_a5(dst[i], src[i], a);
+    }
+
+    return;
+}
+
+
+// * Composite a tile of the screen.
+// * @param: *comp: the compositor.
+// * @param: tx   : column of the tile.
+// * @param: ty   : row of the tile.
+static void compositor_tile(COMPOSITOR_t* comp, uint_t tx, uint_t ty)
+{
+    LAYER_t* layer;
+    COLOR_t* row;
+    int      x0;
+    int      x1;
+    int      y1;
+    int      a;
+    int      b;
+    int      y;
+    int      k;
+    int      base;
+    uint_t   i;
+
+    x0 = tx * COMPOSITOR_TILE;
+    y = ty * COMPOSITOR_TILE;
+    x1 = x0 + COMPOSITOR_TILE > (int)comp->fb->vinfo.xres ?
+         (int)comp->fb->vinfo.xres : x0 + COMPOSITOR_TILE;
+    y1 = y + COMPOSITOR_TILE > (int)comp->fb->vinfo.yres ?
+         (int)comp->fb->vinfo.yres : y + COMPOSITOR_TILE;
+
+    for (; y < y1; y++)
+    {
+        row = comp->fb->screen + y * comp->fb->vinfo.xres;
+
+        // The topmost opaque layer covering the whole row hides the others.
+        for (base = comp->nlayers - 1; base >= 0; base--)
+        {
+            layer = &comp->layers[comp->order[base]];
+            if (layer->visible && layer->opacity == LAYER_OPAQUE
+                && !layer->alpha && y >= layer->y
+                && y < layer->y + (int)layer->h && layer->x <= x0
+                && layer->x + (int)layer->w >= x1)
+                break;
+        }
+
+        if (base < 0)
+        {
+            for (i = x0; i < (uint_t)x1; i++)
+                row[i] = comp->bgcolor;
+
+            base = 0;
+        }
+
+        for (k = base; k < (int)comp->nlayers; k++)
+        {
+            layer = &comp->layers[comp->order[k]];
+            if (!layer->visible || !layer->opacity || y < layer->y
+                || y >= layer->y + (int)layer->h)
+                continue;
+
+            a = layer->x > x0 ? layer->x : x0;
+            b = layer->x + (int)layer->w < x1 ? layer->x + (int)layer->w : x1;
+            if (a >= b)
+                continue;
+
+            layer_blend_span(layer, row + a, a, y, b - a);
+            comp->pixels_blended += b - a;
+        }
+    }
+
+    return;
+}
+
+
+// * Recomposite the damaged tiles into the framebuffer. In each tile row the
+// * layers under the topmost opaque layer covering the row are skipped.
+// * @param: *comp: the compositor.
+// * @return: the number of tiles composited.
+uint_t compositor_render(COMPOSITOR_t* comp)
+{
+    uint_t tx;
+    uint_t ty;
+    uint_t n;
+
+    n = 0;
+    for (ty = 0; ty < comp->tiles_y; ty++)
+        for (tx = 0; tx < comp->tiles_x; tx++)
+            if (comp->damage[ty * comp->tiles_x + tx])
+            {
+                compositor_tile(comp, tx, ty);
+                comp->damage[ty * comp->tiles_x + tx] = 0;
+                n++;
+            }
+
+    comp->tiles_composited += n;
+    return n;
+}
@@ -0,0 +1,345 @@
+#include "console.h"
+
+
+// * Return the cells of a line of the scrollback.
+// * @param: *con: the console.
+// * @param: i   : index of the line, 0 is the oldest one.
+// * @return: the first cell of the line.
+static CONSOLE_CELL_t* console_line(CONSOLE_t* con, uint_t i)
+{
+    return con->cells + ((con->head + i) % con->max_lines) * con->cols;
+}
+
+
+// * Return the index of the line drawn on the first row of the viewport.
+// * @param: *con: the console.
+// * @return: the index of the line.
+static uint_t console_first(CONSOLE_t* con)
+{
+    return con->nlines > con->rows ? con->nlines - con->rows - con->view : 0;
+}
+
+
+// * Draw cells on a row of the area, a glyph row is written 8 pixels at a
+// * time without going through draw_pixel().
+// * @param: *con : the console.
+// * @param: row  : row of the area.
+// * @param: *line: the cells of the line, NULL for a blank row.
+// * @param: c0   : first cell drawn.
+// * @param: c1   : cell after the last one drawn.
+static void console_draw_cells(CONSOLE_t* con, uint_t row,
+                               const CONSOLE_CELL_t* line, uint_t c0,
+                               uint_t c1)
+{
+    const unsigned char* glyph;
+    COLOR_t*             p;
+    COLOR_t              fg;
+    COLOR_t              bg;
+    uint_t               stride;
+    uint_t               bits;
+    uint_t               c;
+    uint_t               r;
+
+    stride = con->fb->vinfo.xres;
+    glyph = ISO_FONT + ' ' * ISO_CHAR_HEIGHT;
+    fg = palette(CONSOLE_ATTR_FG(CONSOLE_ATTR_DEFAULT));
+    bg = palette(CONSOLE_ATTR_BG(CONSOLE_ATTR_DEFAULT));
+    for (c = c0; c < c1; c++)
+    {
+        if (line)
+        {
+            glyph = ISO_FONT + line[c].ch * ISO_CHAR_HEIGHT;
+            fg = palette(CONSOLE_ATTR_FG(line[c].attr));
+            bg = palette(CONSOLE_ATTR_BG(line[c].attr));
+        }
+
+        p = con->fb->screen + (con->y + row * ISO_CHAR_HEIGHT) * stride
+            + con->x + c * ISO_CHAR_WIDTH;
+        for (r = 0; r < ISO_CHAR_HEIGHT; r++, p += stride)
+        {
+            bits = glyph[r];
+            p[0] = bits & 0x01 ? fg : bg;
+            p[1] = bits & 0x02 ? fg : bg;
+            p[2] = bits & 0x04 ? fg : bg;
+            p[3] = bits & 0x08 ? fg : bg;
+            p[4] = bits & 0x10 ? fg : bg;
+            p[5] = bits & 0x20 ? fg : bg;
+            p[6] = bits & 0x40 ? fg : bg;
+            p[7] = bits & 0x80 ? fg : bg;
+        }
+    }
+
+    return;
+}
+
+
+// * Move the rows of the area one char height up, the last row is left as
+// * it was.
+// * @param: *con: the console.
+static void console_scroll_area(CONSOLE_t* con)
+{
+    COLOR_t* p;
+    uint_t   stride;
+    uint_t   i;
+
+    stride = con->fb->vinfo.xres;
+    p = con->fb->screen + con->y * stride + con->x;
+    for (i = 0; i < (con->rows - 1) * ISO_CHAR_HEIGHT; i++, p += stride)
+        memcpy(p, p + ISO_CHAR_HEIGHT * stride,
+               sizeof(COLOR_t) * con->cols * ISO_CHAR_WIDTH);
+
+    return;
+}
+
+
+// * Initialize a console over an area of the screen, and clear it.
+// * @param: *con     : the structure to initialize.
+// * @param: *fb      : the framebuffer where the console is drawn.
+// * @param: x        : x coordinate of the area.
+// * @param: y        : y coordinate of the area.
+// * @param: w        : width of the area, in pixels.
+// * @param: h        : height of the area, in pixels.
+// * @param: max_lines: lines kept in the scrollback, at least the rows of
+// *                    the area.
+// * @return: 1 in case of an error, 0 otherwise.
+int console_init(CONSOLE_t* con, FRAMEBUFFER_t* fb, uint_t x, uint_t y,
+                 uint_t w, uint_t h, uint_t max_lines)
+{
+    uint_t i;
+
+    memset(con, 0, sizeof(CONSOLE_t));
+    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres)
+        return 1;
+
+    w = w > fb->vinfo.xres - x ? fb->vinfo.xres - x : w;
+    h = h > fb->vinfo.yres - y ? fb->vinfo.yres - y : h;
+    con->fb = fb;
+    con->x = x;
+    con->y = y;
+    con->cols = w / ISO_CHAR_WIDTH;
+    con->rows = h / ISO_CHAR_HEIGHT;
+    con->max_lines = max_lines < con->rows ? con->rows : max_lines;
+    con->attr = CONSOLE_ATTR_DEFAULT;
+    if (!con->cols || !con->rows)
+        return 1;
+
+    con->cells = malloc(sizeof(CONSOLE_CELL_t) * con->max_lines * con->cols);
+    if (!con->cells)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the console scrollback failed."
+               "\x1b[0m\n");
+        return 1;
+    }
+
+    // The line being written.
+    con->nlines = 1;
+    for (i = 0; i < con->cols; i++)
+    {
+        con->cells[i].ch = ' ';
+        con->cells[i].attr = con->attr;
+    }
+
+    draw_rect(fb, x, y, w, h, palette(CONSOLE_ATTR_BG(con->attr)));
+    return 0;
+}
+
+
+// * Free the scrollback of the console.
+// * @param: *con: the console to free.
+void console_free(CONSOLE_t* con)
+{
+    free(con->cells);
+    con->cells = NULL;
+    return;
+}
+
+
+// * Set the attribute of the next chars.
+// * @param: *con: the console.
+// * @param: fg  : palette index of the letters.
+// * @param: bg  : palette index of the background.
+void console_set_attr(CONSOLE_t* con, uint8_t fg, uint8_t bg)
+{
+    con->attr = CONSOLE_ATTR(fg, bg);
+    return;
+}
+
+
+// * Start a new line, the oldest line is reused once the scrollback is full.
+// * A scrolled back viewport stays on the same lines.
+// * @param: *con: the console.
+static void console_newline(CONSOLE_t* con)
+{
+    CONSOLE_CELL_t* line;
+    uint_t          i;
+    int             scroll;
+
+    // The area scrolls when the tail was on the last row, which is also the
+    // case once the scrollback is full, even when it is only rows lines.
+    scroll = con->nlines >= con->rows;
+    if (con->nlines < con->max_lines)
+        con->nlines++;
+
+    else
+    {
+        con->head = con->head + 1 < con->max_lines ? con->head + 1 : 0;
+        con->lines_dropped++;
+    }
+
+    con->col = 0;
+    line = console_line(con, con->nlines - 1);
+    for (i = 0; i < con->cols; i++)
+    {
+        line[i].ch = ' ';
+        line[i].attr = con->attr;
+    }
+
+    if (con->view)
+    {
+        // The top line was dropped from the scrollback: the viewport moves.
+        if (con->view < con->nlines - con->rows)
+            con->view++;
+
+        else
+            console_redraw(con);
+
+        return;
+    }
+
+    if (scroll)
+        console_scroll_area(con);
+
+    console_draw_cells(con, con->nlines - 1 - console_first(con), line, 0,
+                       con->cols);
+    return;
+}
+
+
+// * Write a char, '\n', '\r' and '\t' are handled and a line wraps at the
+// * right edge. The char is drawn only when the viewport follows the tail.
+// * @param: *con: the console.
+// * @param: c   : the char.
+void console_putc(CONSOLE_t* con, char c)
+{
+    CONSOLE_CELL_t* line;
+    uint_t          end;
+
+    if (c == '\n')
+    {
+        console_newline(con);
+        return;
+    }
+
+    if (c == '\r')
+    {
+        con->col = 0;
+        return;
+    }
+
+    if (con->col >= con->cols)
+        console_newline(con);
+
+    end = con->col + 1;
+    if (c == '\t')
+        end = (con->col / CONSOLE_TAB + 1) * CONSOLE_TAB;
+
+    end = end > con->cols ? con->cols : end;
+    line = console_line(con, con->nlines - 1);
+    for (; con->col < end; con->col++)
+    {
+        line[con->col].ch = c == '\t' ? ' ' : (uint8_t)c;
+        line[con->col].attr = con->attr;
+        if (!con->view)
+            console_draw_cells(con, con->nlines - 1 - console_first(con), line,
+                               con->col, con->col + 1);
+    }
+
+    return;
+}
+
+
+// * Write n chars of a buffer.
+// * @param: *con: the console.
+// * @param: *buf: the chars.
+// * @param: n   : number of chars.
+void console_write(CONSOLE_t* con, const char* buf, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        console_putc(con, buf[i]);
+
+    return;
+}
+
+
+// * Write a string.
+// * @param: *con: the console.
+// * @param: *str: the string.
+void console_puts(CONSOLE_t* con, const char* str)
+{
+    while (*str)
+        console_putc(con, *str++);
+
+    return;
+}
+
+
+// * Move the viewport in the scrollback and redraw it if it moved.
+// * @param: *con: the console.
+// * @param: n   : lines to scroll back, negative to go toward the tail.
+void console_scroll(CONSOLE_t* con, int n)
+{
+    uint_t max;
+    uint_t view;
+
+    max = con->nlines > con->rows ? con->nlines - con->rows : 0;
+    if (n < 0)
+        view = (uint_t)-n > con->view ? 0 : con->view - (uint_t)-n;
+
+    else
+        view = (uint_t)n > max - con->view ? max : con->view + (uint_t)n;
+
+    if (view == con->view)
+        return;
+
+    con->view = view;
+    console_redraw(con);
+    return;
+}
+
+
+// * Scroll the viewport one page back.
+// * @param: *con: the console.
+void console_page_up(CONSOLE_t* con)
+{
+    console_scroll(con, (int)con->rows);
+    return;
+}
+
+
+// * Scroll the viewport one page toward the tail.
+// * @param: *con: the console.
+void console_page_down(CONSOLE_t* con)
+{
+    console_scroll(con, -(int)con->rows);
+    return;
+}
+
+
+// * Draw the whole viewport from the scrollback, after the area has been
+// * overwritten.
+// * @param: *con: the console.
+void console_redraw(CONSOLE_t* con)
+{
+    uint_t first;
+    uint_t i;
+
+    first = console_first(con);
+    for (i = 0; i < con->rows; i++)
+        console_draw_cells(con, i, first + i < con->nlines
+                                   ? console_line(con, first + i) : NULL,
+                           0, con->cols);
+
+    return;
+}
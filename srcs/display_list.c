@@ -0,0 +1,316 @@
+#include "display_list.h"
+#include "fb_trace.h"
+
+
+// * Return the number of pixels covered by a command.
+// * @param: *cmd: the command.
+// * @return: the area of the bounding box of the command.
+static unsigned long dl_area(DL_CMD_t* cmd)
+{
+    return (unsigned long)(cmd->x1 - cmd->x0) * (cmd->y1 - cmd->y0);
+}
+
+
+// * Check if the bounding boxes of two commands intersect.
+// * @param: *a: the first command.
+// * @param: *b: the second command.
+// * @return: 1 if they overlap, 0 otherwise.
+static int dl_overlap(DL_CMD_t* a, DL_CMD_t* b)
+{
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+
+// * Check if the bounding box of a command is inside another one.
+// * @param: *outer: the command that may cover the other one.
+// * @param: *inner: the command that may be covered.
+// * @return: 1 if inner is fully covered, 0 otherwise.
+static int dl_contains(DL_CMD_t* outer, DL_CMD_t* inner)
+{
+    return outer->x0 <= inner->x0 && outer->x1 >= inner->x1
+        && outer->y0 <= inner->y0 && outer->y1 >= inner->y1;
+}
+
+
+// * Clip a command against the screen and add it to the list.
+// * @param: *dl : the display list where the command is recorded.
+// * @param: *cmd: the command, its bounding box may exceed the screen.
+// * @return: 1 if the list is full, 0 otherwise.
+static int dl_push(DISPLAY_LIST_t* dl, DL_CMD_t* cmd)
+{
+    if (cmd->x1 > dl->fb->vinfo.xres)
+        cmd->x1 = dl->fb->vinfo.xres;
+
+    if (cmd->y1 > dl->fb->vinfo.yres)
+        cmd->y1 = dl->fb->vinfo.yres;
+
+    if (cmd->x0 >= cmd->x1 || cmd->y0 >= cmd->y1)
+        return 0;
+
+    if (dl->ncmds >= dl->max_cmds)
+        return 1;
+
+    cmd->live = 1;
+    dl->cmds[dl->ncmds] = *cmd;
+    dl->ncmds++;
+    return 0;
+}
+
+
+// * Drop every command whose bounding box is fully covered by a later fill.
+// * @param: *dl: the display list to cull.
+static void dl_cull(DISPLAY_LIST_t* dl)
+{
+    uint_t i;
+    uint_t j;
+
+    for (i = 0; i < dl->ncmds; i++)
+    {
+        for (j = i + 1; j < dl->ncmds; j++)
+        {
+            if (dl->cmds[j].type == DL_CMD_FILL
+                && dl_contains(&dl->cmds[j], &dl->cmds[i]))
+            {
+                dl->cmds[i].live = 0;
+                dl->pixels_saved += dl_area(&dl->cmds[i]);
+                dl->cmds_culled++;
+                break;
+            }
+        }
+    }
+
+    return;
+}
+
+
+// * Merge two consecutive fills of the same color when their union is a
+// * rectangle, or drop the second one when the first one already covers it.
+// * @param: *dl: the display list.
+// * @param: *a : the earlier fill, it receives the union.
+// * @param: *b : the following fill.
+// * @return: 1 if b has been merged into a, 0 otherwise.
+static int dl_merge_pair(DISPLAY_LIST_t* dl, DL_CMD_t* a, DL_CMD_t* b)
+{
+    if (a->type != DL_CMD_FILL || b->type != DL_CMD_FILL
+        || a->fgcolor != b->fgcolor)
+        return 0;
+
+    if (dl_contains(a, b))
+    {
+        dl->pixels_saved += dl_area(b);
+        return 1;
+    }
+
+    // Side by side on the same rows.
+    if (a->y0 == b->y0 && a->y1 == b->y1
+        && (a->x1 == b->x0 || b->x1 == a->x0))
+    {
+        a->x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+        a->x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+        return 1;
+    }
+
+    // Stacked on the same columns.
+    if (a->x0 == b->x0 && a->x1 == b->x1
+        && (a->y1 == b->y0 || b->y1 == a->y0))
+    {
+        a->y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+        a->y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// * Remove dead commands and merge consecutive fills.
+// * @param: *dl: the display list to compact.
+static void dl_compact(DISPLAY_LIST_t* dl)
+{
+    uint_t i;
+    uint_t n;
+
+    n = 0;
+    for (i = 0; i < dl->ncmds; i++)
+    {
+        if (!dl->cmds[i].live)
+            continue;
+
+        if (n && dl_merge_pair(dl, &dl->cmds[n - 1], &dl->cmds[i]))
+        {
+            dl->cmds_merged++;
+            continue;
+        }
+
+        dl->cmds[n] = dl->cmds[i];
+        n++;
+    }
+
+    dl->ncmds = n;
+    return;
+}
+
+
+// * Stable sort of the commands by first scanline. A command only moves before
+// * the ones it does not overlap, so the painter order is kept where it
+// * matters.
+// * @param: *dl: the display list to sort.
+static void dl_sort(DISPLAY_LIST_t* dl)
+{
+    DL_CMD_t cmd;
+    uint_t   i;
+    uint_t   j;
+
+    for (i = 1; i < dl->ncmds; i++)
+    {
+        cmd = dl->cmds[i];
+        j = i;
+        while (j > 0 && dl->cmds[j - 1].y0 > cmd.y0
+               && !dl_overlap(&dl->cmds[j - 1], &cmd))
+        {
+            dl->cmds[j] = dl->cmds[j - 1];
+            j--;
+        }
+
+        dl->cmds[j] = cmd;
+    }
+
+    return;
+}
+
+
+// * Initialize an empty display list.
+// * @param: *dl      : the structure to initialize.
+// * @param: *fb      : the framebuffer where the list will be rasterized.
+// * @param: max_cmds : maximum number of commands recorded between submits.
+// * @return: 1 in case of an error, 0 otherwise.
+int dl_init(DISPLAY_LIST_t* dl, FRAMEBUFFER_t* fb, uint_t max_cmds)
+{
+    memset(dl, 0, sizeof(DISPLAY_LIST_t));
+    dl->fb = fb;
+    dl->max_cmds = max_cmds;
+
+    dl->cmds = malloc(sizeof(DL_CMD_t) * max_cmds);
+    if (!dl->cmds)
+        return 1;
+
+    return 0;
+}
+
+
+// * Free the memory used by the display list.
+// * @param: *dl: the display list to free.
+void dl_free(DISPLAY_LIST_t* dl)
+{
+    if (dl->cmds)
+    {
+        free(dl->cmds);
+        dl->cmds = NULL;
+    }
+
+    dl->ncmds = 0;
+    return;
+}
+
+
+// * Record a fill of the entire screen.
+// * @param: *dl  : the display list where the command is recorded.
+// * @param: color: color of the screen.
+// * @return: 1 if the list is full, 0 otherwise.
+int dl_fill_screen(DISPLAY_LIST_t* dl, COLOR_t color)
+{
+    return dl_draw_rect(dl, 0, 0, dl->fb->vinfo.xres, dl->fb->vinfo.yres,
+                        color);
+}
+
+
+// * Record a filled rectangle.
+// * @param: *dl  : the display list where the command is recorded.
+// * @param: x    : start x coordinate.
+// * @param: y    : start y coordinate.
+// * @param: w    : width of the rectangle.
+// * @param: h    : height of the rectangle.
+// * @param: color: color of the rectangle.
+// * @return: 1 if the list is full, 0 otherwise.
+int dl_draw_rect(DISPLAY_LIST_t* dl, uint_t x, uint_t y,
+                 uint_t w, uint_t h, COLOR_t color)
+{
+    DL_CMD_t cmd;
+
+    cmd.type = DL_CMD_FILL;
+    cmd.fgcolor = color;
+    cmd.bgcolor = color;
+    cmd.x0 = x;
+    cmd.y0 = y;
+    cmd.x1 = x + w;
+    cmd.y1 = y + h;
+    cmd.str = NULL;
+
+    return dl_push(dl, &cmd);
+}
+
+
+// * Record a string drawn on a single line, the string must stay valid until
+// * the list is submitted.
+// * @param: *dl    : the display list where the command is recorded.
+// * @param: *str   : the string to draw.
+// * @param: x      : x position of the first char.
+// * @param: y      : y position of the first char.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the chars.
+// * @return: 1 if the list is full, 0 otherwise.
+int dl_print_str(DISPLAY_LIST_t* dl, const char* str, uint_t x, uint_t y,
+                 COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    DL_CMD_t cmd;
+
+    if (!str)
+        return 0;
+
+    cmd.type = DL_CMD_TEXT;
+    cmd.fgcolor = fgcolor;
+    cmd.bgcolor = bgcolor;
+    cmd.x0 = x;
+    cmd.y0 = y;
+    cmd.x1 = x + strlen(str) * ISO_CHAR_WIDTH;
+    cmd.y1 = y + ISO_CHAR_HEIGHT;
+    cmd.str = str;
+
+    return dl_push(dl, &cmd);
+}
+
+
+// * Optimize and rasterize the recorded commands, then empty the list.
+// * Commands fully covered by a later rectangle are culled, consecutive fills
+// * of the same color are merged and the list is sorted by scanline without
+// * reordering overlapping commands.
+// * @param: *dl: the display list to submit.
+void dl_submit(DISPLAY_LIST_t* dl)
+{
+    DL_CMD_t* cmd;
+    uint_t    i;
+    TRACE_BEGIN();
+
+    dl_cull(dl);
+    dl_compact(dl);
+    dl_sort(dl);
+
+    for (i = 0; i < dl->ncmds; i++)
+    {
+        cmd = &dl->cmds[i];
+        if (cmd->type == DL_CMD_FILL)
+            fill_area(dl->fb, cmd->x0, cmd->y0, cmd->x1, cmd->y1,
+                      cmd->fgcolor);
+
+        else
+            print_str_area(dl->fb, cmd->str, cmd->x0, cmd->y0, cmd->x0,
+                           cmd->y0, cmd->x1, cmd->y1, cmd->fgcolor,
+                           cmd->bgcolor);
+
+        dl->pixels_drawn += dl_area(&dl->cmds[i]);
+    }
+
+    dl->ncmds = 0;
+    TRACE_END(TRACE_FLUSH);
+    return;
+}
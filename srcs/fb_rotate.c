@@ -0,0 +1,219 @@
+#include "fb_rotate.h"
+
+
+// * Rotate a block of the logical view by 90 degrees clockwise, the logical
+// * pixel x;y goes to the panel pixel (PW - 1 - y);x.
+// * @param: *rot: the rotation.
+// * @param: x0  : first logical column of the block.
+// * @param: y0  : first logical row of the block.
+// * @param: x1  : end logical column of the block.
+// * @param: y1  : end logical row of the block.
+static void rotate_block_90(ROTATION_t* rot, uint_t x0, uint_t y0,
+                            uint_t x1, uint_t y1)
+{
+    const COLOR_t* src;
+    COLOR_t*       dst;
+    uint_t         lw;
+    uint_t         pw;
+    uint_t         x;
+    uint_t         y;
+
+    lw = rot->view.vinfo.xres;
+    pw = rot->fb->vinfo.xres;
+
+    // Write the panel rows in order, the reads walk a column of the block
+    // that stays in cache.
+    for (x = x0; x < x1; x++)
+    {
+        src = rot->shadow + (y1 - 1) * lw + x;
+        dst = rot->fb->screen + x * pw + (pw - y1);
+        for (y = y0; y < y1; y++)
+        {
+            *dst++ = *src;
+            src -= lw;
+        }
+    }
+
+    return;
+}
+
+
+// * Rotate a block of the logical view by 270 degrees clockwise, the logical
+// * pixel x;y goes to the panel pixel y;(PH - 1 - x).
+// * @param: *rot: the rotation.
+// * @param: x0  : first logical column of the block.
+// * @param: y0  : first logical row of the block.
+// * @param: x1  : end logical column of the block.
+// * @param: y1  : end logical row of the block.
+static void rotate_block_270(ROTATION_t* rot, uint_t x0, uint_t y0,
+                             uint_t x1, uint_t y1)
+{
+    const COLOR_t* src;
+    COLOR_t*       dst;
+    uint_t         lw;
+    uint_t         pw;
+    uint_t         ph;
+    uint_t         x;
+    uint_t         y;
+
+    lw = rot->view.vinfo.xres;
+    pw = rot->fb->vinfo.xres;
+    ph = rot->fb->vinfo.yres;
+
+    for (x = x0; x < x1; x++)
+    {
+        src = rot->shadow + y0 * lw + x;
+        dst = rot->fb->screen + (ph - 1 - x) * pw + y0;
+        for (y = y0; y < y1; y++)
+        {
+            *dst++ = *src;
+            src += lw;
+        }
+    }
+
+    return;
+}
+
+
+// * Set up a logical orientation of the screen. The logical picture is
+// * turned clockwise by degrees when it is flushed to the panel.
+// * @param: *rot   : the structure to initialize.
+// * @param: *fb    : the physical framebuffer.
+// * @param: degrees: 0, 90, 180, 270 or ROTATION_FROM_VINFO.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_rotation_init(ROTATION_t* rot, FRAMEBUFFER_t* fb, int degrees)
+{
+    memset(rot, 0, sizeof(ROTATION_t));
+    if (degrees == ROTATION_FROM_VINFO)
+        degrees = (fb->vinfo.rotate & 3) * 90;
+
+    if (degrees != 0 && degrees != 90 && degrees != 180 && degrees != 270)
+    {
+        printf("\x1b[1;31m~[ERROR] Rotation of %d degrees not supported."
+               "\x1b[0m\n", degrees);
+        return 1;
+    }
+
+    rot->fb = fb;
+    rot->degrees = degrees;
+    rot->view = *fb;
+    rot->view.fd = -1;
+
+    // Without rotation the primitives keep drawing on the screen directly.
+    if (!degrees)
+        return 0;
+
+    rot->shadow = calloc(fb->vinfo.xres * fb->vinfo.yres, sizeof(COLOR_t));
+    if (!rot->shadow)
+    {
+        printf("\x1b[1;31m~[ERROR] Shadow buffer allocation failed."
+               "\x1b[0m\n");
+        return 1;
+    }
+
+    rot->view.screen = rot->shadow;
+    if (degrees == 90 || degrees == 270)
+    {
+        rot->view.vinfo.xres = fb->vinfo.yres;
+        rot->view.vinfo.yres = fb->vinfo.xres;
+        rot->view.vinfo.xres_virtual = fb->vinfo.yres;
+        rot->view.vinfo.yres_virtual = fb->vinfo.xres;
+        rot->view.vinfo.width = fb->vinfo.height;
+        rot->view.vinfo.height = fb->vinfo.width;
+    }
+
+    rot->view.vinfo.rotate = FB_ROTATE_UR;
+    rot->view.vinfo.xoffset = 0;
+    rot->view.vinfo.yoffset = 0;
+    return 0;
+}
+
+
+// * Free the shadow buffer of the rotation.
+// * @param: *rot: the rotation to free.
+void fb_rotation_free(ROTATION_t* rot)
+{
+    free(rot->shadow);
+    rot->shadow = NULL;
+    rot->view.screen = NULL;
+    return;
+}
+
+
+// * Copy the whole logical view onto the panel.
+// * @param: *rot: the rotation to flush.
+void fb_rotation_flush(ROTATION_t* rot)
+{
+    fb_rotation_flush_rect(rot, 0, 0, rot->view.vinfo.xres,
+                           rot->view.vinfo.yres);
+    return;
+}
+
+
+// * Copy an area of the logical view onto the panel, the area is rotated
+// * ROTATION_BLOCK x ROTATION_BLOCK pixels at a time.
+// * @param: *rot: the rotation to flush.
+// * @param: x   : logical x coordinate of the top-left corner of the area.
+// * @param: y   : logical y coordinate of the top-left corner of the area.
+// * @param: w   : width of the area.
+// * @param: h   : height of the area.
+void fb_rotation_flush_rect(ROTATION_t* rot, uint_t x, uint_t y,
+                            uint_t w, uint_t h)
+{
+    const COLOR_t* src;
+    COLOR_t*       dst;
+    uint_t         pw;
+    uint_t         ph;
+    uint_t         bx;
+    uint_t         by;
+    uint_t         ex;
+    uint_t         ey;
+    uint_t         i;
+    uint_t         j;
+    TRACE_BEGIN();
+
+    if (!rot->degrees || x >= rot->view.vinfo.xres
+        || y >= rot->view.vinfo.yres)
+        return;
+
+    if (w > rot->view.vinfo.xres - x)
+        w = rot->view.vinfo.xres - x;
+
+    if (h > rot->view.vinfo.yres - y)
+        h = rot->view.vinfo.yres - y;
+
+    pw = rot->fb->vinfo.xres;
+    ph = rot->fb->vinfo.yres;
+
+    // Upside down keeps the rows, they are only reversed.
+    if (rot->degrees == 180)
+    {
+        for (i = y; i < y + h; i++)
+        {
+            src = rot->shadow + i * rot->view.vinfo.xres + x;
+            dst = rot->fb->screen + (ph - 1 - i) * pw + (pw - x - w);
+            for (j = 0; j < w; j++)
+                dst[w - 1 - j] = src[j];
+        }
+
+        TRACE_END(TRACE_PRESENT);
+        return;
+    }
+
+    for (by = y; by < y + h; by += ROTATION_BLOCK)
+    {
+        ey = by + ROTATION_BLOCK < y + h ? by + ROTATION_BLOCK : y + h;
+        for (bx = x; bx < x + w; bx += ROTATION_BLOCK)
+        {
+            ex = bx + ROTATION_BLOCK < x + w ? bx + ROTATION_BLOCK : x + w;
+            if (rot->degrees == 90)
+                rotate_block_90(rot, bx, by, ex, ey);
+
+            else
+                rotate_block_270(rot, bx, by, ex, ey);
+        }
+    }
+
+    TRACE_END(TRACE_PRESENT);
+    return;
+}
@@ -0,0 +1,221 @@
+#include "fb_stats.h"
+#include "fb_trace.h"
+
+
+const char* FB_STAT_NAMES[STAT_COUNT_MAX] = {
+    "fill_screen", "draw_pixel", "get_pixel_color", "print_char_coord",
+    "print_str_coord", "scroll_screen", "copy_rect", "write_rect",
+    "write_rect_alpha", "draw_h_line", "draw_v_line", "draw_line",
+    "draw_rect", "write_rect_keyed", "strip_chart_push"
+};
+
+
+#if defined(FB_STATS) || defined(FB_TRACE)
+static int stats_enabled;
+static int stats_depth;
+
+
+// * Return the monotonic clock in ns.
+// * @return: the current time.
+static uint64_t stats_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+// * Check if the probes have something to feed.
+// * @return: 1 if the counters or the trace recorder are running.
+static int stats_active(void)
+{
+    return stats_enabled || fb_trace_enabled();
+}
+#endif
+
+
+#ifdef FB_STATS
+
+static FB_STAT_t             stats[STAT_COUNT_MAX];
+static volatile sig_atomic_t stats_dump_requested;
+
+
+// * SIGUSR1 handler, printing is not signal safe so the dump is done by the
+// * next primitive that finishes.
+// * @param: sig: the signal number.
+static void stats_signal(int sig)
+{
+    (void)sig;
+    stats_dump_requested = 1;
+}
+
+
+// * Add a measure to the counters of a primitive.
+// * @param: id: index of the primitive.
+// * @param: px: number of pixels written.
+// * @param: rd: number of bytes read back from the framebuffer.
+// * @param: ns: time spent in the primitive.
+static void stats_add(int id, unsigned long px, unsigned long rd, uint64_t ns)
+{
+    stats[id].calls++;
+    stats[id].pixels += px;
+    stats[id].bytes_read += rd;
+    stats[id].ns += ns;
+
+    if (stats_dump_requested)
+    {
+        stats_dump_requested = 0;
+        fb_stats_dump(stderr);
+    }
+
+    return;
+}
+
+#endif
+
+
+// * Enable the counters if FBTOOLS_STATS is set and dump them on SIGUSR1.
+void fb_stats_init(void)
+{
+#ifdef FB_STATS
+    const char* env;
+
+    env = getenv(FB_STATS_ENV);
+    if (env && strcmp(env, "0"))
+        fb_stats_enable(1);
+
+    signal(SIGUSR1, stats_signal);
+#endif
+
+    return;
+}
+
+
+// * Enable or disable the counters at runtime.
+// * @param: enable: 1 to enable the counters, 0 to disable them.
+void fb_stats_enable(int enable)
+{
+#if defined(FB_STATS) || defined(FB_TRACE)
+    stats_enabled = enable;
+    stats_depth = 0;
+#else
+    (void)enable;
+#endif
+
+    return;
+}
+
+
+// * Clear every counter.
+void fb_stats_reset(void)
+{
+#ifdef FB_STATS
+    memset(stats, 0, sizeof(stats));
+#endif
+
+    return;
+}
+
+
+// * Print the counters of each primitive.
+// * @param: *out: the stream where the counters are printed.
+void fb_stats_dump(FILE* out)
+{
+#ifdef FB_STATS
+    int i;
+
+    fprintf(out, "~GRAPHICS STATS: \n");
+    fprintf(out, "\t%-18s %10s %12s %12s %12s\n",
+            "primitive", "calls", "pixels", "bytes read", "time (us)");
+
+    for (i = 0; i < STAT_COUNT_MAX; i++)
+    {
+        if (!stats[i].calls)
+            continue;
+
+        fprintf(out, "\t%-18s %10lu %12lu %12lu %12lu\n", FB_STAT_NAMES[i],
+                stats[i].calls, stats[i].pixels, stats[i].bytes_read,
+                (unsigned long)(stats[i].ns / 1000));
+    }
+#else
+    fprintf(out, "~GRAPHICS STATS: disabled at build time (FB_STATS).\n");
+#endif
+
+    return;
+}
+
+
+// * Start measuring a primitive.
+// * @return: the start time in ns, 0 when nested or disabled.
+uint64_t fb_stats_begin(void)
+{
+#if defined(FB_STATS) || defined(FB_TRACE)
+    if (!stats_active())
+        return 0;
+
+    stats_depth++;
+    if (stats_depth == 1)
+        return stats_now();
+#endif
+
+    return 0;
+}
+
+
+// * Stop measuring a primitive and add it to the counters.
+// * @param: id   : index of the primitive.
+// * @param: px   : number of pixels written.
+// * @param: rd   : number of bytes read back from the framebuffer.
+// * @param: t0   : value returned by fb_stats_begin.
+void fb_stats_end(int id, unsigned long px, unsigned long rd, uint64_t t0)
+{
+#if defined(FB_STATS) || defined(FB_TRACE)
+    uint64_t t1;
+
+    if (!stats_active() || !stats_depth)
+        return;
+
+    stats_depth--;
+    if (stats_depth)
+        return;
+
+    t1 = stats_now();
+
+#ifdef FB_STATS
+    if (stats_enabled)
+        stats_add(id, px, rd, t1 - t0);
+#else
+    (void)px;
+    (void)rd;
+#endif
+
+    fb_trace_span(id, t0, t1);
+#else
+    (void)id;
+    (void)px;
+    (void)rd;
+    (void)t0;
+#endif
+
+    return;
+}
+
+
+// * Count a primitive too small to be timed.
+// * @param: id   : index of the primitive.
+// * @param: px   : number of pixels written.
+// * @param: rd   : number of bytes read back from the framebuffer.
+void fb_stats_count(int id, unsigned long px, unsigned long rd)
+{
+#ifdef FB_STATS
+    if (stats_enabled && !stats_depth)
+        stats_add(id, px, rd, 0);
+#else
+    (void)id;
+    (void)px;
+    (void)rd;
+#endif
+
+    return;
+}
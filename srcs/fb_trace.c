@@ -0,0 +1,302 @@
+#include "fb_trace.h"
+
+
+#ifdef FB_TRACE
+
+static const char* TRACE_NAMES[TRACE_ID_MAX - STAT_COUNT_MAX] = {
+    "init_framebuffer", "frame", "flush", "present"
+};
+
+static TRACE_REC_t*  ring;
+static unsigned int  ring_size;
+static unsigned int  ring_head;
+static unsigned int  ring_count;
+static int           marker_fd = -1;
+
+
+// * Return the name of a span.
+// * @param: id: the span id.
+// * @return: the name of the span.
+static const char* trace_name(int id)
+{
+    if (id < STAT_COUNT_MAX)
+        return FB_STAT_NAMES[id];
+
+    if (id < TRACE_ID_MAX)
+        return TRACE_NAMES[id - STAT_COUNT_MAX];
+
+    return "unknown";
+}
+
+
+// * Store a record in the ring, overwriting the oldest one if full.
+// * @param: id   : the span id.
+// * @param: phase: TRACE_PH_SPAN or TRACE_PH_INSTANT.
+// * @param: ts   : start time in ns.
+// * @param: dur  : duration in ns.
+static void trace_push(int id, uint8_t phase, uint64_t ts, uint64_t dur)
+{
+    TRACE_REC_t* rec;
+    char         line[64];
+    int          len;
+
+    rec = &ring[ring_head];
+    rec->ts = ts;
+    rec->dur = dur;
+    rec->id = id;
+    rec->phase = phase;
+
+    ring_head++;
+    if (ring_head == ring_size)
+        ring_head = 0;
+
+    if (ring_count < ring_size)
+        ring_count++;
+
+    // Mirror to ftrace, the marker is written once the span is over.
+    if (marker_fd >= 0)
+    {
+        len = snprintf(line, sizeof(line), "fbtools: %s %lluus\n",
+                       trace_name(id), (unsigned long long)(dur / 1000));
+        if (write(marker_fd, line, len) < 0)
+        {
+            close(marker_fd);
+            marker_fd = -1;
+        }
+    }
+
+    return;
+}
+
+#endif
+
+
+// * Start tracing if FBTOOLS_TRACE is set, and mirror the spans to ftrace
+// * if FBTOOLS_TRACE_MARKER is set too.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_trace_init(void)
+{
+#ifdef FB_TRACE
+    if (!getenv(FB_TRACE_ENV))
+        return 0;
+
+    if (fb_trace_start(FB_TRACE_DEFAULT_N))
+        return 1;
+
+    if (getenv(FB_TRACE_MARKER_ENV))
+        return fb_trace_marker(1);
+#endif
+
+    return 0;
+}
+
+
+// * Allocate the ring and start recording, the oldest records are overwritten
+// * once the ring is full.
+// * @param: capacity: number of records kept.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_trace_start(unsigned int capacity)
+{
+#ifdef FB_TRACE
+    fb_trace_stop();
+
+    ring = malloc(sizeof(TRACE_REC_t) * capacity);
+    if (!ring || !capacity)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating trace ring failed.\x1b[0m\n");
+        fb_trace_stop();
+        return 1;
+    }
+
+    ring_size = capacity;
+    ring_head = 0;
+    ring_count = 0;
+#else
+    (void)capacity;
+#endif
+
+    return 0;
+}
+
+
+// * Mirror the recorded spans to trace_marker, or stop mirroring them. Each
+// * span costs a write to the kernel.
+// * @param: enable: 1 to mirror, 0 to stop.
+// * @return: 1 if trace_marker can not be opened, 0 otherwise.
+int fb_trace_marker(int enable)
+{
+#ifdef FB_TRACE
+    if (marker_fd >= 0)
+    {
+        close(marker_fd);
+        marker_fd = -1;
+    }
+
+    if (!enable)
+        return 0;
+
+    marker_fd = open(FB_TRACE_MARKER, O_WRONLY);
+    if (marker_fd < 0)
+        marker_fd = open(FB_TRACE_MARKER_OLD, O_WRONLY);
+
+    if (marker_fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening trace_marker failed.\x1b[0m\n");
+        return 1;
+    }
+#else
+    (void)enable;
+#endif
+
+    return 0;
+}
+
+
+// * Stop recording, free the ring and stop mirroring to ftrace.
+void fb_trace_stop(void)
+{
+#ifdef FB_TRACE
+    if (ring)
+    {
+        free(ring);
+        ring = NULL;
+    }
+
+    fb_trace_marker(0);
+    ring_size = 0;
+    ring_count = 0;
+#endif
+
+    return;
+}
+
+
+// * Check if the recorder is running.
+// * @return: 1 if recording, 0 otherwise.
+int fb_trace_enabled(void)
+{
+#ifdef FB_TRACE
+    return ring != NULL;
+#else
+    return 0;
+#endif
+}
+
+
+// * Return the monotonic clock in ns, or 0 when not recording.
+// * @return: the current time.
+uint64_t fb_trace_now(void)
+{
+#ifdef FB_TRACE
+    struct timespec ts;
+
+    if (!ring)
+        return 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+
+// * Record a span.
+// * @param: id: the span id (STAT_* or TRACE_*).
+// * @param: t0: start time in ns.
+// * @param: t1: end time in ns.
+void fb_trace_span(int id, uint64_t t0, uint64_t t1)
+{
+#ifdef FB_TRACE
+    if (ring && t0)
+        trace_push(id, TRACE_PH_SPAN, t0, t1 - t0);
+#else
+    (void)id;
+    (void)t0;
+    (void)t1;
+#endif
+
+    return;
+}
+
+
+// * Record an instant event.
+// * @param: id: the event id (STAT_* or TRACE_*).
+void fb_trace_instant(int id)
+{
+#ifdef FB_TRACE
+    if (ring)
+        trace_push(id, TRACE_PH_INSTANT, fb_trace_now(), 0);
+#else
+    (void)id;
+#endif
+
+    return;
+}
+
+
+// * Write the records in the Chrome trace event JSON format.
+// * @param: *path: path of the output file.
+// * @return: 1 in case of an error, 0 otherwise.
+int fb_trace_export(const char* path)
+{
+#ifdef FB_TRACE
+    TRACE_REC_t* rec;
+    FILE*        file;
+    unsigned int i;
+    int          pid;
+
+    if (!ring)
+        return 1;
+
+    file = fopen(path, "w");
+    if (!file)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening %s failed.\x1b[0m\n", path);
+        return 1;
+    }
+
+    // Timestamps are in us, print the ns as decimals without using floats.
+    pid = getpid();
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (i = 0; i < ring_count; i++)
+    {
+        rec = &ring[(ring_head + ring_size - ring_count + i) % ring_size];
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":0,"
+                "\"ts\":%llu.%03u", i ? ",\n" : "", trace_name(rec->id),
+                rec->phase, pid, (unsigned long long)(rec->ts / 1000),
+                (unsigned int)(rec->ts % 1000));
+
+        if (rec->phase == TRACE_PH_SPAN)
+            fprintf(file, ",\"dur\":%llu.%03u}",
+                    (unsigned long long)(rec->dur / 1000),
+                    (unsigned int)(rec->dur % 1000));
+        else
+            fprintf(file, ",\"s\":\"p\"}");
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+    return 0;
+#else
+    (void)path;
+    return 1;
+#endif
+}
+
+
+// * Export to the path given by FBTOOLS_TRACE, then stop recording.
+void fb_trace_finish(void)
+{
+#ifdef FB_TRACE
+    const char* path;
+
+    path = getenv(FB_TRACE_ENV);
+    if (path && ring)
+        fb_trace_export(path);
+
+    fb_trace_stop();
+#endif
+
+    return;
+}
@@ -0,0 +1,180 @@
+#include "flood_fill.h"
+
+
+// * Initialize the span stack of the flood fill.
+// * @param: *ff     : the structure to initialize.
+// * @param: capacity: number of spans of the stack, 0 for
+// *                   FLOOD_DEFAULT_SPANS.
+// * @return: 1 in case of an error, 0 otherwise.
+int flood_fill_init(FLOOD_FILL_t* ff, uint_t capacity)
+{
+    memset(ff, 0, sizeof(FLOOD_FILL_t));
+    ff->capacity = capacity ? capacity : FLOOD_DEFAULT_SPANS;
+    ff->spans = malloc(sizeof(FLOOD_SPAN_t) * ff->capacity);
+    if (!ff->spans)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the flood fill stack failed."
+               "\x1b[0m\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// * Free the span stack of the flood fill.
+// * @param: *ff: the flood fill to free.
+void flood_fill_free(FLOOD_FILL_t* ff)
+{
+    free(ff->spans);
+    ff->spans = NULL;
+    ff->capacity = 0;
+    return;
+}
+
+
+// * Push a span on the stack, a span out of the screen is ignored.
+// * @param: *ff: the flood fill.
+// * @param: h  : height of the screen.
+// * @param: y  : row to scan.
+// * @param: xl : first x coordinate of the span.
+// * @param: xr : last x coordinate of the span.
+// * @param: dy : direction of the scan, 1 or -1.
+// * @return: 1 if the stack is full, 0 otherwise.
+static int flood_push(FLOOD_FILL_t* ff, uint_t h, int y, uint_t xl, uint_t xr,
+                      int dy)
+{
+    FLOOD_SPAN_t* span;
+
+    if (y < 0 || (uint_t)y >= h)
+        return 0;
+
+    if (ff->used >= ff->capacity)
+        return 1;
+
+    span = &ff->spans[ff->used++];
+    span->y = y;
+    span->xl = xl;
+    span->xr = xr;
+    span->dy = dy;
+    if (ff->used > ff->max_used)
+        ff->max_used = ff->used;
+
+    return 0;
+}
+
+
+// * Fill a run of a row, in the shadow copy and on the screen.
+// * @param: *src  : the row read by the fill.
+// * @param: *dst  : the row of the screen, NULL when it is src.
+// * @param: l     : first x coordinate of the run.
+// * @param: r     : last x coordinate of the run.
+// * @param: color : the fill color.
+static void flood_run(COLOR_t* src, COLOR_t* dst, uint_t l, uint_t r,
+                      COLOR_t color)
+{
+    uint_t x;
+
+    for (x = l; x <= r; x++)
+        src[x] = color;
+
+    if (dst)
+        memcpy(dst + l, src + l, sizeof(COLOR_t) * (r - l + 1));
+
+    return;
+}
+
+
+// * Fill the area of same color pixels (4-connected) around a point. Rows are
+// * scanned and filled a span at a time. When a shadow copy of the screen is
+// * given, the pixels are read from it and written to both, so the
+// * framebuffer is never read.
+// * @param: *ff    : the flood fill.
+// * @param: *fb    : FRAMEBUFFER_t where the area is filled.
+// * @param: *shadow: copy of the screen with the same stride, NULL to read
+// *                  fb->screen.
+// * @param: x      : x coordinate of the seed.
+// * @param: y      : y coordinate of the seed.
+// * @param: color  : the fill color.
+// * @return: 1 if the stack overflowed and the area was not entirely filled,
+// *          0 otherwise.
+int flood_fill(FLOOD_FILL_t* ff, FRAMEBUFFER_t* fb, COLOR_t* shadow, uint_t x,
+               uint_t y, COLOR_t color)
+{
+    FLOOD_SPAN_t span;
+    COLOR_t*     pix;
+    COLOR_t*     src;
+    COLOR_t*     dst;
+    COLOR_t      target;
+    uint_t       w;
+    uint_t       h;
+    uint_t       l;
+    uint_t       r;
+    uint_t       i;
+    int          full;
+
+    w = fb->vinfo.xres;
+    h = fb->vinfo.yres;
+    pix = shadow ? shadow : fb->screen;
+    if (x >= w || y >= h || w > 0x10000 || h > 0x10000)
+        return 0;
+
+    target = pix[y * w + x];
+    if (target == color)
+        return 0;
+
+    // The seed row is scanned upward, the row below it downward.
+    ff->used = 0;
+    full = flood_push(ff, h, y + 1, x, x, 1);
+    full |= flood_push(ff, h, y, x, x, -1);
+    while (ff->used)
+    {
+        span = ff->spans[--ff->used];
+        src = pix + span.y * w;
+        dst = shadow ? fb->screen + span.y * w : NULL;
+        i = span.xl;
+        while (i <= span.xr)
+        {
+            if (src[i] != target)
+            {
+                i++;
+                continue;
+            }
+
+            // Only the run at the start of the span can leak to the left.
+            l = i;
+            if (i == span.xl)
+                while (l > 0 && src[l - 1] == target)
+                    l--;
+
+            r = i;
+            while (r + 1 < w && src[r + 1] == target)
+                r++;
+
+            flood_run(src, dst, l, r, color);
+            ff->pixels += r - l + 1;
+
+            // Parts of the run beyond the span are checked back on the
+            // previous row.
+            full |= flood_push(ff, h, span.y + span.dy, l, r, span.dy);
+            if (l < span.xl)
+                full |= flood_push(ff, h, span.y - span.dy, l, span.xl - 1,
+                                   -span.dy);
+
+            if (r > span.xr)
+                full |= flood_push(ff, h, span.y - span.dy, span.xr + 1, r,
+                                   -span.dy);
+
+            i = r + 2;
+        }
+    }
+
+    if (full)
+    {
+        ff->overflows++;
+        printf("\x1b[1;31m~[ERROR] Flood fill stack of %u spans exceeded."
+               "\x1b[0m\n", ff->capacity);
+    }
+
+    return full;
+}
@@ -0,0 +1,189 @@
+#include "frame_clock.h"
+
+
+// * Return the monotonic clock.
+// * @return: the current time in ns.
+static uint64_t frame_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+// * Sleep until an absolute time, signals do not shorten the sleep.
+// * @param: t: the wake up time in ns.
+static void frame_sleep_until(uint64_t t)
+{
+    struct timespec ts;
+
+    ts.tv_sec = t / 1000000000ULL;
+    ts.tv_nsec = t % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)
+           == EINTR)
+        ;
+
+    return;
+}
+
+
+// * Wait for the next vblank of the first display.
+// * @param: fd: file descriptor of the framebuffer.
+// * @return: 1 in case of an error, 0 otherwise.
+static int frame_wait_vsync(int fd)
+{
+    uint32_t crtc;
+
+    crtc = 0;
+    return ioctl(fd, FBIO_WAITFORVSYNC, &crtc) != 0;
+}
+
+
+// * Initialize a frame clock. FBIO_WAITFORVSYNC is used when the driver
+// * supports it, the period is then rounded to a whole number of vblanks.
+// * @param: *clk: the structure to initialize.
+// * @param: *fb : the framebuffer that is presented, its fd is used for vsync.
+// * @param: fps : target frame rate, 0 for FRAME_DEFAULT_FPS.
+// * @return: 1 in case of an error, 0 otherwise.
+int frame_clock_init(FRAME_CLOCK_t* clk, FRAMEBUFFER_t* fb, uint_t fps)
+{
+    uint64_t t0;
+    uint64_t n;
+
+    memset(clk, 0, sizeof(FRAME_CLOCK_t));
+    clk->fb = fb;
+    clk->period_ns = 1000000000ULL / (fps ? fps : FRAME_DEFAULT_FPS);
+
+    // Measure the vblank period over two intervals, drivers that return
+    // without waiting are caught by the bounds.
+    if (fb && fb->fd >= 0 && !frame_wait_vsync(fb->fd))
+    {
+        t0 = frame_now();
+        if (!frame_wait_vsync(fb->fd) && !frame_wait_vsync(fb->fd))
+        {
+            clk->vblank_ns = (frame_now() - t0) / 2;
+            clk->vsync = clk->vblank_ns >= FRAME_VBLANK_MIN_NS
+                         && clk->vblank_ns <= FRAME_VBLANK_MAX_NS;
+        }
+    }
+
+    if (clk->vsync)
+    {
+        n = (clk->period_ns + clk->vblank_ns / 2) / clk->vblank_ns;
+        clk->period_ns = (n ? n : 1) * clk->vblank_ns;
+    }
+
+    clk->begin = frame_now();
+    clk->next = clk->begin + clk->period_ns;
+    return 0;
+}
+
+
+// * Mark the start of the rendering of a frame.
+// * @param: *clk: the frame clock.
+void begin_frame(FRAME_CLOCK_t* clk)
+{
+    clk->begin = frame_now();
+    return;
+}
+
+
+// * Mark the end of the rendering and wait for the deadline of the frame,
+// * with the next vblank or an absolute clock_nanosleep.
+// * @param: *clk: the frame clock.
+// * @return: the number of deadlines missed by this frame, animations should
+// *          advance by 1 + this value.
+uint_t end_frame(FRAME_CLOCK_t* clk)
+{
+    uint64_t now;
+    uint64_t render;
+    uint64_t late;
+    uint64_t t;
+    uint_t   missed;
+
+    now = frame_now();
+    render = now - clk->begin;
+    clk->frames++;
+    clk->render_ns += render;
+    if (render > clk->render_max_ns)
+        clk->render_max_ns = render;
+
+    fb_trace_span(TRACE_FRAME, clk->begin, now);
+
+    // Over budget: the frame is shown at the next slot, the deadlines keep
+    // their phase.
+    missed = 0;
+    if (now >= clk->next)
+    {
+        late = (now - clk->next) / clk->period_ns + 1;
+        clk->next += late * clk->period_ns;
+        clk->missed += late;
+        missed = late;
+    }
+
+    if (clk->vsync)
+    {
+        // Sleep up to half a vblank before the deadline, then let the driver
+        // wake us on the vblank, which becomes the reference of the next
+        // deadline.
+        t = clk->next - clk->vblank_ns / 2;
+        if (t > now)
+            frame_sleep_until(t);
+
+        if (frame_wait_vsync(clk->fb->fd))
+        {
+            clk->vsync = 0;
+            frame_sleep_until(clk->next);
+            clk->next += clk->period_ns;
+        }
+
+        else
+            clk->next = frame_now() + clk->period_ns;
+    }
+
+    else
+    {
+        frame_sleep_until(clk->next);
+        clk->next += clk->period_ns;
+    }
+
+    t = frame_now();
+    clk->idle_ns += t - now;
+    fb_trace_span(TRACE_PRESENT, now, t);
+    return missed;
+}
+
+
+// * Reset the statistics of the clock.
+// * @param: *clk: the frame clock.
+void frame_clock_reset(FRAME_CLOCK_t* clk)
+{
+    clk->frames = 0;
+    clk->missed = 0;
+    clk->render_ns = 0;
+    clk->render_max_ns = 0;
+    clk->idle_ns = 0;
+    return;
+}
+
+
+// * Print the frame statistics.
+// * @param: *clk: the frame clock.
+// * @param: *out: the stream where the statistics are written.
+void frame_clock_dump(FRAME_CLOCK_t* clk, FILE* out)
+{
+    uint64_t n;
+
+    n = clk->frames ? clk->frames : 1;
+    fprintf(out, "~frames: %llu, budget %llu us (%s), missed %llu\n",
+            (unsigned long long)clk->frames,
+            (unsigned long long)(clk->period_ns / 1000),
+            clk->vsync ? "vsync" : "timer",
+            (unsigned long long)clk->missed);
+    fprintf(out, "~render: avg %llu us, max %llu us, idle: avg %llu us\n",
+            (unsigned long long)(clk->render_ns / n / 1000),
+            (unsigned long long)(clk->render_max_ns / 1000),
+            (unsigned long long)(clk->idle_ns / n / 1000));
+    return;
+}
@@ -0,0 +1,344 @@
+#include "gradient.h"
+
+
+// * Pack 16.16 fixed point r, g, b components into a 0xRRGGBB color.
+#define GRADIENT_PACK(r, g, b) \
+    ((((uint32_t)(r) >> 16) << 16) | (((uint32_t)(g) >> 16) << 8) \
+     | ((uint32_t)(b) >> 16))
+
+
+// * Return the integer square root of a value.
+// * @param: v: the value.
+// * @return: the largest root whose square is lower or equal to v.
+static uint32_t isqrt32(uint32_t v)
+{
+    uint32_t root;
+    uint32_t bit;
+
+    root = 0;
+    bit = 1u << 30;
+    while (bit > v)
+        bit >>= 2;
+
+    while (bit)
+    {
+        if (v >= root + bit)
+        {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+
+        else
+            root >>= 1;
+
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+
+// * Fill a row with a single 0xRRGGBB color, only the 4 pixels period of the
+// * dither matrix is converted, then it is repeated.
+// * @param: *dst  : first pixel of the row on screen.
+// * @param: n     : number of pixels of the row.
+// * @param: x     : x position of dst (for dithering).
+// * @param: y     : y position of dst (for dithering).
+// * @param: rgb   : the color.
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+static void gradient_solid_row(COLOR_t* dst, uint_t n, uint_t x, uint_t y,
+                               uint32_t rgb, int dither)
+{
+    uint32_t buf[4];
+    COLOR_t  pattern[4];
+    uint_t   i;
+
+    for (i = 0; i < 4; i++)
+        buf[i] = rgb;
+
+    argb8888_to_565_span(pattern, buf, 4, x, y, dither);
+    for (i = 0; i < n; i++)
+        dst[i] = pattern[i & 3];
+
+    return;
+}
+
+
+// * Fill a row of a linear gradient. The row is split in three parts: the
+// * pixels before the ramp, the ramp and the pixels after it, so the ramp
+// * only adds the per pixel steps to the components.
+// * @param: *dst  : first pixel of the row on screen.
+// * @param: n     : number of pixels of the row.
+// * @param: x     : x position of dst.
+// * @param: y     : y position of dst.
+// * @param: t     : gradient parameter of the first pixel (16.16).
+// * @param: tx    : gradient parameter step between two pixels (16.16).
+// * @param: rgb0  : color at t = 0.
+// * @param: rgb1  : color at t = GRADIENT_ONE.
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+static void gradient_linear_row(COLOR_t* dst, uint_t n, uint_t x, uint_t y,
+                                int32_t t, int32_t tx, uint32_t rgb0,
+                                uint32_t rgb1, int dither)
+{
+    uint32_t buf[GRADIENT_CHUNK];
+    uint32_t tmp;
+    int32_t  r;
+    int32_t  g;
+    int32_t  b;
+    int32_t  dr;
+    int32_t  dg;
+    int32_t  db;
+    uint_t   lead;
+    uint_t   ramp;
+    uint_t   m;
+    uint_t   i;
+    int64_t  k;
+
+    // Walk the ramp the other way so the step is always positive.
+    if (tx < 0)
+    {
+        t = GRADIENT_ONE - t;
+        tx = -tx;
+        tmp = rgb0;
+        rgb0 = rgb1;
+        rgb1 = tmp;
+    }
+
+    // The row is perpendicular to the gradient, it is a single color.
+    if (!tx)
+    {
+        t = t < 0 ? 0 : t > GRADIENT_ONE ? GRADIENT_ONE : t;
+        r = ((rgb0 >> 16) & 0xFF) << 16;
+        g = ((rgb0 >> 8) & 0xFF) << 16;
+        b = (rgb0 & 0xFF) << 16;
+        r += (int32_t)(((rgb1 >> 16) & 0xFF) - ((rgb0 >> 16) & 0xFF)) * t;
+        g += (int32_t)(((rgb1 >> 8) & 0xFF) - ((rgb0 >> 8) & 0xFF)) * t;
+        b += (int32_t)((rgb1 & 0xFF) - (rgb0 & 0xFF)) * t;
+        gradient_solid_row(dst, n, x, y, GRADIENT_PACK(r, g, b), dither);
+        return;
+    }
+
+    // Pixels with t < 0, then pixels with t <= GRADIENT_ONE.
+    k = t >= 0 ? 0 : (-(int64_t)t + tx - 1) / tx;
+    lead = k > n ? n : k;
+    k = t > GRADIENT_ONE ? 0 : (GRADIENT_ONE - (int64_t)t) / tx + 1;
+    ramp = k > n ? n : k;
+    ramp = ramp > lead ? ramp - lead : 0;
+
+    // The steps are truncated toward zero so the ramp never overshoots.
+    t += (int32_t)lead * tx;
+    dr = (int32_t)((rgb1 >> 16) & 0xFF) - (int32_t)((rgb0 >> 16) & 0xFF);
+    dg = (int32_t)((rgb1 >> 8) & 0xFF) - (int32_t)((rgb0 >> 8) & 0xFF);
+    db = (int32_t)(rgb1 & 0xFF) - (int32_t)(rgb0 & 0xFF);
+    r = (((rgb0 >> 16) & 0xFF) << 16) + dr * t;
+    g = (((rgb0 >> 8) & 0xFF) << 16) + dg * t;
+    b = ((rgb0 & 0xFF) << 16) + db * t;
+    dr *= tx;
+    dg *= tx;
+    db *= tx;
+
+    while (n)
+    {
+        m = n < GRADIENT_CHUNK ? n : GRADIENT_CHUNK;
+        for (i = 0; i < m; i++)
+        {
+            if (lead)
+            {
+                buf[i] = rgb0;
+                lead--;
+            }
+
+            else if (ramp)
+            {
+                buf[i] = GRADIENT_PACK(r, g, b);
+                r += dr;
+                g += dg;
+                b += db;
+                ramp--;
+            }
+
+            else
+                buf[i] = rgb1;
+        }
+
+        argb8888_to_565_span(dst, buf, m, x, y, dither);
+        dst += m;
+        x += m;
+        n -= m;
+    }
+
+    return;
+}
+
+
+// * Fill a rectangle with a linear gradient going from (gx0, gy0) to
+// * (gx1, gy1), the colors are clamped before and after the end points.
+// * Colors are 0xRRGGBB so the ramp keeps its precision until the 16 bits
+// * conversion.
+// * @param: *fb   : FRAMEBUFFER_t where the gradient will be rendered.
+// * @param: x     : start x coordinate of the rectangle.
+// * @param: y     : start y coordinate of the rectangle.
+// * @param: w     : width of the rectangle.
+// * @param: h     : height of the rectangle.
+// * @param: gx0   : x coordinate of the first color.
+// * @param: gy0   : y coordinate of the first color.
+// * @param: rgb0  : first color.
+// * @param: gx1   : x coordinate of the second color.
+// * @param: gy1   : y coordinate of the second color.
+// * @param: rgb1  : second color.
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void fill_gradient_linear(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
+                          uint_t w, uint_t h, int gx0, int gy0, uint32_t rgb0,
+                          int gx1, int gy1, uint32_t rgb1, int dither)
+{
+    COLOR_t* dst;
+    int64_t  len2;
+    int64_t  t;
+    int32_t  tx;
+    int64_t  dx;
+    int64_t  dy;
+    uint_t   i;
+
+    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres)
+        return;
+
+    // Clip the rectangle once so the rows need no bound check.
+    if (w > fb->vinfo.xres - x)
+        w = fb->vinfo.xres - x;
+
+    if (h > fb->vinfo.yres - y)
+        h = fb->vinfo.yres - y;
+
+    // t is the projection of the pixel on the gradient axis, divided by its
+    // squared length, so it is linear along a row.
+    dx = gx1 - gx0;
+    dy = gy1 - gy0;
+    len2 = dx * dx + dy * dy;
+    tx = len2 ? (int32_t)((dx << GRADIENT_SHIFT) / len2) : 0;
+
+    dst = fb->screen + y * fb->vinfo.xres + x;
+    for (i = 0; i < h; i++)
+    {
+        if (len2)
+        {
+            t = (((int64_t)x - gx0) * dx + ((int64_t)(y + i) - gy0) * dy)
+                * GRADIENT_ONE / len2;
+
+            // Far outside the ramp the value only needs to keep its sign.
+            t = t < -(1 << 30) ? -(1 << 30) : t > (1 << 30) ? (1 << 30) : t;
+        }
+
+        else
+            t = GRADIENT_ONE;
+
+        gradient_linear_row(dst, w, x, y + i, (int32_t)t, tx, rgb0, rgb1,
+                            dither);
+        dst += fb->vinfo.xres;
+    }
+
+    return;
+}
+
+
+// * Fill a rectangle with a radial gradient, rgb0 at the center and rgb1 from
+// * radius outwards.
+// * @param: *fb   : FRAMEBUFFER_t where the gradient will be rendered.
+// * @param: x     : start x coordinate of the rectangle.
+// * @param: y     : start y coordinate of the rectangle.
+// * @param: w     : width of the rectangle.
+// * @param: h     : height of the rectangle.
+// * @param: cx    : x coordinate of the center.
+// * @param: cy    : y coordinate of the center.
+// * @param: radius: radius of the gradient in pixels.
+// * @param: rgb0  : color at the center.
+// * @param: rgb1  : color at the radius.
+// * @param: dither: 1 to apply 4x4 ordered dithering, 0 to truncate.
+void fill_gradient_radial(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
+                          uint_t w, uint_t h, int cx, int cy, uint_t radius,
+                          uint32_t rgb0, uint32_t rgb1, int dither)
+{
+    uint32_t buf[GRADIENT_CHUNK];
+    COLOR_t* dst;
+    uint32_t inv;
+    uint32_t d2;
+    uint32_t s;
+    uint32_t t;
+    int32_t  r0;
+    int32_t  g0;
+    int32_t  b0;
+    int32_t  dr;
+    int32_t  dg;
+    int32_t  db;
+    int64_t  dist;
+    int32_t  dx;
+    int32_t  dy;
+    uint_t   i;
+    uint_t   j;
+    uint_t   k;
+    uint_t   m;
+
+    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres)
+        return;
+
+    if (w > fb->vinfo.xres - x)
+        w = fb->vinfo.xres - x;
+
+    if (h > fb->vinfo.yres - y)
+        h = fb->vinfo.yres - y;
+
+    r0 = (rgb0 >> 16) & 0xFF;
+    g0 = (rgb0 >> 8) & 0xFF;
+    b0 = rgb0 & 0xFF;
+    dr = (int32_t)((rgb1 >> 16) & 0xFF) - r0;
+    dg = (int32_t)((rgb1 >> 8) & 0xFF) - g0;
+    db = (int32_t)(rgb1 & 0xFF) - b0;
+
+    // The distance is kept with 4 fractional bits, t = s * inv >> 12.
+    inv = (1u << 24) / (radius ? radius : 1);
+
+    dst = fb->screen + y * fb->vinfo.xres + x;
+    for (i = 0; i < h; i++)
+    {
+        dx = (int32_t)x - cx;
+        dy = (int32_t)(y + i) - cy;
+        dist = (int64_t)dx * dx + (int64_t)dy * dy;
+        d2 = dist < (1 << 24) ? (uint32_t)dist : (1 << 24);
+        s = isqrt32(d2 << 8);
+
+        for (j = 0; j < w; j += m)
+        {
+            m = w - j < GRADIENT_CHUNK ? w - j : GRADIENT_CHUNK;
+            for (k = 0; k < m; k++)
+            {
+                // The distance moves by at most one pixel between two
+                // neighbours, one Newton step from the previous root is
+                // enough. Beyond 4096 pixels the gradient is saturated.
+                if (d2 < (1 << 24))
+                {
+                    s = s ? s : 1;
+                    s = (s + (d2 << 8) / s) >> 1;
+                    t = ((uint64_t)s * inv) >> 12;
+                    t = t > GRADIENT_ONE ? GRADIENT_ONE : t;
+                }
+
+                else
+                    t = GRADIENT_ONE;
+
+                buf[k] = ((uint32_t)(r0 + ((dr * (int32_t)t) >> 16)) << 16)
+                         | ((uint32_t)(g0 + ((dg * (int32_t)t) >> 16)) << 8)
+                         | (uint32_t)(b0 + ((db * (int32_t)t) >> 16));
+
+                // Next pixel: (dx + 1)^2 = dx^2 + 2 * dx + 1.
+                dist += 2 * (int64_t)dx + 1;
+                dx++;
+                d2 = dist < (1 << 24) ? (uint32_t)dist : (1 << 24);
+            }
+
+            argb8888_to_565_span(dst + j, buf, m, x + j, y + i, dither);
+        }
+
+        dst += fb->vinfo.xres;
+    }
+
+    return;
+}
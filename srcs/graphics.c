@@ -1,5 +1,39 @@
 #include "graphics.h"
 #include "iso_font.h"
+#include "fb_stats.h"
+#include "fb_trace.h"
+
+
+// Pixels compared at once by write_rect_keyed, a lane is a pixel of a machine 
+// word. KEYED_LO has the lowest bit of each lane set, KEYED_HI the highest. 
+#define KEYED_LANES (sizeof(unsigned long) / sizeof(COLOR_t))
+#define KEYED_LO    (~0UL / 0xFFFF)
+#define KEYED_HI    (KEYED_LO << 15)
+
+// Scaled glyph expanded into pixels, one row per glyph line. The vertical 
+// scale is done by copying each row. 
+struct glyph_cache_t
+{
+    int             valid; 
+    unsigned char   c; 
+    uint_t          scale; 
+    COLOR_t         fgcolor; 
+    COLOR_t         bgcolor; 
+    COLOR_t*        rows; 
+}; 
+
+// A set holds its ways and the way to replace next, the least recently used. 
+// The rows of every entry are in one pool allocated on the first scaled 
+// draw, sized for the biggest scale drawn so far. 
+struct glyph_set_t
+{
+    struct glyph_cache_t    ways[GLYPH_CACHE_WAYS]; 
+    uint_t                  lru; 
+}; 
+
+static struct glyph_set_t glyph_cache[GLYPH_CACHE_SETS]; 
+static COLOR_t* glyph_pool; 
+static uint_t glyph_pool_scale; 
 
 
 // * Initialize the framebuffer structure with file descriptor, total size of 
@@ -10,12 +44,15 @@
 // * @return: 1 in case of an error, 0 otherwise.  
 int init_framebuffer(FRAMEBUFFER_t* fb, const char *path)
 { 
+    TRACE_BEGIN(); 
+
     // Open the framebuffer peripheral. 
     fb->fd = -1; 
     fb->fd = open(path, O_RDWR);
     if (fb->fd < 0)
     {
         printf("\x1b[1;31m~[ERROR] Opening %s failed.\x1b[0m\n", path); 
+        TRACE_END(TRACE_INIT_FB); 
         return 1; 
     }
     
@@ -33,9 +70,11 @@ int init_framebuffer(FRAMEBUFFER_t* fb, const char *path)
     if (!fb->screen)
     {
         printf("~[ERROR] Mapping video memory failed.\n"); 
+        TRACE_END(TRACE_INIT_FB); 
         return 1; 
     }
 
+    TRACE_END(TRACE_INIT_FB); 
     return 0; 
 }
 
@@ -80,6 +119,7 @@ void display_info(FRAMEBUFFER_t* fb)
 void fill_screen(FRAMEBUFFER_t* fb, COLOR_t color)
 {
     uint_t i; 
+    STAT_BEGIN(); 
 
     i = 0; 
     while (i < fb->vinfo.xres * fb->vinfo.yres)
@@ -87,6 +127,8 @@ void fill_screen(FRAMEBUFFER_t* fb, COLOR_t color)
         fb->screen[i] = color; 
         i++; 
     }
+
+    STAT_END(STAT_FILL_SCREEN, fb->vinfo.xres * fb->vinfo.yres, 0); 
 }
 
 
@@ -97,11 +139,13 @@ void fill_screen(FRAMEBUFFER_t* fb, COLOR_t color)
 // * @param: color: color of the pixel. 
 void draw_pixel(FRAMEBUFFER_t* fb, uint_t x, uint_t y, COLOR_t color)
 {
+    STAT_COUNT(STAT_DRAW_PIXEL, 1, 0); 
+
     // Check x and y boundary. 
-    if (x > fb->vinfo.xres)
+    if (x >= fb->vinfo.xres)
         return; 
 
-    else if (y > fb->vinfo.yres)
+    else if (y >= fb->vinfo.yres)
         return; 
 
     // Set the color to the pixel memory address. 
@@ -117,10 +161,12 @@ void draw_pixel(FRAMEBUFFER_t* fb, uint_t x, uint_t y, COLOR_t color)
 // * @return: the color value of the pixel. 
 COLOR_t get_pixel_color(FRAMEBUFFER_t* fb, uint_t x, uint_t y)
 {
-    if (x > fb->vinfo.xres)
+    STAT_COUNT(STAT_GET_PIXEL, 0, sizeof(COLOR_t)); 
+
+    if (x >= fb->vinfo.xres)
         return -1; 
 
-    else if (y > fb->vinfo.yres)
+    else if (y >= fb->vinfo.yres)
         return -1;
         
     return fb->screen[y * fb->vinfo.xres + x];
@@ -140,9 +186,11 @@ void print_char_coord(FRAMEBUFFER_t* fb, char c, uint_t x, uint_t y,
     unsigned char current_byte; 
     int i; 
     int j; 
+    STAT_BEGIN(); 
 
     // Get the address of the first byte of the character. 
-    char_addr = ISO_FONT + (c * ISO_CHAR_HEIGHT); 
+    // Index with an unsigned char so Latin-1 bytes (>= 0x80) are not negative. 
+    char_addr = ISO_FONT + ((unsigned char)c * ISO_CHAR_HEIGHT); 
 
     for (i = 0; i < ISO_CHAR_HEIGHT; i++)
     {
@@ -168,6 +216,7 @@ void print_char_coord(FRAMEBUFFER_t* fb, char c, uint_t x, uint_t y,
         char_addr++; 
     }
 
+    STAT_END(STAT_PRINT_CHAR, ISO_CHAR_WIDTH * ISO_CHAR_HEIGHT, 0); 
     return; 
 }
 
@@ -243,6 +292,7 @@ void scroll_screen(FRAMEBUFFER_t* fb)
     void* scroll_rect; 
     int max_x; 
     int max_y; 
+    STAT_BEGIN(); 
 
     max_x = fb->vinfo.xres; 
     max_y = fb->vinfo.yres; 
@@ -250,7 +300,10 @@ void scroll_screen(FRAMEBUFFER_t* fb)
     // Copy and write the screen one char width to the top. 
     scroll_rect = copy_rect(fb, 0, ISO_CHAR_HEIGHT, max_x, max_y); 
     if (!scroll_rect)
+    {
+        STAT_END(STAT_SCROLL, 0, 0); 
         return; 
+    }
 
     write_rect(fb, scroll_rect, 0, 0); 
 
@@ -259,11 +312,14 @@ void scroll_screen(FRAMEBUFFER_t* fb)
     
     // Free ressources. 
     RECT_CP_free(scroll_rect); 
+    STAT_END(STAT_SCROLL, max_x * max_y, 
+             max_x * (max_y - ISO_CHAR_HEIGHT) * sizeof(COLOR_t)); 
     return; 
 }
 
 
-// * Draw a ACSII a string on the screen at position x, y. 
+// * Draw a ACSII a string on the screen at position x, y. A char that does
+// * not fit on the line, or '\n', moves to the next line at x. 
 // * @param: str  : the char to draw. 
 // * @param: x    : x position the draw the char. 
 // * @param: y    : y position the draw the char. 
@@ -285,6 +341,7 @@ void print_str_coord(FRAMEBUFFER_t* fb, char* str, uint_t x, uint_t y,
     else if (y > fb->vinfo.yres)
         return; 
 
+    STAT_BEGIN(); 
     row = x; 
     line = y; 
 
@@ -293,22 +350,242 @@ void print_str_coord(FRAMEBUFFER_t* fb, char* str, uint_t x, uint_t y,
     i = 0; 
     while (str[i])
     {
-        print_char_coord(fb, str[i], row, line, fgcolor, bgcolor); 
-
-        row += ISO_CHAR_WIDTH; 
-
-        if (row > fb->vinfo.xres)
+        // Wrap before a char that would cross the right edge, or on '\n'. 
+        if (str[i] == '\n' || row + ISO_CHAR_WIDTH > fb->vinfo.xres)
         {
             row = x; 
             line += ISO_CHAR_HEIGHT; 
         }
-        
+
+        if (str[i] != '\n')
+        {
+            print_char_coord(fb, str[i], row, line, fgcolor, bgcolor); 
+            row += ISO_CHAR_WIDTH; 
+        }
+
         i++; 
     }
+
+    STAT_END(STAT_PRINT_STR, i * ISO_CHAR_WIDTH * ISO_CHAR_HEIGHT, 0); 
 }
 
 
 
+// * Expand a glyph of the font, scaled horizontally. 
+// * @param: *dst   : ISO_CHAR_HEIGHT rows of ISO_CHAR_WIDTH * scale pixels. 
+// * @param: c      : the char to expand. 
+// * @param: scale  : scale factor (1 to TEXT_SCALE_MAX). 
+// * @param: fgcolor: color of the letter. 
+// * @param: bgcolor: color of the background of the char. 
+static void glyph_expand(COLOR_t* dst, unsigned char c, uint_t scale, 
+                         COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    unsigned char bits; 
+    COLOR_t color; 
+    uint_t i; 
+    uint_t j; 
+    uint_t k; 
+
+    for (i = 0; i < ISO_CHAR_HEIGHT; i++)
+    {
+        bits = ISO_FONT[c * ISO_CHAR_HEIGHT + i]; 
+        for (j = 0; j < ISO_CHAR_WIDTH; j++)
+        {
+            color = (bits >> j) & 0x01 ? fgcolor : bgcolor; 
+            for (k = 0; k < scale; k++)
+                *dst++ = color; 
+        }
+    }
+
+    return; 
+}
+
+
+// * Make the pool of the glyph cache big enough for a scale, the cache is 
+// * emptied when the pool grows. 
+// * @param: scale: scale factor (1 to TEXT_SCALE_MAX). 
+// * @return: 1 in case of an error, 0 otherwise. 
+static int glyph_pool_reserve(uint_t scale)
+{
+    COLOR_t* pool; 
+    uint_t slot; 
+    uint_t i; 
+    uint_t j; 
+
+    if (scale <= glyph_pool_scale)
+        return 0; 
+
+    slot = ISO_CHAR_HEIGHT * ISO_CHAR_WIDTH * scale; 
+    pool = realloc(glyph_pool, sizeof(COLOR_t) * slot 
+                               * GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS); 
+    if (!pool)
+        return 1; 
+
+    glyph_pool = pool; 
+    glyph_pool_scale = scale; 
+    for (i = 0; i < GLYPH_CACHE_SETS; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_WAYS; j++)
+        {
+            glyph_cache[i].ways[j].valid = 0; 
+            glyph_cache[i].ways[j].rows = pool; 
+            pool += slot; 
+        }
+    }
+
+    return 0; 
+}
+
+
+// * Return the expanded scaled glyph of a char, expanding it if it is not 
+// * already in the cache. 
+// * @param: c      : the char to expand. 
+// * @param: scale  : scale factor (1 to TEXT_SCALE_MAX). 
+// * @param: fgcolor: color of the letter. 
+// * @param: bgcolor: color of the background of the char. 
+// * @return: the rows of the glyph, NULL if the pool can not be allocated. 
+static COLOR_t* glyph_cache_get(unsigned char c, uint_t scale, 
+                                COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    struct glyph_set_t* set; 
+    struct glyph_cache_t* entry; 
+    uint_t i; 
+
+    if (glyph_pool_reserve(scale))
+        return NULL; 
+
+    set = &glyph_cache[(c + scale) % GLYPH_CACHE_SETS]; 
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++)
+    {
+        entry = &set->ways[i]; 
+        if (entry->valid && entry->c == c && entry->scale == scale 
+            && entry->fgcolor == fgcolor && entry->bgcolor == bgcolor)
+        {
+            set->lru = (i + 1) % GLYPH_CACHE_WAYS; 
+            return entry->rows; 
+        }
+    }
+
+    // A miss replaces the least recently used way. 
+    entry = &set->ways[set->lru]; 
+    set->lru = (set->lru + 1) % GLYPH_CACHE_WAYS; 
+    glyph_expand(entry->rows, c, scale, fgcolor, bgcolor); 
+    entry->valid = 1; 
+    entry->c = c; 
+    entry->scale = scale; 
+    entry->fgcolor = fgcolor; 
+    entry->bgcolor = bgcolor; 
+    return entry->rows; 
+}
+
+
+// * Draw a ACSII character scaled by an integer factor at position x, y. The
+// * scaled glyph is expanded once and cached, then drawn with row copies.
+// * @param: c      : the char to draw. 
+// * @param: x      : x position where to the draw the char. 
+// * @param: y      : y position where to the draw the char. 
+// * @param: scale  : scale factor (1 to TEXT_SCALE_MAX). 
+// * @param: fgcolor: color of the letter. 
+// * @param: bgcolor: color of the background of the char. 
+void print_char_coord_scaled(FRAMEBUFFER_t* fb, char c, uint_t x, uint_t y, 
+                             uint_t scale, COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    COLOR_t tmp[ISO_CHAR_HEIGHT * ISO_CHAR_WIDTH * TEXT_SCALE_MAX]; 
+    COLOR_t* glyph; 
+    COLOR_t* src; 
+    COLOR_t* dst; 
+    uint_t w; 
+    uint_t h; 
+    uint_t i; 
+
+    if (!scale || scale > TEXT_SCALE_MAX)
+        return; 
+
+    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres)
+        return; 
+
+    // Clip the glyph once so the copies need no bound check. 
+    w = ISO_CHAR_WIDTH * scale; 
+    h = ISO_CHAR_HEIGHT * scale; 
+    if (w > fb->vinfo.xres - x)
+        w = fb->vinfo.xres - x; 
+
+    if (h > fb->vinfo.yres - y)
+        h = fb->vinfo.yres - y; 
+
+    // Without the cache the glyph is expanded on the stack. 
+    glyph = glyph_cache_get((unsigned char)c, scale, fgcolor, bgcolor); 
+    if (!glyph)
+    {
+        glyph = tmp; 
+        glyph_expand(glyph, (unsigned char)c, scale, fgcolor, bgcolor); 
+    }
+
+    // Each expanded row is copied scale times. 
+    dst = fb->screen + y * fb->vinfo.xres + x; 
+    for (i = 0; i < h; i++)
+    {
+        src = glyph + (i / scale) * ISO_CHAR_WIDTH * scale; 
+        memcpy(dst, src, w * sizeof(COLOR_t)); 
+        dst += fb->vinfo.xres; 
+    }
+
+    return; 
+}
+
+
+// * Draw a ACSII string scaled by an integer factor at position x, y. A char
+// * that does not fit on the line, or '\n', moves to the next line at x. 
+// * @param: str    : the string to draw. 
+// * @param: x      : x position of the first char. 
+// * @param: y      : y position of the first char. 
+// * @param: scale  : scale factor (1 to TEXT_SCALE_MAX). 
+// * @param: fgcolor: color of the letters. 
+// * @param: bgcolor: color of the background of the chars. 
+void print_str_coord_scaled(FRAMEBUFFER_t* fb, char* str, uint_t x, uint_t y, 
+                            uint_t scale, COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    uint_t row; 
+    uint_t line; 
+    uint_t w; 
+    int i; 
+
+    if (!str || !scale || scale > TEXT_SCALE_MAX)
+        return; 
+
+    w = ISO_CHAR_WIDTH * scale; 
+    row = x; 
+    line = y; 
+
+    i = 0; 
+    while (str[i] && line < fb->vinfo.yres)
+    {
+        // Wrap on '\n', or before a char that would straddle the right edge. 
+        if (str[i] == '\n')
+        {
+            row = x; 
+            line += ISO_CHAR_HEIGHT * scale; 
+            i++; 
+            continue; 
+        }
+
+        if (row + w > fb->vinfo.xres && row != x)
+        {
+            row = x; 
+            line += ISO_CHAR_HEIGHT * scale; 
+            continue; 
+        }
+
+        print_char_coord_scaled(fb, str[i], row, line, scale, 
+                                fgcolor, bgcolor); 
+        row += w; 
+        i++; 
+    }
+
+    return; 
+}
+
+
 // * Put a string on the screen at global cursor position. 
 // * @param: c      : the char to draw. 
 // * @param: fgcolor: color of the letter. 
@@ -341,12 +618,16 @@ void* copy_rect(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0,
     RECT_CP_t* cp; 
     uint_t x; 
     uint_t y; 
+    STAT_BEGIN(); 
     
     // Allocate space for the RECT_CT_t structure that hold size info and the 
     // buffer itself. 
     cp = malloc(sizeof(RECT_CP_t)); 
     if (!cp)
+    {
+        STAT_END(STAT_COPY_RECT, 0, 0); 
         return NULL; 
+    }
     
     // Initialise all the size of the buffer. 
     cp->w = x1 - x0; 
@@ -358,6 +639,7 @@ void* copy_rect(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0,
     if (!cp->buf)
     {
         RECT_CP_free(cp); 
+        STAT_END(STAT_COPY_RECT, 0, 0); 
         return NULL; 
     }
     
@@ -368,6 +650,7 @@ void* copy_rect(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0,
         cp->buf[(y - y0) * (x1 - x0) + (x - x0)] = get_pixel_color(fb, x, y); 
     }
     
+    STAT_END(STAT_COPY_RECT, 0, cp->size * sizeof(COLOR_t)); 
     return (void*)cp; 
 }
 
@@ -402,6 +685,7 @@ void write_rect(FRAMEBUFFER_t* fb, void* buf, uint_t x, uint_t y)
     RECT_CP_t* cp; 
     uint_t i; 
     uint_t j; 
+    STAT_BEGIN(); 
 
     // Cast the void buffer. 
     cp = (RECT_CP_t*)buf; 
@@ -418,6 +702,7 @@ void write_rect(FRAMEBUFFER_t* fb, void* buf, uint_t x, uint_t y)
         i++; 
     }
 
+    STAT_END(STAT_WRITE_RECT, cp->size, 0); 
     return; 
 }
 
@@ -439,6 +724,7 @@ void write_rect_alpha(FRAMEBUFFER_t* fb, void* buf, uint_t x,
     COLOR_t         blended; 
     uint_t    i; 
     uint_t    j; 
+    STAT_BEGIN(); 
 
     // Cast the void buffer. 
     cp = (RECT_CP_t*)buf; 
@@ -459,6 +745,105 @@ void write_rect_alpha(FRAMEBUFFER_t* fb, void* buf, uint_t x,
         i++; 
     }
 
+    STAT_END(STAT_WRITE_RECT_A, cp->size, cp->size * sizeof(COLOR_t)); 
+    return; 
+}
+
+
+// * Return a machine word read from pixels that may not be aligned. 
+// * @param: *p: the first pixel of the word. 
+// * @return: the KEYED_LANES pixels of the word. 
+static inline unsigned long keyed_load(const COLOR_t* p)
+{
+    unsigned long v; 
+
+    memcpy(&v, p, sizeof(unsigned long)); 
+    return v; 
+}
+
+
+// * Paste a row of pixels, the pixels of the key color are skipped and the 
+// * runs between them are copied at once. A word of pixels is compared to 
+// * the key at a time: v ^ keys has a null lane for each key pixel. 
+// * @param: *dst: the first pixel of the row on the screen. 
+// * @param: *src: the first pixel of the row of the copy. 
+// * @param: w   : number of pixels of the row. 
+// * @param: key : the transparent color. 
+// * @return: the number of pixels copied. 
+static uint_t write_row_keyed(COLOR_t* dst, const COLOR_t* src, uint_t w, 
+                              COLOR_t key)
+{
+    unsigned long keys; 
+    unsigned long v; 
+    uint_t        start; 
+    uint_t        copied; 
+    uint_t        i; 
+
+    keys = KEYED_LO * key; 
+    copied = 0; 
+    i = 0; 
+    while (i < w)
+    {
+        // Transparent words are skipped whole. 
+        while (i + KEYED_LANES <= w && keyed_load(src + i) == keys)
+            i += KEYED_LANES; 
+
+        while (i < w && src[i] == key)
+            i++; 
+
+        // An opaque run goes on while a word has no key pixel. 
+        start = i; 
+        while (i + KEYED_LANES <= w)
+        {
+            v = keyed_load(src + i) ^ keys; 
+            if ((v - KEYED_LO) & ~v & KEYED_HI)
+                break; 
+
+            i += KEYED_LANES; 
+        }
+
+        while (i < w && src[i] != key)
+            i++; 
+
+        memcpy(dst + start, src + start, sizeof(COLOR_t) * (i - start)); 
+        copied += i - start; 
+    }
+
+    return copied; 
+}
+
+
+// * Paste a rectangle of pixel previously copied, the pixels of the key 
+// * color are transparent. The rectangle is clipped to the screen. 
+// * @param: *fb: The framebuffer where the area will be pasted. 
+// * @param: buf: The RECT_CP_t buffer that contains data that will be drawn. 
+// * @param: x  : x coordinate of the top-left corner where the copy will be 
+// *              drawn. 
+// * @param: y  : y coordinate of the top-left corner where the copy will be 
+// *              drawn. 
+// * @param: key: the transparent color. 
+void write_rect_keyed(FRAMEBUFFER_t* fb, void* buf, uint_t x, uint_t y, 
+                      COLOR_t key)
+{
+    RECT_CP_t* cp; 
+    uint_t     w; 
+    uint_t     h; 
+    uint_t     j; 
+    uint_t     copied; 
+    STAT_BEGIN(); 
+
+    cp = (RECT_CP_t*)buf; 
+    copied = 0; 
+    if (x < fb->vinfo.xres && y < fb->vinfo.yres)
+    {
+        w = cp->w > fb->vinfo.xres - x ? fb->vinfo.xres - x : cp->w; 
+        h = cp->h > fb->vinfo.yres - y ? fb->vinfo.yres - y : cp->h; 
+        for (j = 0; j < h; j++)
+            copied += write_row_keyed(fb->screen + (y + j) * fb->vinfo.xres 
+                                      + x, cp->buf + j * cp->w, w, key); 
+    }
+
+    STAT_END(STAT_WRITE_RECT_K, copied, 0); 
     return; 
 }
 
@@ -474,10 +859,12 @@ void draw_h_line(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
     uint_t w, COLOR_t color)
 {
     uint_t i; 
+    STAT_BEGIN(); 
 
     for (i = 0; i < w; i++)
         draw_pixel(fb, x + i, y, color); 
 
+    STAT_END(STAT_H_LINE, w, 0); 
     return; 
 }
 
@@ -492,10 +879,12 @@ void draw_v_line(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
     uint_t h, COLOR_t color)
 {
     uint_t i; 
+    STAT_BEGIN(); 
 
     for (i = 0; i < h; i++)
         draw_pixel(fb, x, y + i, color); 
 
+    STAT_END(STAT_V_LINE, h, 0); 
     return; 
 }
 
@@ -515,6 +904,7 @@ void draw_line(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0,
     uint_t d; 
     uint_t y; 
     uint_t x; 
+    STAT_BEGIN(); 
 
     dx = x1 - x0; 
     dy = y1 - y0; 
@@ -536,6 +926,8 @@ void draw_line(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0,
         d += 2 * dy; 
         x++; 
     }
+
+    STAT_END(STAT_LINE, x - x0, 0); 
 }
 
 
@@ -550,11 +942,101 @@ void draw_rect(FRAMEBUFFER_t* fb, uint_t x, uint_t y,
                uint_t w, uint_t h, COLOR_t color)
 {
     uint_t i; 
+    STAT_BEGIN(); 
 
     // Draw horizontal line for the height of the rectangle. 
     for (i = 0; i < h; i++)
         draw_h_line(fb, x, y + i, w, color); 
 
+    STAT_END(STAT_RECT, w * h, 0); 
+    return; 
+}
+
+
+// * Fill the area x0;y0 - x1;y1 (excluded) clipped to the screen, the first 
+// * row is filled and copied to the others. 
+// * @param: *fb  : FRAMEBUFFER_t where the area is filled. 
+// * @param: x0   : left edge of the area. 
+// * @param: y0   : top edge of the area. 
+// * @param: x1   : right edge of the area (excluded). 
+// * @param: y1   : bottom edge of the area (excluded). 
+// * @param: color: color of the area. 
+void fill_area(FRAMEBUFFER_t* fb, uint_t x0, uint_t y0, uint_t x1, uint_t y1, 
+               COLOR_t color)
+{
+    COLOR_t* row; 
+    uint_t   x; 
+    uint_t   y; 
+
+    x1 = x1 > fb->vinfo.xres ? fb->vinfo.xres : x1; 
+    y1 = y1 > fb->vinfo.yres ? fb->vinfo.yres : y1; 
+    if (x0 >= x1 || y0 >= y1)
+        return; 
+
+    row = fb->screen + y0 * fb->vinfo.xres; 
+    for (x = x0; x < x1; x++)
+        row[x] = color; 
+
+    for (y = y0 + 1; y < y1; y++)
+        memcpy(row + (y - y0) * fb->vinfo.xres + x0, row + x0, 
+               sizeof(COLOR_t) * (x1 - x0)); 
+
+    return; 
+}
+
+
+// * Draw the part of a string inside the area x0;y0 - x1;y1 (excluded), 
+// * clipped to the screen. The string is laid on one line from x, y, so a 
+// * clipped string, or a string split between tiles, is drawn row by row 
+// * without drawing whole glyphs. 
+// * @param: *fb    : FRAMEBUFFER_t where the string is drawn. 
+// * @param: *str   : the string. 
+// * @param: x      : x coordinate of the first char. 
+// * @param: y      : y coordinate of the first char. 
+// * @param: x0     : left edge of the area. 
+// * @param: y0     : top edge of the area. 
+// * @param: x1     : right edge of the area (excluded). 
+// * @param: y1     : bottom edge of the area (excluded). 
+// * @param: fgcolor: color of the letters. 
+// * @param: bgcolor: color of the background of the letters. 
+void print_str_area(FRAMEBUFFER_t* fb, const char* str, uint_t x, uint_t y, 
+                    uint_t x0, uint_t y0, uint_t x1, uint_t y1, 
+                    COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    const unsigned char* s; 
+    unsigned char        bits; 
+    COLOR_t*             row; 
+    uint_t               px; 
+    uint_t               py; 
+    uint_t               dx; 
+
+    // Clip the area to the string and to the screen. 
+    s = (const unsigned char*)str; 
+    x0 = x0 < x ? x : x0; 
+    y0 = y0 < y ? y : y0; 
+    x1 = x1 > x + strlen(str) * ISO_CHAR_WIDTH ? 
+         x + strlen(str) * ISO_CHAR_WIDTH : x1; 
+    y1 = y1 > y + ISO_CHAR_HEIGHT ? y + ISO_CHAR_HEIGHT : y1; 
+    x1 = x1 > fb->vinfo.xres ? fb->vinfo.xres : x1; 
+    y1 = y1 > fb->vinfo.yres ? fb->vinfo.yres : y1; 
+    if (x0 >= x1 || y0 >= y1)
+        return; 
+
+    for (py = y0; py < y1; py++)
+    {
+        row = fb->screen + py * fb->vinfo.xres; 
+        for (px = x0; px < x1; px++)
+        {
+            dx = px - x; 
+            bits = ISO_FONT[s[dx / ISO_CHAR_WIDTH] * ISO_CHAR_HEIGHT 
+                            + (py - y)]; 
+
+            // The lowest bit of the glyph row is the leftmost pixel. 
+            row[px] = (bits >> (dx % ISO_CHAR_WIDTH)) & 0x01 ? 
+                      fgcolor : bgcolor; 
+        }
+    }
+
     return; 
 }
 
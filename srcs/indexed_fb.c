@@ -0,0 +1,443 @@
+#include "indexed_fb.h"
+#include "fb_trace.h"
+
+
+// * Build the expansion of every 4 bpp byte from the palette.
+// * @param: *ifb: the back buffer.
+static void indexed_build_pairs(INDEXED_FB_t* ifb)
+{
+    uint_t b;
+
+    for (b = 0; b < 256; b++)
+    {
+        ifb->pairs[b][0] = ifb->lut[b & 0x0F];
+        ifb->pairs[b][1] = ifb->lut[b >> 4];
+    }
+
+    return;
+}
+
+
+// * Mark every row dirty.
+// * @param: *ifb: the back buffer.
+static void indexed_dirty_all(INDEXED_FB_t* ifb)
+{
+    memset(ifb->dirty, 1, ifb->h);
+    return;
+}
+
+
+// * Initialize a back buffer of palette indices for the screen, cleared to
+// * the index 0. Every row is dirty so the first flush draws the screen.
+// * @param: *ifb: the structure to initialize.
+// * @param: *fb : the framebuffer where the back buffer is flushed.
+// * @param: bpp : INDEXED_4BPP or INDEXED_8BPP.
+// * @return: 1 in case of an error, 0 otherwise.
+int indexed_fb_init(INDEXED_FB_t* ifb, FRAMEBUFFER_t* fb, uint_t bpp)
+{
+    static const uint8_t LEVELS[6] = {0x00, 0x5F, 0x87, 0xAF, 0xD7, 0xFF};
+    uint_t               i;
+    uint8_t              v;
+
+    memset(ifb, 0, sizeof(INDEXED_FB_t));
+    if (bpp != INDEXED_4BPP && bpp != INDEXED_8BPP)
+        return 1;
+
+    ifb->fb = fb;
+    ifb->w = fb->vinfo.xres;
+    ifb->h = fb->vinfo.yres;
+    ifb->bpp = bpp;
+    ifb->stride = bpp == INDEXED_8BPP ? ifb->w : (ifb->w + 1) / 2;
+    ifb->pix = calloc(ifb->stride, ifb->h);
+    ifb->dirty = malloc(ifb->h);
+    if (!ifb->pix || !ifb->dirty)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the indexed back buffer failed."
+               "\x1b[0m\n");
+        indexed_fb_free(ifb);
+        return 1;
+    }
+
+    for (i = 0; i < PALETTE_SIZE; i++)
+        ifb->lut[i] = palette(i);
+
+    for (i = 0; i < 216; i++)
+        ifb->lut[16 + i] = RGB888_TO_565(LEVELS[i / 36], LEVELS[i / 6 % 6],
+                                         LEVELS[i % 6]);
+
+    for (i = 0; i < 24; i++)
+    {
+        v = 8 + i * 10;
+        ifb->lut[232 + i] = RGB888_TO_565(v, v, v);
+    }
+
+    indexed_build_pairs(ifb);
+    indexed_dirty_all(ifb);
+    return 0;
+}
+
+
+// * Free the back buffer.
+// * @param: *ifb: the back buffer to free.
+void indexed_fb_free(INDEXED_FB_t* ifb)
+{
+    free(ifb->pix);
+    free(ifb->dirty);
+    ifb->pix = NULL;
+    ifb->dirty = NULL;
+    return;
+}
+
+
+// * Change a color of the palette, every row is flushed again if it changed.
+// * @param: *ifb : the back buffer.
+// * @param: index: the index of the color.
+// * @param: color: the new color.
+void indexed_fb_set_color(INDEXED_FB_t* ifb, uint8_t index, COLOR_t color)
+{
+    if (ifb->lut[index] == color)
+        return;
+
+    ifb->lut[index] = color;
+    if (index < PALETTE_SIZE)
+        indexed_build_pairs(ifb);
+
+    indexed_dirty_all(ifb);
+    return;
+}
+
+
+// * Copy the colors of palette() to the first PALETTE_SIZE entries, after the
+// * active palette has been swapped.
+// * @param: *ifb: the back buffer.
+void indexed_fb_sync_palette(INDEXED_FB_t* ifb)
+{
+    int i;
+
+    for (i = 0; i < PALETTE_SIZE; i++)
+        indexed_fb_set_color(ifb, i, palette(i));
+
+    return;
+}
+
+
+// * Expand the dirty rows to the screen through the palette.
+// * @param: *ifb: the back buffer.
+// * @return: the number of rows written.
+uint_t indexed_fb_flush(INDEXED_FB_t* ifb)
+{
+    const uint8_t* src;
+    COLOR_t*       dst;
+    uint_t         rows;
+    uint_t         i;
+    uint_t         j;
+    TRACE_BEGIN();
+
+    rows = 0;
+    for (i = 0; i < ifb->h; i++)
+    {
+        if (!ifb->dirty[i])
+            continue;
+
+        src = ifb->pix + i * ifb->stride;
+        dst = ifb->fb->screen + i * ifb->fb->vinfo.xres;
+        if (ifb->bpp == INDEXED_8BPP)
+            for (j = 0; j < ifb->w; j++)
+                dst[j] = ifb->lut[src[j]];
+
+        else
+        {
+            // Two pixels per byte, the last one of an odd row is alone.
+            for (j = 0; j < ifb->w / 2; j++)
+                memcpy(dst + 2 * j, ifb->pairs[src[j]], 2 * sizeof(COLOR_t));
+
+            if (ifb->w & 1)
+                dst[ifb->w - 1] = ifb->lut[src[j] & 0x0F];
+        }
+
+        ifb->dirty[i] = 0;
+        rows++;
+    }
+
+    ifb->rows_flushed += rows;
+    TRACE_END(TRACE_FLUSH);
+    return rows;
+}
+
+
+// * Write the index of a pixel, the coordinates are already checked.
+// * @param: *ifb : the back buffer.
+// * @param: *row : the row of the pixel.
+// * @param: x    : x coordinate of the pixel.
+// * @param: index: palette index of the pixel.
+static inline void indexed_put(INDEXED_FB_t* ifb, uint8_t* row, uint_t x,
+                               uint8_t index)
+{
+    if (ifb->bpp == INDEXED_8BPP)
+        row[x] = index;
+
+    else if (x & 1)
+        row[x / 2] = (row[x / 2] & 0x0F) | (index << 4);
+
+    else
+        row[x / 2] = (row[x / 2] & 0xF0) | (index & 0x0F);
+
+    return;
+}
+
+
+// * Draw a pixel in the back buffer.
+// * @param: *ifb : the back buffer.
+// * @param: x    : x coordinate of the pixel.
+// * @param: y    : y coordinate of the pixel.
+// * @param: index: palette index of the pixel.
+void indexed_draw_pixel(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint8_t index)
+{
+    if (x >= ifb->w || y >= ifb->h)
+        return;
+
+    indexed_put(ifb, ifb->pix + y * ifb->stride, x, index);
+    ifb->dirty[y] = 1;
+    return;
+}
+
+
+// * Return the palette index of a pixel of the back buffer.
+// * @param: *ifb: the back buffer.
+// * @param: x   : x coordinate of the pixel.
+// * @param: y   : y coordinate of the pixel.
+// * @return: the index, 0 out of the screen.
+uint8_t indexed_get_pixel(INDEXED_FB_t* ifb, uint_t x, uint_t y)
+{
+    uint8_t b;
+
+    if (x >= ifb->w || y >= ifb->h)
+        return 0;
+
+    if (ifb->bpp == INDEXED_8BPP)
+        return ifb->pix[y * ifb->stride + x];
+
+    b = ifb->pix[y * ifb->stride + x / 2];
+    return x & 1 ? b >> 4 : b & 0x0F;
+}
+
+
+// * Draw a filled rectangle in the back buffer, clipped to the screen.
+// * @param: *ifb : the back buffer.
+// * @param: x    : start x coordinate.
+// * @param: y    : start y coordinate.
+// * @param: w    : width of the rectangle.
+// * @param: h    : height of the rectangle.
+// * @param: index: palette index of the rectangle.
+void indexed_fill_rect(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint_t w,
+                       uint_t h, uint8_t index)
+{
+    uint8_t* row;
+    uint_t   x0;
+    uint_t   x1;
+    uint_t   i;
+
+    if (x >= ifb->w || y >= ifb->h)
+        return;
+
+    w = w > ifb->w - x ? ifb->w - x : w;
+    h = h > ifb->h - y ? ifb->h - y : h;
+    if (!w)
+        return;
+
+    for (i = y; i < y + h; i++)
+    {
+        row = ifb->pix + i * ifb->stride;
+        ifb->dirty[i] = 1;
+        if (ifb->bpp == INDEXED_8BPP)
+        {
+            memset(row + x, index, w);
+            continue;
+        }
+
+        // Whole bytes between the nibbles of the edges.
+        x0 = x;
+        x1 = x + w;
+        if (x0 & 1)
+            indexed_put(ifb, row, x0++, index);
+
+        if (x1 > x0 && x1 & 1)
+            indexed_put(ifb, row, --x1, index);
+
+        if (x1 > x0)
+            memset(row + x0 / 2, (index & 0x0F) * 0x11, (x1 - x0) / 2);
+    }
+
+    return;
+}
+
+
+// * Fill the whole back buffer.
+// * @param: *ifb : the back buffer.
+// * @param: index: palette index of the screen.
+void indexed_fill(INDEXED_FB_t* ifb, uint8_t index)
+{
+    indexed_fill_rect(ifb, 0, 0, ifb->w, ifb->h, index);
+    return;
+}
+
+
+// * Draw a horizontal line in the back buffer, clipped to the screen.
+// * @param: *ifb : the back buffer.
+// * @param: x    : start x coordinate.
+// * @param: y    : y coordinate of the line.
+// * @param: w    : length of the line.
+// * @param: index: palette index of the line.
+void indexed_draw_h_line(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint_t w,
+                         uint8_t index)
+{
+    indexed_fill_rect(ifb, x, y, w, 1, index);
+    return;
+}
+
+
+// * Draw a vertical line in the back buffer, clipped to the screen.
+// * @param: *ifb : the back buffer.
+// * @param: x    : x coordinate of the line.
+// * @param: y    : start y coordinate.
+// * @param: h    : length of the line.
+// * @param: index: palette index of the line.
+void indexed_draw_v_line(INDEXED_FB_t* ifb, uint_t x, uint_t y, uint_t h,
+                         uint8_t index)
+{
+    uint_t i;
+
+    if (x >= ifb->w || y >= ifb->h)
+        return;
+
+    h = h > ifb->h - y ? ifb->h - y : h;
+    for (i = y; i < y + h; i++)
+    {
+        indexed_put(ifb, ifb->pix + i * ifb->stride, x, index);
+        ifb->dirty[i] = 1;
+    }
+
+    return;
+}
+
+
+// * Draw a line between two points in the back buffer, in any direction.
+// * Pixels out of the screen are skipped.
+// * @param: *ifb : the back buffer.
+// * @param: x0   : x coordinate of the first point.
+// * @param: y0   : y coordinate of the first point.
+// * @param: x1   : x coordinate of the last point.
+// * @param: y1   : y coordinate of the last point.
+// * @param: index: palette index of the line.
+void indexed_draw_line(INDEXED_FB_t* ifb, uint_t x0, uint_t y0, uint_t x1,
+                       uint_t y1, uint8_t index)
+{
+    long dx;
+    long dy;
+    long err;
+    long e2;
+    int  sx;
+    int  sy;
+
+    // Bresenham's line algorithm for every octant.
+    dx = x1 > x0 ? (long)x1 - x0 : (long)x0 - x1;
+    dy = y1 > y0 ? -((long)y1 - y0) : -((long)y0 - y1);
+    sx = x0 < x1 ? 1 : -1;
+    sy = y0 < y1 ? 1 : -1;
+    err = dx + dy;
+    while (1)
+    {
+        indexed_draw_pixel(ifb, x0, y0, index);
+        if (x0 == x1 && y0 == y1)
+            break;
+
+        e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+
+    return;
+}
+
+
+// * Draw a char of the built-in font in the back buffer.
+// * @param: *ifb: the back buffer.
+// * @param: c   : the char.
+// * @param: x   : x coordinate of the top-left corner.
+// * @param: y   : y coordinate of the top-left corner.
+// * @param: fg  : palette index of the letter.
+// * @param: bg  : palette index of the background.
+void indexed_print_char(INDEXED_FB_t* ifb, char c, uint_t x, uint_t y,
+                        uint8_t fg, uint8_t bg)
+{
+    const unsigned char* glyph;
+    uint8_t*             row;
+    uint_t               w;
+    uint_t               h;
+    uint_t               i;
+    uint_t               j;
+
+    if (x >= ifb->w || y >= ifb->h)
+        return;
+
+    glyph = ISO_FONT + (unsigned char)c * ISO_CHAR_HEIGHT;
+    w = ifb->w - x < ISO_CHAR_WIDTH ? ifb->w - x : ISO_CHAR_WIDTH;
+    h = ifb->h - y < ISO_CHAR_HEIGHT ? ifb->h - y : ISO_CHAR_HEIGHT;
+    for (i = 0; i < h; i++)
+    {
+        row = ifb->pix + (y + i) * ifb->stride;
+        for (j = 0; j < w; j++)
+            indexed_put(ifb, row, x + j, glyph[i] >> j & 1 ? fg : bg);
+
+        ifb->dirty[y + i] = 1;
+    }
+
+    return;
+}
+
+
+// * Draw a string of the built-in font in the back buffer. A char that does
+// * not fit on the line, or '\n', moves to the next line at x.
+// * @param: *ifb: the back buffer.
+// * @param: *str: the string.
+// * @param: x   : x coordinate of the first char.
+// * @param: y   : y coordinate of the first char.
+// * @param: fg  : palette index of the letters.
+// * @param: bg  : palette index of the background.
+void indexed_print_str(INDEXED_FB_t* ifb, const char* str, uint_t x, uint_t y,
+                       uint8_t fg, uint8_t bg)
+{
+    uint_t row;
+    uint_t line;
+
+    if (!str || x >= ifb->w)
+        return;
+
+    row = x;
+    line = y;
+    for (; *str && line < ifb->h; str++)
+    {
+        if (*str == '\n' || row + ISO_CHAR_WIDTH > ifb->w)
+        {
+            row = x;
+            line += ISO_CHAR_HEIGHT;
+        }
+
+        if (*str != '\n')
+        {
+            indexed_print_char(ifb, *str, row, line, fg, bg);
+            row += ISO_CHAR_WIDTH;
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,648 @@
+#include "input.h"
+
+
+// Default pointer: 'X' is the border, '.' the inside, ' ' is transparent.
+#define ARROW_W     11
+#define ARROW_H     16
+#define ARROW_KEY   MAGEN
+
+static const char* ARROW[ARROW_H] = {
+    "X          ",
+    "XX         ",
+    "X.X        ",
+    "X..X       ",
+    "X...X      ",
+    "X....X     ",
+    "X.....X    ",
+    "X......X   ",
+    "X.......X  ",
+    "X........X ",
+    "X.....XXXXX",
+    "X..X..X    ",
+    "X.X X..X   ",
+    "XX  X..X   ",
+    "     X..X  ",
+    "     XXXX  "
+};
+
+
+// * Return the monotonic clock.
+// * @return: the current time in ns.
+static uint64_t input_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+// * Return the timestamp of an event.
+// * @param: *ev: the event.
+// * @return: the time in ns.
+static uint64_t input_ev_time(const struct input_event* ev)
+{
+#ifdef input_event_sec
+    return (uint64_t)ev->input_event_sec * 1000000000ULL
+           + (uint64_t)ev->input_event_usec * 1000ULL;
+#else
+    return (uint64_t)ev->time.tv_sec * 1000000000ULL
+           + (uint64_t)ev->time.tv_usec * 1000ULL;
+#endif
+}
+
+
+// * Scale an absolute axis value to the screen.
+// * @param: *dev : the device that sent the value.
+// * @param: axis : 0 for x, 1 for y.
+// * @param: value: the raw value.
+// * @param: size : size of the screen along the axis.
+// * @return: the screen coordinate, not clamped.
+static int input_scale(INPUT_DEV_t* dev, int axis, int value, uint_t size)
+{
+    if (dev->abs_max[axis] <= dev->abs_min[axis])
+        return value;
+
+    return (int)((int64_t)(value - dev->abs_min[axis]) * ((int)size - 1)
+                 / (dev->abs_max[axis] - dev->abs_min[axis]));
+}
+
+
+// * Apply an event to the pointer state.
+// * @param: *in : the input.
+// * @param: *dev: the device that sent the event.
+// * @param: *ev : the event.
+// * @param: t   : time of the event on CLOCK_MONOTONIC (ns).
+// * @return: 1 if a report changed the pointer, 0 otherwise.
+static int input_event(INPUT_t* in, INPUT_DEV_t* dev,
+                       const struct input_event* ev, uint64_t t)
+{
+    uint_t bit;
+    int    changed;
+
+    in->events++;
+    if (!in->frame_pending)
+        in->frame_pending = t;
+
+    switch (ev->type)
+    {
+        case EV_REL:
+            if (ev->code == REL_X)
+                in->new_x += ev->value;
+
+            else if (ev->code == REL_Y)
+                in->new_y += ev->value;
+
+            break;
+
+        case EV_ABS:
+            if (ev->code == ABS_X || ev->code == ABS_MT_POSITION_X)
+                in->new_x = input_scale(dev, 0, ev->value, in->xres);
+
+            else if (ev->code == ABS_Y || ev->code == ABS_MT_POSITION_Y)
+                in->new_y = input_scale(dev, 1, ev->value, in->yres);
+
+            break;
+
+        case EV_KEY:
+            bit = ev->code == BTN_LEFT ? INPUT_BUTTON_LEFT :
+                  ev->code == BTN_RIGHT ? INPUT_BUTTON_RIGHT :
+                  ev->code == BTN_TOUCH ? INPUT_BUTTON_TOUCH : 0;
+            if (ev->value)
+                in->new_buttons |= bit;
+
+            else
+                in->new_buttons &= ~bit;
+
+            break;
+
+        case EV_SYN:
+            if (ev->code != SYN_REPORT)
+                break;
+
+            // The packet is complete, commit it.
+            in->new_x = in->new_x < 0 ? 0 : in->new_x;
+            in->new_y = in->new_y < 0 ? 0 : in->new_y;
+            if (in->new_x >= (int)in->xres)
+                in->new_x = in->xres - 1;
+
+            if (in->new_y >= (int)in->yres)
+                in->new_y = in->yres - 1;
+
+            changed = in->new_x != in->x || in->new_y != in->y
+                      || in->new_buttons != in->buttons;
+            in->x = in->new_x;
+            in->y = in->new_y;
+            in->buttons = in->new_buttons;
+            if (changed && !in->pending)
+                in->pending = in->frame_pending;
+
+            in->frame_pending = 0;
+            return changed;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+
+// * Reset the pointer state of an input.
+// * @param: *in: the structure to initialize.
+// * @param: *fb: the framebuffer, its size bounds the pointer.
+static void input_reset(INPUT_t* in, FRAMEBUFFER_t* fb)
+{
+    memset(in, 0, sizeof(INPUT_t));
+    in->replay_fd = -1;
+    in->replay_dev.fd = -1;
+    in->xres = fb->vinfo.xres;
+    in->yres = fb->vinfo.yres;
+    in->x = in->xres / 2;
+    in->y = in->yres / 2;
+    in->new_x = in->x;
+    in->new_y = in->y;
+    return;
+}
+
+
+// * Open every pointer device (relative or absolute axes) in non-blocking
+// * mode, their timestamps are switched to CLOCK_MONOTONIC.
+// * @param: *in: the structure to initialize.
+// * @param: *fb: the framebuffer, its size bounds the pointer.
+// * @return: 1 if no device can be used, 0 otherwise.
+int input_open(INPUT_t* in, FRAMEBUFFER_t* fb)
+{
+    struct input_absinfo abs;
+    INPUT_DEV_t*         dev;
+    unsigned long        types;
+    char                 path[32];
+    uint_t               i;
+    int                  clk;
+    int                  fd;
+
+    input_reset(in, fb);
+    for (i = 0; i < INPUT_SCAN_DEVICES && in->ndevs < INPUT_MAX_DEVICES; i++)
+    {
+        snprintf(path, sizeof(path), INPUT_DEV_PATH, i);
+        fd = open(path, O_RDONLY | O_NONBLOCK);
+        if (fd < 0)
+            continue;
+
+        // Keyboards and buttons have no axis, they are skipped.
+        types = 0;
+        if (ioctl(fd, EVIOCGBIT(0, sizeof(types)), &types) < 0
+            || !(types & ((1UL << EV_REL) | (1UL << EV_ABS))))
+        {
+            close(fd);
+            continue;
+        }
+
+        dev = &in->devs[in->ndevs++];
+        memset(dev, 0, sizeof(INPUT_DEV_t));
+        dev->fd = fd;
+        clk = CLOCK_MONOTONIC;
+        dev->mono = !ioctl(fd, EVIOCSCLOCKID, &clk);
+
+        if (!ioctl(fd, EVIOCGABS(ABS_X), &abs)
+            || !ioctl(fd, EVIOCGABS(ABS_MT_POSITION_X), &abs))
+        {
+            dev->abs_min[0] = abs.minimum;
+            dev->abs_max[0] = abs.maximum;
+        }
+
+        if (!ioctl(fd, EVIOCGABS(ABS_Y), &abs)
+            || !ioctl(fd, EVIOCGABS(ABS_MT_POSITION_Y), &abs))
+        {
+            dev->abs_min[1] = abs.minimum;
+            dev->abs_max[1] = abs.maximum;
+        }
+    }
+
+    if (!in->ndevs)
+    {
+        printf("\x1b[1;31m~[ERROR] No pointer device found.\x1b[0m\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// * Decode a record of a replay file, the file is little endian like the
+// * targets and the hosts.
+// * @param: *p : the record.
+// * @param: rec: INPUT_REC_32 or INPUT_REC_64.
+// * @param: *ev: filled with the type, code and value of the event.
+// * @return: the timestamp of the event in ns.
+static uint64_t input_rec_decode(const uint8_t* p, uint_t rec,
+                                 struct input_event* ev)
+{
+    uint64_t sec;
+    uint64_t usec;
+    uint32_t sec32;
+    uint32_t usec32;
+
+    if (rec == INPUT_REC_64)
+    {
+        memcpy(&sec, p, 8);
+        memcpy(&usec, p + 8, 8);
+        p += 16;
+    }
+
+    else
+    {
+        memcpy(&sec32, p, 4);
+        memcpy(&usec32, p + 4, 4);
+        sec = sec32;
+        usec = usec32;
+        p += 8;
+    }
+
+    memcpy(&ev->type, p, 2);
+    memcpy(&ev->code, p + 2, 2);
+    memcpy(&ev->value, p + 4, 4);
+    return sec * 1000000000ULL + usec * 1000ULL;
+}
+
+
+// * Tell the record size of a replay file from its size, and from its first
+// * records when the size is a multiple of both. A 64 bits record has the
+// * high halves of sec and usec null and usec below one second, which a
+// * 32 bits record almost never matches.
+// * @param: fd  : the replay file.
+// * @param: size: size of the file in bytes.
+// * @return: INPUT_REC_32 or INPUT_REC_64, 0 if the size fits neither.
+static uint_t input_replay_format(int fd, off_t size)
+{
+    uint8_t  p[INPUT_REC_64];
+    uint32_t sec_hi;
+    uint64_t usec;
+    uint16_t type;
+    uint_t   i;
+
+    if (!size || (size % INPUT_REC_32 && size % INPUT_REC_64))
+        return 0;
+
+    if (size % INPUT_REC_64)
+        return INPUT_REC_32;
+
+    if (size % INPUT_REC_32)
+        return INPUT_REC_64;
+
+    for (i = 0; i < INPUT_REC_PROBE && (off_t)(i + 1) * INPUT_REC_64 <= size;
+         i++)
+    {
+        if (pread(fd, p, INPUT_REC_64, (off_t)i * INPUT_REC_64)
+            != INPUT_REC_64)
+            return 0;
+
+        memcpy(&sec_hi, p + 4, 4);
+        memcpy(&usec, p + 8, 8);
+        memcpy(&type, p + 16, 2);
+        if (sec_hi || usec >= 1000000 || type > EV_MAX)
+            return INPUT_REC_32;
+    }
+
+    return INPUT_REC_64;
+}
+
+
+// * Use a recorded event file instead of the devices. Absolute coordinates
+// * are taken as screen coordinates unless a range is set. A file whose size
+// * is not a whole number of records is rejected.
+// * @param: *in  : the structure to initialize.
+// * @param: *fb  : the framebuffer, its size bounds the pointer.
+// * @param: *path: path of the recorded events.
+// * @return: 1 in case of an error, 0 otherwise.
+int input_open_replay(INPUT_t* in, FRAMEBUFFER_t* fb, const char* path)
+{
+    struct stat st;
+
+    input_reset(in, fb);
+    in->replay_fd = open(path, O_RDONLY);
+    if (in->replay_fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening replay %s failed.\x1b[0m\n", path);
+        return 1;
+    }
+
+    if (!fstat(in->replay_fd, &st))
+        in->replay_rec = input_replay_format(in->replay_fd, st.st_size);
+
+    if (!in->replay_rec)
+    {
+        printf("\x1b[1;31m~[ERROR] %s is not an input event recording."
+               "\x1b[0m\n", path);
+        input_close(in);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// * Set the range of the absolute axes of a replay file.
+// * @param: *in : the input.
+// * @param: xmin: value of the left border.
+// * @param: xmax: value of the right border.
+// * @param: ymin: value of the top border.
+// * @param: ymax: value of the bottom border.
+void input_set_abs_range(INPUT_t* in, int xmin, int xmax, int ymin,
+                         int ymax)
+{
+    in->replay_dev.abs_min[0] = xmin;
+    in->replay_dev.abs_max[0] = xmax;
+    in->replay_dev.abs_min[1] = ymin;
+    in->replay_dev.abs_max[1] = ymax;
+    return;
+}
+
+
+// * Close the devices or the replay file.
+// * @param: *in: the input to close.
+void input_close(INPUT_t* in)
+{
+    uint_t i;
+
+    for (i = 0; i < in->ndevs; i++)
+        close(in->devs[i].fd);
+
+    in->ndevs = 0;
+    if (in->replay_fd >= 0)
+    {
+        close(in->replay_fd);
+        in->replay_fd = -1;
+    }
+
+    return;
+}
+
+
+// * Release the events of the replay file whose time has come, the file
+// * timestamps are only used relative to the first event.
+// * @param: *in: the input.
+// * @return: 1 if the pointer moved or a button changed, 0 otherwise.
+static int input_poll_replay(INPUT_t* in)
+{
+    uint8_t  rec[INPUT_REC_64];
+    uint64_t now;
+    uint64_t t;
+    int      changed;
+
+    changed = 0;
+    now = input_now();
+    while (1)
+    {
+        if (!in->replay_has_ev)
+        {
+            if (read(in->replay_fd, rec, in->replay_rec)
+                != (ssize_t)in->replay_rec)
+                break;
+
+            in->replay_time = input_rec_decode(rec, in->replay_rec,
+                                               &in->replay_ev);
+            in->replay_has_ev = 1;
+            if (!in->replay_start)
+            {
+                in->replay_start = now;
+                in->replay_base = in->replay_time;
+            }
+        }
+
+        t = in->replay_start + (in->replay_time - in->replay_base);
+        if (t > now)
+            break;
+
+        changed |= input_event(in, &in->replay_dev, &in->replay_ev, t);
+        in->replay_has_ev = 0;
+    }
+
+    return changed;
+}
+
+
+// * Read every event available without blocking and update the pointer on
+// * each SYN_REPORT.
+// * @param: *in: the input.
+// * @return: 1 if the pointer moved or a button changed, 0 otherwise.
+int input_poll(INPUT_t* in)
+{
+    struct input_event evs[INPUT_BATCH];
+    INPUT_DEV_t*       dev;
+    uint64_t           now;
+    ssize_t            n;
+    ssize_t            j;
+    uint_t             i;
+    int                changed;
+
+    if (in->replay_fd >= 0)
+        return input_poll_replay(in);
+
+    changed = 0;
+    now = input_now();
+    for (i = 0; i < in->ndevs; i++)
+    {
+        dev = &in->devs[i];
+        while ((n = read(dev->fd, evs, sizeof(evs))) > 0)
+        {
+            n /= sizeof(struct input_event);
+            for (j = 0; j < n; j++)
+                changed |= input_event(in, dev, &evs[j],
+                                       dev->mono ? input_ev_time(&evs[j])
+                                                 : now);
+
+            if (n < INPUT_BATCH)
+                break;
+        }
+    }
+
+    return changed;
+}
+
+
+// * Record the latency of the pending events, to call right after the frame
+// * showing them has been flushed to the screen.
+// * @param: *in: the input.
+void input_presented(INPUT_t* in)
+{
+    uint64_t now;
+    uint64_t lat;
+
+    if (!in->pending)
+        return;
+
+    now = input_now();
+    lat = now > in->pending ? now - in->pending : 0;
+    in->latency_count++;
+    in->latency_total_ns += lat;
+    if (lat > in->latency_max_ns)
+        in->latency_max_ns = lat;
+
+    in->pending = 0;
+    return;
+}
+
+
+// * Print the input-to-photon latency statistics.
+// * @param: *in : the input.
+// * @param: *out: the stream where the statistics are written.
+void input_dump_latency(INPUT_t* in, FILE* out)
+{
+    fprintf(out, "~input: %lu events, %lu updates shown, latency avg %llu us,"
+            " max %llu us\n", in->events, in->latency_count,
+            (unsigned long long)(in->latency_count ?
+                in->latency_total_ns / in->latency_count / 1000 : 0),
+            (unsigned long long)(in->latency_max_ns / 1000));
+    return;
+}
+
+
+// * Initialize a cursor and its save-under buffer.
+// * @param: *cur  : the structure to initialize.
+// * @param: *pix  : w * h pixels of the sprite, NULL for the default arrow.
+// * @param: w     : width of the sprite.
+// * @param: h     : height of the sprite.
+// * @param: key   : transparent color of the sprite.
+// * @param: hot_x : x coordinate of the pointing pixel in the sprite.
+// * @param: hot_y : y coordinate of the pointing pixel in the sprite.
+// * @return: 1 in case of an error, 0 otherwise.
+int cursor_init(CURSOR_t* cur, const COLOR_t* pix, uint_t w, uint_t h,
+                COLOR_t key, int hot_x, int hot_y)
+{
+    uint_t x;
+    uint_t y;
+
+    memset(cur, 0, sizeof(CURSOR_t));
+    if (!pix)
+    {
+        w = ARROW_W;
+        h = ARROW_H;
+        key = ARROW_KEY;
+        hot_x = 0;
+        hot_y = 0;
+    }
+
+    cur->sprite = malloc(sizeof(COLOR_t) * w * h);
+    cur->save = malloc(sizeof(COLOR_t) * w * h);
+    if (!cur->sprite || !cur->save)
+    {
+        cursor_free(cur);
+        return 1;
+    }
+
+    cur->w = w;
+    cur->h = h;
+    cur->key = key;
+    cur->hot_x = hot_x;
+    cur->hot_y = hot_y;
+    if (pix)
+    {
+        memcpy(cur->sprite, pix, sizeof(COLOR_t) * w * h);
+        return 0;
+    }
+
+    for (y = 0; y < h; y++)
+        for (x = 0; x < w; x++)
+            cur->sprite[y * w + x] = ARROW[y][x] == 'X' ? BLACK :
+                                     ARROW[y][x] == '.' ? WHITE : ARROW_KEY;
+
+    return 0;
+}
+
+
+// * Free the buffers of the cursor.
+// * @param: *cur: the cursor to free.
+void cursor_free(CURSOR_t* cur)
+{
+    free(cur->sprite);
+    free(cur->save);
+    cur->sprite = NULL;
+    cur->save = NULL;
+    cur->drawn = 0;
+    return;
+}
+
+
+// * Draw the cursor pointing at x, y after saving the pixels under it.
+// * @param: *fb : the framebuffer where the cursor is drawn.
+// * @param: *cur: the cursor.
+// * @param: x   : x coordinate of the pointed pixel.
+// * @param: y   : y coordinate of the pointed pixel.
+void cursor_show(FRAMEBUFFER_t* fb, CURSOR_t* cur, int x, int y)
+{
+    const COLOR_t* src;
+    COLOR_t*       dst;
+    int            x0;
+    int            y0;
+    int            x1;
+    int            y1;
+    uint_t         i;
+    uint_t         j;
+
+    if (cur->drawn)
+        cursor_hide(fb, cur);
+
+    // Clip the sprite once against the screen.
+    x -= cur->hot_x;
+    y -= cur->hot_y;
+    x0 = x < 0 ? 0 : x;
+    y0 = y < 0 ? 0 : y;
+    x1 = x + (int)cur->w > (int)fb->vinfo.xres ? (int)fb->vinfo.xres
+                                               : x + (int)cur->w;
+    y1 = y + (int)cur->h > (int)fb->vinfo.yres ? (int)fb->vinfo.yres
+                                               : y + (int)cur->h;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    cur->save_x = x0;
+    cur->save_y = y0;
+    cur->save_w = x1 - x0;
+    cur->save_h = y1 - y0;
+    for (i = 0; i < cur->save_h; i++)
+    {
+        dst = fb->screen + (y0 + i) * fb->vinfo.xres + x0;
+        src = cur->sprite + (y0 - y + i) * cur->w + (x0 - x);
+        memcpy(cur->save + i * cur->save_w, dst,
+               sizeof(COLOR_t) * cur->save_w);
+
+        for (j = 0; j < cur->save_w; j++)
+            if (src[j] != cur->key)
+                dst[j] = src[j];
+    }
+
+    cur->drawn = 1;
+    return;
+}
+
+
+// * Restore the pixels under the cursor.
+// * @param: *fb : the framebuffer where the cursor is drawn.
+// * @param: *cur: the cursor.
+void cursor_hide(FRAMEBUFFER_t* fb, CURSOR_t* cur)
+{
+    uint_t i;
+
+    if (!cur->drawn)
+        return;
+
+    for (i = 0; i < cur->save_h; i++)
+        memcpy(fb->screen + (cur->save_y + i) * fb->vinfo.xres + cur->save_x,
+               cur->save + i * cur->save_w, sizeof(COLOR_t) * cur->save_w);
+
+    cur->drawn = 0;
+    return;
+}
+
+
+// * Move the cursor, only the old and the new rectangles are written.
+// * @param: *fb : the framebuffer where the cursor is drawn.
+// * @param: *cur: the cursor.
+// * @param: x   : x coordinate of the pointed pixel.
+// * @param: y   : y coordinate of the pointed pixel.
+void cursor_move(FRAMEBUFFER_t* fb, CURSOR_t* cur, int x, int y)
+{
+    cursor_hide(fb, cur);
+    cursor_show(fb, cur, x, y);
+    return;
+}
@@ -0,0 +1,241 @@
+#include "points.h"
+
+
+// * Tell whether every point of an array is on the screen.
+// * @param: *fb : the framebuffer.
+// * @param: *pts: the points.
+// * @param: n   : number of points.
+// * @return: 1 if no point needs to be clipped, 0 otherwise.
+static int points_inside(FRAMEBUFFER_t* fb, const POINT_t* pts, uint_t n)
+{
+    int    xmin;
+    int    xmax;
+    int    ymin;
+    int    ymax;
+    uint_t i;
+
+    if (!n)
+        return 1;
+
+    xmin = xmax = pts[0].x;
+    ymin = ymax = pts[0].y;
+    for (i = 1; i < n; i++)
+    {
+        xmin = pts[i].x < xmin ? pts[i].x : xmin;
+        xmax = pts[i].x > xmax ? pts[i].x : xmax;
+        ymin = pts[i].y < ymin ? pts[i].y : ymin;
+        ymax = pts[i].y > ymax ? pts[i].y : ymax;
+    }
+
+    return xmin >= 0 && ymin >= 0 && (uint_t)xmax < fb->vinfo.xres
+           && (uint_t)ymax < fb->vinfo.yres;
+}
+
+
+// * Draw points of the same color. The bounds of the whole array are checked
+// * first, the points are not checked one by one when it is on the screen.
+// * @param: *fb   : FRAMEBUFFER_t where the points are drawn.
+// * @param: *pts  : the points.
+// * @param: n     : number of points.
+// * @param: color : color of the points.
+// * @return: the number of points drawn.
+uint_t draw_points(FRAMEBUFFER_t* fb, const POINT_t* pts, uint_t n,
+                   COLOR_t color)
+{
+    COLOR_t* screen;
+    uint_t   stride;
+    uint_t   drawn;
+    uint_t   i;
+
+    screen = fb->screen;
+    stride = fb->vinfo.xres;
+    if (points_inside(fb, pts, n))
+    {
+        for (i = 0; i < n; i++)
+            screen[pts[i].y * stride + pts[i].x] = color;
+
+        return n;
+    }
+
+    // A negative coordinate is a huge unsigned one, one compare clips it.
+    drawn = 0;
+    for (i = 0; i < n; i++)
+    {
+        if ((uint_t)pts[i].x >= stride || (uint_t)pts[i].y >= fb->vinfo.yres)
+            continue;
+
+        screen[pts[i].y * stride + pts[i].x] = color;
+        drawn++;
+    }
+
+    return drawn;
+}
+
+
+// * Draw points with a color each. The bounds of the whole array are checked
+// * first, the points are not checked one by one when it is on the screen.
+// * @param: *fb    : FRAMEBUFFER_t where the points are drawn.
+// * @param: *pts   : the points.
+// * @param: *colors: color of each point.
+// * @param: n      : number of points.
+// * @return: the number of points drawn.
+uint_t draw_points_colors(FRAMEBUFFER_t* fb, const POINT_t* pts,
+                          const COLOR_t* colors, uint_t n)
+{
+    COLOR_t* screen;
+    uint_t   stride;
+    uint_t   drawn;
+    uint_t   i;
+
+    screen = fb->screen;
+    stride = fb->vinfo.xres;
+    if (points_inside(fb, pts, n))
+    {
+        for (i = 0; i < n; i++)
+            screen[pts[i].y * stride + pts[i].x] = colors[i];
+
+        return n;
+    }
+
+    drawn = 0;
+    for (i = 0; i < n; i++)
+    {
+        if ((uint_t)pts[i].x >= stride || (uint_t)pts[i].y >= fb->vinfo.yres)
+            continue;
+
+        screen[pts[i].y * stride + pts[i].x] = colors[i];
+        drawn++;
+    }
+
+    return drawn;
+}
+
+
+// * Initialize the scratch memory to draw points row by row.
+// * @param: *sort   : the structure to initialize.
+// * @param: *fb     : FRAMEBUFFER_t where the points will be drawn.
+// * @param: capacity: most points sorted at once.
+// * @return: 1 in case of an error, 0 otherwise.
+int point_sort_init(POINT_SORT_t* sort, FRAMEBUFFER_t* fb, uint_t capacity)
+{
+    memset(sort, 0, sizeof(POINT_SORT_t));
+    if (!capacity)
+        return 1;
+
+    sort->nrows = fb->vinfo.yres;
+    sort->capacity = capacity;
+    sort->rows = malloc(sizeof(uint_t) * (sort->nrows + 1));
+    sort->offsets = malloc(sizeof(uint32_t) * capacity);
+    sort->colors = malloc(sizeof(COLOR_t) * capacity);
+    if (!sort->rows || !sort->offsets || !sort->colors)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the point sort failed."
+               "\x1b[0m\n");
+        point_sort_free(sort);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// * Free the scratch memory of the sort.
+// * @param: *sort: the structure to free.
+void point_sort_free(POINT_SORT_t* sort)
+{
+    free(sort->rows);
+    free(sort->offsets);
+    free(sort->colors);
+    sort->rows = NULL;
+    sort->offsets = NULL;
+    sort->colors = NULL;
+    sort->capacity = 0;
+    return;
+}
+
+
+// * Sort a chunk of points by row with a counting sort, and write them.
+// * @param: *sort  : the scratch memory of the sort.
+// * @param: *fb    : the framebuffer.
+// * @param: *pts   : the points, at most capacity.
+// * @param: *colors: color of each point, NULL to use color.
+// * @param: n      : number of points.
+// * @param: color  : color of the points when colors is NULL.
+// * @return: the number of points drawn.
+static uint_t points_sort_chunk(POINT_SORT_t* sort, FRAMEBUFFER_t* fb,
+                                const POINT_t* pts, const COLOR_t* colors,
+                                uint_t n, COLOR_t color)
+{
+    COLOR_t* screen;
+    uint_t   stride;
+    uint_t   nrows;
+    uint_t   total;
+    uint_t   count;
+    uint_t   i;
+    uint_t   k;
+
+    stride = fb->vinfo.xres;
+    nrows = fb->vinfo.yres < sort->nrows ? fb->vinfo.yres : sort->nrows;
+    memset(sort->rows, 0, sizeof(uint_t) * (nrows + 1));
+    for (i = 0; i < n; i++)
+        if ((uint_t)pts[i].x < stride && (uint_t)pts[i].y < nrows)
+            sort->rows[pts[i].y + 1]++;
+
+    // rows[y] becomes the first slot of the row y.
+    total = 0;
+    for (i = 1; i <= nrows; i++)
+    {
+        count = sort->rows[i];
+        sort->rows[i] = total;
+        total += count;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if ((uint_t)pts[i].x >= stride || (uint_t)pts[i].y >= nrows)
+            continue;
+
+        k = sort->rows[pts[i].y + 1]++;
+        sort->offsets[k] = pts[i].y * stride + pts[i].x;
+        sort->colors[k] = colors ? colors[i] : color;
+    }
+
+    screen = fb->screen;
+    for (k = 0; k < total; k++)
+        screen[sort->offsets[k]] = sort->colors[k];
+
+    return total;
+}
+
+
+// * Draw points sorted by row, so the screen is written from top to bottom
+// * whatever the order of the points. Worth it for large batches in random
+// * order on a framebuffer that is slow to access out of order, in cached
+// * memory the sort costs more than it saves. The order of points on the
+// * same pixel is kept.
+// * @param: *sort  : the scratch memory of the sort.
+// * @param: *fb    : FRAMEBUFFER_t where the points are drawn.
+// * @param: *pts   : the points.
+// * @param: *colors: color of each point, NULL to use color.
+// * @param: n      : number of points.
+// * @param: color  : color of the points when colors is NULL.
+// * @return: the number of points drawn.
+uint_t draw_points_sorted(POINT_SORT_t* sort, FRAMEBUFFER_t* fb,
+                          const POINT_t* pts, const COLOR_t* colors,
+                          uint_t n, COLOR_t color)
+{
+    uint_t drawn;
+    uint_t chunk;
+    uint_t i;
+
+    drawn = 0;
+    for (i = 0; i < n; i += chunk)
+    {
+        chunk = n - i > sort->capacity ? sort->capacity : n - i;
+        drawn += points_sort_chunk(sort, fb, pts + i, colors ? colors + i
+                                                             : NULL,
+                                   chunk, color);
+    }
+
+    return drawn;
+}
@@ -0,0 +1,441 @@
+#include "psf_font.h"
+
+
+// * Decode a UTF-8 sequence without reading past end.
+// * @param: **p : the bytes, moved after the decoded sequence.
+// * @param: *end: end of the readable bytes.
+// * @return: the code point, UTF8_REPLACEMENT for an invalid sequence.
+static uint32_t utf8_next(const uint8_t** p, const uint8_t* end)
+{
+    const uint8_t* s;
+    uint32_t       cp;
+    uint_t         n;
+    uint_t         i;
+
+    s = *p;
+    if (*s < 0x80)
+    {
+        *p = s + 1;
+        return *s;
+    }
+
+    else if ((*s & 0xE0) == 0xC0)
+    {
+        n = 1;
+        cp = *s & 0x1F;
+    }
+
+    else if ((*s & 0xF0) == 0xE0)
+    {
+        n = 2;
+        cp = *s & 0x0F;
+    }
+
+    else if ((*s & 0xF8) == 0xF0)
+    {
+        n = 3;
+        cp = *s & 0x07;
+    }
+
+    else
+    {
+        *p = s + 1;
+        return UTF8_REPLACEMENT;
+    }
+
+    // A truncated sequence only consumes its valid bytes.
+    s++;
+    for (i = 0; i < n; i++)
+    {
+        if (s >= end || (*s & 0xC0) != 0x80)
+        {
+            *p = s;
+            return UTF8_REPLACEMENT;
+        }
+
+        cp = (cp << 6) | (*s & 0x3F);
+        s++;
+    }
+
+    *p = s;
+
+    // Reject overlong encodings, surrogates and out of range values.
+    if ((n == 1 && cp < 0x80) || (n == 2 && cp < 0x800)
+        || (n == 3 && cp < 0x10000) || cp > 0x10FFFF
+        || (cp >= 0xD800 && cp <= 0xDFFF))
+        return UTF8_REPLACEMENT;
+
+    return cp;
+}
+
+
+// * Compare two map entries by code point, for qsort.
+// * @param: *a: the first entry.
+// * @param: *b: the second entry.
+// * @return: the order of the entries.
+static int psf_map_cmp(const void* a, const void* b)
+{
+    const PSF_MAP_t* ma;
+    const PSF_MAP_t* mb;
+
+    ma = (const PSF_MAP_t*)a;
+    mb = (const PSF_MAP_t*)b;
+    if (ma->cp != mb->cp)
+        return ma->cp < mb->cp ? -1 : 1;
+
+    return ma->glyph < mb->glyph ? -1 : ma->glyph > mb->glyph;
+}
+
+
+// * Walk the unicode table of the font, storing code points below
+// * PSF_DIRECT_MAX in the direct table and the others in the map.
+// * @param: *font: the font, direct must be allocated.
+// * @param: *p   : start of the unicode table.
+// * @param: *end : end of the mapping.
+// * @param: fill : 0 to only count the map entries, 1 to store them.
+// * @return: the number of map entries.
+static uint_t psf_walk_table(PSF_FONT_t* font, const uint8_t* p,
+                             const uint8_t* end, int fill)
+{
+    uint32_t cp;
+    uint_t   glyph;
+    uint_t   n;
+
+    n = 0;
+    glyph = 0;
+    while (p < end && glyph < font->nglyphs)
+    {
+        if (*p == PSF2_SEPARATOR)
+        {
+            glyph++;
+            p++;
+            continue;
+        }
+
+        // Sequences of combining chars are not supported, skip them up to
+        // the end of the glyph entry.
+        if (*p == PSF2_STARTSEQ)
+        {
+            while (p < end && *p != PSF2_SEPARATOR)
+                p++;
+
+            continue;
+        }
+
+        cp = utf8_next(&p, end);
+        if (cp < PSF_DIRECT_MAX)
+        {
+            if (fill && font->direct[cp] == PSF_NO_GLYPH)
+                font->direct[cp] = glyph;
+        }
+
+        else
+        {
+            if (fill)
+            {
+                font->map[n].cp = cp;
+                font->map[n].glyph = glyph;
+            }
+
+            n++;
+        }
+    }
+
+    return n;
+}
+
+
+// * Build the code point index of the font.
+// * @param: *font: the font to index.
+// * @param: *hdr : header of the font.
+// * @return: 1 in case of an error, 0 otherwise.
+static int psf_index(PSF_FONT_t* font, const PSF2_HEADER_t* hdr)
+{
+    const uint8_t* table;
+    const uint8_t* end;
+    uint_t         i;
+
+    font->direct = malloc(sizeof(uint16_t) * PSF_DIRECT_MAX);
+    if (!font->direct)
+        return 1;
+
+    for (i = 0; i < PSF_DIRECT_MAX; i++)
+        font->direct[i] = PSF_NO_GLYPH;
+
+    // Without unicode table, the glyph index is the code point.
+    if (!(hdr->flags & PSF2_HAS_UNICODE))
+    {
+        for (i = 0; i < font->nglyphs && i < PSF_DIRECT_MAX; i++)
+            font->direct[i] = i;
+
+        return 0;
+    }
+
+    table = font->glyphs + font->nglyphs * font->charsize;
+    end = font->data + font->map_size;
+
+    // The second walk also fills the direct table, it is needed even when
+    // every code point of the font is below PSF_DIRECT_MAX.
+    font->nmap = psf_walk_table(font, table, end, 0);
+    if (font->nmap)
+    {
+        font->map = malloc(sizeof(PSF_MAP_t) * font->nmap);
+        if (!font->map)
+            return 1;
+    }
+
+    psf_walk_table(font, table, end, 1);
+    if (font->nmap)
+        qsort(font->map, font->nmap, sizeof(PSF_MAP_t), psf_map_cmp);
+
+    return 0;
+}
+
+
+// * Return the glyph mapped to a code point by the unicode table.
+// * @param: *font: the font where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: the glyph index, PSF_NO_GLYPH if the code point is not mapped.
+static uint_t psf_lookup(PSF_FONT_t* font, uint32_t cp)
+{
+    uint_t lo;
+    uint_t hi;
+    uint_t mid;
+
+    if (cp < PSF_DIRECT_MAX)
+        return font->direct[cp];
+
+    // Binary search of the first entry of the code point.
+    lo = 0;
+    hi = font->nmap;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (font->map[mid].cp < cp)
+            lo = mid + 1;
+
+        else
+            hi = mid;
+    }
+
+    if (lo < font->nmap && font->map[lo].cp == cp)
+        return font->map[lo].glyph;
+
+    return PSF_NO_GLYPH;
+}
+
+
+// * Map a PSF2 font file and index its unicode table.
+// * @param: *font: the structure to initialize.
+// * @param: *path: path of the uncompressed .psf font.
+// * @return: 1 in case of an error, 0 otherwise.
+int psf_load(PSF_FONT_t* font, const char* path)
+{
+    const PSF2_HEADER_t* hdr;
+    struct stat          st;
+    void*                addr;
+
+    memset(font, 0, sizeof(PSF_FONT_t));
+    font->fd = open(path, O_RDONLY);
+    if (font->fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening font %s failed.\x1b[0m\n", path);
+        return 1;
+    }
+
+    if (fstat(font->fd, &st) || (size_t)st.st_size < sizeof(PSF2_HEADER_t))
+    {
+        printf("\x1b[1;31m~[ERROR] Font %s is too small.\x1b[0m\n", path);
+        psf_free(font);
+        return 1;
+    }
+
+    addr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, font->fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        printf("\x1b[1;31m~[ERROR] Mapping font %s failed.\x1b[0m\n", path);
+        psf_free(font);
+        return 1;
+    }
+
+    font->data = (const uint8_t*)addr;
+    font->map_size = st.st_size;
+
+    // Check the header and that every glyph is inside the file.
+    hdr = (const PSF2_HEADER_t*)font->data;
+    font->nglyphs = hdr->length;
+    font->charsize = hdr->charsize;
+    font->width = hdr->width;
+    font->height = hdr->height;
+    font->row_bytes = (hdr->width + 7) / 8;
+    font->glyphs = font->data + hdr->headersize;
+
+    // The size is bounded before row_bytes is trusted, so it can not wrap.
+    if (hdr->magic != PSF2_MAGIC || hdr->headersize < sizeof(PSF2_HEADER_t)
+        || !hdr->length || !hdr->width || !hdr->height
+        || hdr->width > PSF_SIZE_MAX || hdr->height > PSF_SIZE_MAX
+        || hdr->charsize < (uint64_t)font->row_bytes * hdr->height
+        || hdr->headersize > font->map_size
+        || (font->map_size - hdr->headersize) / hdr->charsize < hdr->length)
+    {
+        printf("\x1b[1;31m~[ERROR] %s is not a PSF2 font.\x1b[0m\n", path);
+        psf_free(font);
+        return 1;
+    }
+
+    if (psf_index(font, hdr))
+    {
+        psf_free(font);
+        return 1;
+    }
+
+    // Glyph used for the code points that the font does not have.
+    font->fallback = psf_lookup(font, UTF8_REPLACEMENT);
+    if (font->fallback == PSF_NO_GLYPH)
+        font->fallback = psf_lookup(font, '?');
+
+    if (font->fallback == PSF_NO_GLYPH)
+        font->fallback = 0;
+
+    return 0;
+}
+
+
+// * Unmap the font and free its index.
+// * @param: *font: the font to free.
+void psf_free(PSF_FONT_t* font)
+{
+    if (font->data)
+    {
+        munmap((void*)font->data, font->map_size);
+        font->data = NULL;
+    }
+
+    if (font->fd >= 0)
+    {
+        close(font->fd);
+        font->fd = -1;
+    }
+
+    free(font->direct);
+    free(font->map);
+    font->direct = NULL;
+    font->map = NULL;
+    font->nmap = 0;
+    return;
+}
+
+
+// * Return the glyph index of a code point.
+// * @param: *font: the font where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: the glyph index, the replacement glyph if the font has none.
+uint_t psf_glyph_index(PSF_FONT_t* font, uint32_t cp)
+{
+    uint_t glyph;
+
+    glyph = psf_lookup(font, cp);
+    return glyph != PSF_NO_GLYPH ? glyph : font->fallback;
+}
+
+
+// * Tell whether the font has a glyph of its own for a code point.
+// * @param: *font: the font where the glyph is searched.
+// * @param: cp   : the unicode code point.
+// * @return: 1 if the code point is mapped, 0 if it would use the fallback.
+int psf_has_glyph(PSF_FONT_t* font, uint32_t cp)
+{
+    return psf_lookup(font, cp) != PSF_NO_GLYPH;
+}
+
+
+// * Decode the next UTF-8 code point of a string and advance the string.
+// * @param: **str: the string, moved after the decoded sequence.
+// * @return: the code point, UTF8_REPLACEMENT for an invalid sequence.
+uint32_t utf8_decode(const char** str)
+{
+    const uint8_t* p;
+    uint32_t       cp;
+
+    // The string is NUL terminated and a NUL byte is never a continuation
+    // byte, so the decoder can not read past it.
+    p = (const uint8_t*)*str;
+    cp = utf8_next(&p, p + 4);
+    *str = (const char*)p;
+    return cp;
+}
+
+
+// * Draw a unicode code point on the screen at position x, y.
+// * @param: *fb    : the framebuffer where the glyph is drawn.
+// * @param: *font  : the font to use.
+// * @param: cp     : the code point to draw.
+// * @param: x      : x position of the glyph.
+// * @param: y      : y position of the glyph.
+// * @param: fgcolor: color of the letter.
+// * @param: bgcolor: color of the background of the glyph.
+void psf_print_char(FRAMEBUFFER_t* fb, PSF_FONT_t* font, uint32_t cp,
+                    uint_t x, uint_t y, COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    const uint8_t* glyph;
+    COLOR_t*       dst;
+    uint_t         w;
+    uint_t         h;
+    uint_t         i;
+    uint_t         j;
+
+    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres)
+        return;
+
+    // Clip the glyph once so the rows need no bound check.
+    w = font->width;
+    h = font->height;
+    if (w > fb->vinfo.xres - x)
+        w = fb->vinfo.xres - x;
+
+    if (h > fb->vinfo.yres - y)
+        h = fb->vinfo.yres - y;
+
+    glyph = font->glyphs + psf_glyph_index(font, cp) * font->charsize;
+    dst = fb->screen + y * fb->vinfo.xres + x;
+
+    // PSF rows are padded to a byte, the highest bit is the leftmost pixel.
+    for (i = 0; i < h; i++)
+    {
+        for (j = 0; j < w; j++)
+            dst[j] = glyph[j >> 3] & (0x80 >> (j & 7)) ? fgcolor : bgcolor;
+
+        glyph += font->row_bytes;
+        dst += fb->vinfo.xres;
+    }
+
+    return;
+}
+
+
+// * Draw a UTF-8 string on a single line at position x, y.
+// * @param: *fb    : the framebuffer where the string is drawn.
+// * @param: *font  : the font to use.
+// * @param: *str   : the UTF-8 string to draw.
+// * @param: x      : x position of the first glyph.
+// * @param: y      : y position of the first glyph.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the glyphs.
+// * @return: the x position after the last glyph drawn.
+uint_t psf_print_utf8(FRAMEBUFFER_t* fb, PSF_FONT_t* font, const char* str,
+                      uint_t x, uint_t y, COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    uint32_t cp;
+
+    if (!str)
+        return x;
+
+    while (*str && x < fb->vinfo.xres)
+    {
+        cp = utf8_decode(&str);
+        psf_print_char(fb, font, cp, x, y, fgcolor, bgcolor);
+        x += font->width;
+    }
+
+    return x;
+}
@@ -0,0 +1,340 @@
+#include "rle_sprite.h"
+
+
+// * Count the pixels equal to p[x] from x.
+// * @param: *p  : the pixels of the row.
+// * @param: x   : start of the run.
+// * @param: w   : width of the row.
+// * @param: max : the count stops at max.
+// * @return: the length of the run.
+static uint_t rle_run(const COLOR_t* p, uint_t x, uint_t w, uint_t max)
+{
+    uint_t n;
+
+    n = 1;
+    while (x + n < w && p[x + n] == p[x] && n < max)
+        n++;
+
+    return n;
+}
+
+
+// * Encode a row of pixels.
+// * @param: *p  : the pixels of the row.
+// * @param: w   : width of the row.
+// * @param: key : transparent color.
+// * @param: *out: where the ops are written.
+// * @return: the number of words written.
+static uint_t rle_encode_row(const COLOR_t* p, uint_t w, COLOR_t key,
+                             uint16_t* out)
+{
+    uint_t x;
+    uint_t n;
+    uint_t k;
+
+    k = 0;
+    x = 0;
+    while (x < w)
+    {
+        n = rle_run(p, x, w, RLE_COUNT_MASK);
+        if (p[x] == key)
+        {
+            out[k++] = RLE_SKIP | n;
+            x += n;
+            continue;
+        }
+
+        if (n >= RLE_MIN_SOLID)
+        {
+            out[k++] = RLE_SOLID | n;
+            out[k++] = p[x];
+            x += n;
+            continue;
+        }
+
+        // Literal up to the next transparent pixel or solid run.
+        n = 0;
+        while (x + n < w && p[x + n] != key && n < RLE_COUNT_MASK
+               && rle_run(p, x + n, w, RLE_MIN_SOLID) < RLE_MIN_SOLID)
+            n++;
+
+        // The solid run found above was shorter, so n is at least 1.
+        out[k++] = RLE_LITERAL | n;
+        memcpy(out + k, p + x, sizeof(COLOR_t) * n);
+        k += n;
+        x += n;
+    }
+
+    return k;
+}
+
+
+// * Encode pixels into a sprite, pixels of the key color are transparent.
+// * @param: *pix : w * h pixels.
+// * @param: w    : width of the picture.
+// * @param: h    : height of the picture.
+// * @param: key  : transparent color.
+// * @param: *size: filled with the size of the sprite in bytes.
+// * @return: the sprite data to free(), NULL in case of an error.
+uint8_t* rle_sprite_encode(const COLOR_t* pix, uint_t w, uint_t h,
+                           COLOR_t key, size_t* size)
+{
+    RLE_HEADER_t* hdr;
+    uint32_t*     rows;
+    uint16_t*     ops;
+    uint8_t*      data;
+    uint8_t*      tmp;
+    size_t        head;
+    uint_t        nwords;
+    uint_t        y;
+
+    if (!w || !h || w > 0xFFFF || h > 0xFFFF)
+        return NULL;
+
+    // At worst a row alternates one transparent and one opaque pixel, which
+    // is 3 words for 2 pixels.
+    head = sizeof(RLE_HEADER_t) + sizeof(uint32_t) * h;
+    data = malloc(head + sizeof(uint16_t) * (2 * (size_t)w + 1) * h);
+    if (!data)
+        return NULL;
+
+    hdr = (RLE_HEADER_t*)data;
+    rows = (uint32_t*)(data + sizeof(RLE_HEADER_t));
+    ops = (uint16_t*)(data + head);
+    nwords = 0;
+    for (y = 0; y < h; y++)
+    {
+        rows[y] = nwords;
+        nwords += rle_encode_row(pix + y * w, w, key, ops + nwords);
+    }
+
+    memset(hdr, 0, sizeof(RLE_HEADER_t));
+    hdr->magic = RLE_MAGIC;
+    hdr->version = RLE_VERSION;
+    hdr->key = key;
+    hdr->w = w;
+    hdr->h = h;
+    hdr->nwords = nwords;
+    *size = head + sizeof(uint16_t) * nwords;
+    tmp = realloc(data, *size);
+    return tmp ? tmp : data;
+}
+
+
+// * Check that the ops of a row cover exactly the width of the sprite.
+// * @param: *sprite: the sprite.
+// * @param: y      : the row.
+// * @return: 1 if the row is invalid, 0 otherwise.
+static int rle_check_row(RLE_SPRITE_t* sprite, uint_t y)
+{
+    uint32_t off;
+    uint32_t nwords;
+    uint_t   x;
+    uint_t   n;
+
+    nwords = sprite->hdr->nwords;
+    off = sprite->rows[y];
+    x = 0;
+    while (x < sprite->w)
+    {
+        if (off >= nwords)
+            return 1;
+
+        n = sprite->ops[off] & RLE_COUNT_MASK;
+        if (!n || x + n > sprite->w)
+            return 1;
+
+        switch (sprite->ops[off] & RLE_TYPE_MASK)
+        {
+            case RLE_SKIP:
+                off++;
+                break;
+
+            case RLE_SOLID:
+                off += 2;
+                break;
+
+            case RLE_LITERAL:
+                off += 1 + n;
+                break;
+
+            default:
+                return 1;
+        }
+
+        x += n;
+    }
+
+    return off > nwords;
+}
+
+
+// * Use sprite data already in memory, every row is checked once here so the
+// * blitter does not check the ops.
+// * @param: *sprite: the structure to initialize.
+// * @param: *data  : the sprite data, it must stay valid and 4 bytes aligned.
+// * @param: size   : size of the data in bytes.
+// * @return: 1 in case of an error, 0 otherwise.
+int rle_sprite_from_memory(RLE_SPRITE_t* sprite, const void* data,
+                           size_t size)
+{
+    const RLE_HEADER_t* hdr;
+    uint_t              y;
+
+    memset(sprite, 0, sizeof(RLE_SPRITE_t));
+    sprite->fd = -1;
+    hdr = (const RLE_HEADER_t*)data;
+    if (size < sizeof(RLE_HEADER_t) || ((uintptr_t)data & 3)
+        || hdr->magic != RLE_MAGIC || hdr->version != RLE_VERSION
+        || sizeof(RLE_HEADER_t) + sizeof(uint32_t) * (uint64_t)hdr->h
+           + sizeof(uint16_t) * (uint64_t)hdr->nwords > size)
+        return 1;
+
+    sprite->data = (const uint8_t*)data;
+    sprite->hdr = hdr;
+    sprite->rows = (const uint32_t*)(sprite->data + sizeof(RLE_HEADER_t));
+    sprite->ops = (const uint16_t*)(sprite->rows + hdr->h);
+    sprite->w = hdr->w;
+    sprite->h = hdr->h;
+    for (y = 0; y < sprite->h; y++)
+        if (rle_check_row(sprite, y))
+        {
+            memset(sprite, 0, sizeof(RLE_SPRITE_t));
+            sprite->fd = -1;
+            return 1;
+        }
+
+    return 0;
+}
+
+
+// * Map a sprite file produced by fbrle.
+// * @param: *sprite: the structure to initialize.
+// * @param: *path  : path of the sprite file.
+// * @return: 1 in case of an error, 0 otherwise.
+int rle_sprite_open(RLE_SPRITE_t* sprite, const char* path)
+{
+    struct stat st;
+    void*       addr;
+    int         fd;
+
+    memset(sprite, 0, sizeof(RLE_SPRITE_t));
+    sprite->fd = -1;
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening sprite %s failed.\x1b[0m\n", path);
+        return 1;
+    }
+
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(RLE_HEADER_t))
+    {
+        printf("\x1b[1;31m~[ERROR] Sprite %s is too small.\x1b[0m\n", path);
+        close(fd);
+        return 1;
+    }
+
+    addr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        printf("\x1b[1;31m~[ERROR] Mapping sprite %s failed.\x1b[0m\n", path);
+        close(fd);
+        return 1;
+    }
+
+    if (rle_sprite_from_memory(sprite, addr, st.st_size))
+    {
+        printf("\x1b[1;31m~[ERROR] %s is not a RLE sprite.\x1b[0m\n", path);
+        munmap(addr, st.st_size);
+        close(fd);
+        return 1;
+    }
+
+    sprite->fd = fd;
+    sprite->map_size = st.st_size;
+    return 0;
+}
+
+
+// * Unmap a sprite file, a sprite from memory is only forgotten.
+// * @param: *sprite: the sprite to close.
+void rle_sprite_close(RLE_SPRITE_t* sprite)
+{
+    if (sprite->fd >= 0)
+    {
+        munmap((void*)sprite->data, sprite->map_size);
+        close(sprite->fd);
+    }
+
+    memset(sprite, 0, sizeof(RLE_SPRITE_t));
+    sprite->fd = -1;
+    return;
+}
+
+
+// * Draw a sprite clipped to the screen. Transparent runs are skipped, solid
+// * runs are filled and literal runs are copied with memcpy.
+// * @param: *fb    : the framebuffer where the sprite is drawn.
+// * @param: *sprite: the sprite.
+// * @param: x      : x coordinate of the top-left corner, can be negative.
+// * @param: y      : y coordinate of the top-left corner, can be negative.
+void rle_sprite_draw(FRAMEBUFFER_t* fb, RLE_SPRITE_t* sprite, int x, int y)
+{
+    const uint16_t* op;
+    COLOR_t*        row;
+    COLOR_t         color;
+    int             xres;
+    int             i0;
+    int             i1;
+    int             sx;
+    int             a;
+    int             b;
+    int             i;
+    int             n;
+
+    xres = fb->vinfo.xres;
+    i0 = y < 0 ? -y : 0;
+    i1 = y + (int)sprite->h > (int)fb->vinfo.yres ? (int)fb->vinfo.yres - y
+                                                  : (int)sprite->h;
+    if (x >= xres || x + (int)sprite->w <= 0)
+        return;
+
+    for (i = i0; i < i1; i++)
+    {
+        op = sprite->ops + sprite->rows[i];
+        row = fb->screen + (y + i) * xres;
+        sx = x;
+        while (sx < x + (int)sprite->w && sx < xres)
+        {
+            n = *op & RLE_COUNT_MASK;
+            a = sx < 0 ? 0 : sx;
+            b = sx + n > xres ? xres : sx + n;
+            switch (*op & RLE_TYPE_MASK)
+            {
+                case RLE_SOLID:
+                    color = op[1];
+                    for (; a < b; a++)
+                        row[a] = color;
+
+                    op += 2;
+                    break;
+
+                case RLE_LITERAL:
+                    if (a < b)
+                        memcpy(row + a, op + 1 + (a - sx),
+                               sizeof(COLOR_t) * (b - a));
+
+                    op += 1 + n;
+                    break;
+
+                default:
+                    op++;
+                    break;
+            }
+
+            sx += n;
+        }
+    }
+
+    return;
+}
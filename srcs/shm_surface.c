@@ -0,0 +1,319 @@
+#include "shm_surface.h"
+
+
+// * Take the spin lock that guards the damage rectangle of the header. Used
+// * by the client, the compositor holds the lock for a few loads only.
+// * @param: *hdr: the header of the shared surface.
+static void shm_lock(SHM_HEADER_t* hdr)
+{
+    while (__atomic_exchange_n(&hdr->lock, 1, __ATOMIC_ACQUIRE))
+        ;
+}
+
+
+// * Try to take the spin lock of the header a bounded number of times. Used
+// * by the compositor, a client that died holding the lock or wrote it must
+// * not hang it.
+// * @param: *hdr: the header of the shared surface.
+// * @return: 1 if the lock is still held after SHM_LOCK_SPINS tries, 0 once
+// *          it is taken.
+static int shm_trylock(SHM_HEADER_t* hdr)
+{
+    uint_t i;
+
+    for (i = 0; i < SHM_LOCK_SPINS; i++)
+        if (!__atomic_exchange_n(&hdr->lock, 1, __ATOMIC_ACQUIRE))
+            return 0;
+
+    return 1;
+}
+
+
+// * Release the spin lock of the header.
+// * @param: *hdr: the header of the shared surface.
+static void shm_unlock(SHM_HEADER_t* hdr)
+{
+    __atomic_store_n(&hdr->lock, 0, __ATOMIC_RELEASE);
+}
+
+
+// * Map the shared memory object and fill the surface structure.
+// * @param: *surf: the surface structure, fd and map_size must be set.
+// * @return: 1 in case of an error, 0 otherwise.
+static int shm_surface_map(SHM_SURFACE_t* surf)
+{
+    void* addr;
+
+    addr = mmap(0, surf->map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                surf->fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        printf("\x1b[1;31m~[ERROR] Mapping surface %s failed.\x1b[0m\n",
+               surf->name);
+        return 1;
+    }
+
+    surf->hdr = (SHM_HEADER_t*)addr;
+    surf->buf = (COLOR_t*)(surf->hdr + 1);
+    return 0;
+}
+
+
+// * Create a named shared memory surface that a client can render into. It
+// * fails if the name is already in use, a stale name left by a crash must be
+// * removed with shm_unlink() first.
+// * @param: *surf: the structure to initialize.
+// * @param: *name: name of the shared memory object (ex: "/gauge0").
+// * @param: w    : width of the surface in pixels.
+// * @param: h    : height of the surface in pixels.
+// * @return: 1 in case of an error, 0 otherwise.
+int shm_surface_create(SHM_SURFACE_t* surf, const char* name,
+                       uint_t w, uint_t h)
+{
+    memset(surf, 0, sizeof(SHM_SURFACE_t));
+    strncpy(surf->name, name, SHM_SURFACE_NAME_MAX - 1);
+    surf->fd = -1;
+    surf->w = w;
+    surf->h = h;
+    if (!w || !h || w > (SIZE_MAX - sizeof(SHM_HEADER_t))
+                        / sizeof(COLOR_t) / h)
+    {
+        printf("\x1b[1;31m~[ERROR] Surface %s is too large.\x1b[0m\n", name);
+        return 1;
+    }
+
+    surf->map_size = sizeof(SHM_HEADER_t) + (size_t)w * h * sizeof(COLOR_t);
+
+    // A name in use belongs to a live surface, it is never truncated.
+    surf->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (surf->fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Creating surface %s failed: %s.\x1b[0m\n",
+               name, strerror(errno));
+        return 1;
+    }
+
+    surf->owner = 1;
+
+    if (ftruncate(surf->fd, surf->map_size) || shm_surface_map(surf))
+    {
+        shm_surface_close(surf);
+        return 1;
+    }
+
+    // Nothing has been drawn yet, start with an empty damage.
+    surf->hdr->w = w;
+    surf->hdr->h = h;
+    surf->hdr->lock = 0;
+    surf->hdr->dmg_x0 = w;
+    surf->hdr->dmg_y0 = h;
+    surf->hdr->dmg_x1 = 0;
+    surf->hdr->dmg_y1 = 0;
+    __atomic_store_n(&surf->hdr->magic, SHM_SURFACE_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+
+// * Open a shared memory surface previously created by a client.
+// * @param: *surf: the structure to initialize.
+// * @param: *name: name of the shared memory object.
+// * @return: 1 in case of an error, 0 otherwise.
+int shm_surface_open(SHM_SURFACE_t* surf, const char* name)
+{
+    struct stat st;
+
+    memset(surf, 0, sizeof(SHM_SURFACE_t));
+    strncpy(surf->name, name, SHM_SURFACE_NAME_MAX - 1);
+
+    surf->fd = shm_open(name, O_RDWR, 0600);
+    if (surf->fd < 0)
+    {
+        printf("\x1b[1;31m~[ERROR] Opening surface %s failed.\x1b[0m\n",
+               name);
+        return 1;
+    }
+
+    if (fstat(surf->fd, &st) || (size_t)st.st_size < sizeof(SHM_HEADER_t))
+    {
+        shm_surface_close(surf);
+        return 1;
+    }
+
+    surf->map_size = st.st_size;
+    if (shm_surface_map(surf))
+    {
+        shm_surface_close(surf);
+        return 1;
+    }
+
+    // Check that the header is valid and match the size of the mapping.
+    // The size is checked by division so a huge w * h cannot wrap.
+    surf->w = surf->hdr->w;
+    surf->h = surf->hdr->h;
+    if (__atomic_load_n(&surf->hdr->magic, __ATOMIC_ACQUIRE)
+            != SHM_SURFACE_MAGIC
+        || !surf->w || !surf->h
+        || surf->w > (surf->map_size - sizeof(SHM_HEADER_t))
+                     / sizeof(COLOR_t) / surf->h)
+    {
+        printf("\x1b[1;31m~[ERROR] Surface %s is invalid.\x1b[0m\n", name);
+        shm_surface_close(surf);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// * Unmap the surface and close it, the creator also unlink the name.
+// * @param: *surf: the surface to close.
+void shm_surface_close(SHM_SURFACE_t* surf)
+{
+    if (surf->hdr)
+    {
+        munmap(surf->hdr, surf->map_size);
+        surf->hdr = NULL;
+        surf->buf = NULL;
+    }
+
+    if (surf->fd >= 0)
+    {
+        close(surf->fd);
+        surf->fd = -1;
+    }
+
+    if (surf->owner)
+    {
+        shm_unlink(surf->name);
+        surf->owner = 0;
+    }
+
+    return;
+}
+
+
+// * Fill a FRAMEBUFFER_t over the shared pixels with surface_as_framebuffer,
+// * so the client renders with the usual drawing functions.
+// * @param: *surf: the surface to render into.
+// * @param: *fb  : the framebuffer structure to fill.
+void shm_surface_as_framebuffer(SHM_SURFACE_t* surf, FRAMEBUFFER_t* fb)
+{
+    SURFACE_t view;
+
+    surface_from_pixels(&view, surf->buf, surf->w, surf->h);
+    surface_as_framebuffer(&view, fb);
+    return;
+}
+
+
+// * Notify the compositor that an area of the surface has been redrawn.
+// * @param: *surf: the surface that has been modified.
+// * @param: x    : x coordinate of the top-left corner of the damage.
+// * @param: y    : y coordinate of the top-left corner of the damage.
+// * @param: w    : width of the damaged area.
+// * @param: h    : height of the damaged area.
+void shm_surface_damage(SHM_SURFACE_t* surf, uint_t x, uint_t y,
+                        uint_t w, uint_t h)
+{
+    SHM_HEADER_t* hdr;
+
+    hdr = surf->hdr;
+    if (x >= surf->w || y >= surf->h || !w || !h)
+        return;
+
+    if (w > surf->w - x)
+        w = surf->w - x;
+
+    if (h > surf->h - y)
+        h = surf->h - y;
+
+    // Merge the new area with the damage not yet composited.
+    shm_lock(hdr);
+    if (x < hdr->dmg_x0)
+        hdr->dmg_x0 = x;
+
+    if (y < hdr->dmg_y0)
+        hdr->dmg_y0 = y;
+
+    if (x + w > hdr->dmg_x1)
+        hdr->dmg_x1 = x + w;
+
+    if (y + h > hdr->dmg_y1)
+        hdr->dmg_y1 = y + h;
+
+    shm_unlock(hdr);
+    return;
+}
+
+
+// * Blit the damaged area of the surface directly from the shared mapping
+// * onto the screen and clear the damage. Nothing is drawn when the client
+// * keeps the lock of the header, the damage is then left for the next call.
+// * @param: *fb  : the framebuffer where the surface will be composited.
+// * @param: *surf: the surface to composite.
+// * @param: x    : x coordinate of the surface on the screen.
+// * @param: y    : y coordinate of the surface on the screen.
+// * @return: the number of pixels written, 0 if there was nothing to do.
+uint_t shm_surface_composite(FRAMEBUFFER_t* fb, SHM_SURFACE_t* surf,
+                             uint_t x, uint_t y)
+{
+    SHM_HEADER_t* hdr;
+    COLOR_t*      src;
+    COLOR_t*      dst;
+    uint_t        x0;
+    uint_t        y0;
+    uint_t        x1;
+    uint_t        y1;
+    uint_t        row;
+
+    hdr = surf->hdr;
+
+    // Take the damage and reset it so the client can keep drawing. A surface
+    // whose lock stays held is skipped, its damage is kept for the next
+    // frame.
+    if (shm_trylock(hdr))
+    {
+        surf->lock_skips++;
+        return 0;
+    }
+
+    x0 = hdr->dmg_x0;
+    y0 = hdr->dmg_y0;
+    x1 = hdr->dmg_x1;
+    y1 = hdr->dmg_y1;
+    hdr->dmg_x0 = surf->w;
+    hdr->dmg_y0 = surf->h;
+    hdr->dmg_x1 = 0;
+    hdr->dmg_y1 = 0;
+    shm_unlock(hdr);
+
+    // The header is writable by the client: the damage is not trusted and is
+    // clipped to the surface before the mapping is read.
+    x1 = x1 > surf->w ? surf->w : x1;
+    y1 = y1 > surf->h ? surf->h : y1;
+    if (x0 >= x1 || y0 >= y1)
+        return 0;
+
+    // Clip the damage against the screen.
+    if (x + x0 >= fb->vinfo.xres || y + y0 >= fb->vinfo.yres)
+        return 0;
+
+    if (x + x1 > fb->vinfo.xres)
+        x1 = fb->vinfo.xres - x;
+
+    if (y + y1 > fb->vinfo.yres)
+        y1 = fb->vinfo.yres - y;
+
+    // Copy each damaged row straight from the shared mapping.
+    src = surf->buf + y0 * surf->w + x0;
+    dst = fb->screen + (y + y0) * fb->vinfo.xres + x + x0;
+    for (row = y0; row < y1; row++)
+    {
+        memcpy(dst, src, (x1 - x0) * sizeof(COLOR_t));
+        src += surf->w;
+        dst += fb->vinfo.xres;
+    }
+
+    return (x1 - x0) * (y1 - y0);
+}
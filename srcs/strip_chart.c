@@ -0,0 +1,298 @@
+#include "strip_chart.h"
+
+
+// * Return the row of a value in the chart.
+// * @param: *chart: the chart.
+// * @param: v     : the value, clamped to the range of the chart.
+// * @return: the row relative to the top of the chart.
+static uint16_t strip_row(STRIP_CHART_t* chart, int v)
+{
+    v = v < chart->vmin ? chart->vmin : v > chart->vmax ? chart->vmax : v;
+    return (uint16_t)(((int64_t)(chart->vmax - v) * chart->scale) >> 16);
+}
+
+
+// * Draw a column of the chart, the trace between lo and hi and the
+// * background around it.
+// * @param: *chart : the chart.
+// * @param: *p     : top pixel of the column, on the screen or the shadow.
+// * @param: stride : pixels between two rows of p.
+// * @param: lo     : first row of the trace.
+// * @param: hi     : last row of the trace.
+static void strip_column(STRIP_CHART_t* chart, COLOR_t* p, uint_t stride,
+                         uint_t lo, uint_t hi)
+{
+    uint_t r;
+
+    for (r = 0; r < lo; r++, p += stride)
+        *p = chart->bgcolor;
+
+    for (; r <= hi; r++, p += stride)
+        *p = chart->fgcolor;
+
+    for (; r < chart->h; r++, p += stride)
+        *p = chart->bgcolor;
+
+    return;
+}
+
+
+// * Draw a column of the chart on the screen.
+// * @param: *chart: the chart.
+// * @param: sx    : x coordinate of the column relative to the chart.
+// * @param: lo    : first row of the trace.
+// * @param: hi    : last row of the trace.
+static void strip_column_screen(STRIP_CHART_t* chart, uint_t sx, uint_t lo,
+                                uint_t hi)
+{
+    uint_t stride;
+
+    stride = chart->fb->vinfo.xres;
+    strip_column(chart, chart->fb->screen + chart->y * stride + chart->x + sx,
+                 stride, lo, hi);
+    return;
+}
+
+
+// * Copy the shadow of a SCROLL chart to the screen, the oldest column
+// * (head) on the left. The screen is only written.
+// * @param: *chart: the chart.
+static void strip_flush(STRIP_CHART_t* chart)
+{
+    const COLOR_t* src;
+    COLOR_t*       dst;
+    uint_t         stride;
+    uint_t         left;
+    uint_t         i;
+
+    stride = chart->fb->vinfo.xres;
+    left = chart->w - chart->head;
+    src = chart->shadow;
+    dst = chart->fb->screen + chart->y * stride + chart->x;
+    for (i = 0; i < chart->h; i++, src += chart->w, dst += stride)
+    {
+        memcpy(dst, src + chart->head, sizeof(COLOR_t) * left);
+        memcpy(dst + left, src, sizeof(COLOR_t) * chart->head);
+    }
+
+    return;
+}
+
+
+// * Fill the area of the chart with the background color.
+// * @param: *chart: the chart.
+static void strip_clear(STRIP_CHART_t* chart)
+{
+    COLOR_t* row;
+    uint_t   i;
+    uint_t   j;
+
+    row = chart->fb->screen + chart->y * chart->fb->vinfo.xres + chart->x;
+    for (j = 0; j < chart->w; j++)
+        row[j] = chart->bgcolor;
+
+    for (i = 1; i < chart->h; i++)
+        memcpy(row + i * chart->fb->vinfo.xres, row,
+               sizeof(COLOR_t) * chart->w);
+
+    return;
+}
+
+
+// * Initialize a strip chart over an area of the screen, and clear it.
+// * @param: *chart : the structure to initialize.
+// * @param: *fb    : the framebuffer where the chart is drawn.
+// * @param: x      : x coordinate of the area.
+// * @param: y      : y coordinate of the area.
+// * @param: w      : width of the area, one column per pixel.
+// * @param: h      : height of the area.
+// * @param: vmin   : value drawn on the bottom row.
+// * @param: vmax   : value drawn on the top row.
+// * @param: spc    : samples per column, their min and max are drawn.
+// * @param: mode   : STRIP_SWEEP or STRIP_SCROLL.
+// * @param: fgcolor: color of the trace.
+// * @param: bgcolor: color of the background.
+// * @return: 1 in case of an error, 0 otherwise.
+int strip_chart_init(STRIP_CHART_t* chart, FRAMEBUFFER_t* fb, uint_t x,
+                     uint_t y, uint_t w, uint_t h, int vmin, int vmax,
+                     uint_t spc, uint8_t mode, COLOR_t fgcolor,
+                     COLOR_t bgcolor)
+{
+    uint_t j;
+
+    memset(chart, 0, sizeof(STRIP_CHART_t));
+    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres || vmax <= vmin)
+        return 1;
+
+    chart->fb = fb;
+    chart->x = x;
+    chart->y = y;
+    chart->w = w > fb->vinfo.xres - x ? fb->vinfo.xres - x : w;
+    chart->h = h > fb->vinfo.yres - y ? fb->vinfo.yres - y : h;
+    chart->h = chart->h > 0xFFFF ? 0xFFFF : chart->h;
+    chart->mode = mode;
+    chart->fgcolor = fgcolor;
+    chart->bgcolor = bgcolor;
+    chart->vmin = vmin;
+    chart->vmax = vmax;
+    chart->spc = spc ? spc : 1;
+    if (!chart->w || !chart->h)
+        return 1;
+
+    chart->scale = ((int64_t)(chart->h - 1) << 16) / ((int64_t)vmax - vmin);
+    chart->lo = malloc(sizeof(uint16_t) * chart->w);
+    chart->hi = malloc(sizeof(uint16_t) * chart->w);
+    if (mode == STRIP_SCROLL)
+        chart->shadow = malloc(sizeof(COLOR_t) * chart->w * chart->h);
+
+    if (!chart->lo || !chart->hi || (mode == STRIP_SCROLL && !chart->shadow))
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the strip chart failed."
+               "\x1b[0m\n");
+        strip_chart_free(chart);
+        return 1;
+    }
+
+    if (chart->shadow)
+        for (j = 0; j < chart->w; j++)
+            strip_column(chart, chart->shadow + j, chart->w, chart->h, 0);
+
+    strip_clear(chart);
+    return 0;
+}
+
+
+// * Free the column ring and the shadow of the chart.
+// * @param: *chart: the chart to free.
+void strip_chart_free(STRIP_CHART_t* chart)
+{
+    free(chart->lo);
+    free(chart->hi);
+    free(chart->shadow);
+    chart->lo = NULL;
+    chart->hi = NULL;
+    chart->shadow = NULL;
+    return;
+}
+
+
+// * Draw the blank gap ahead of the newest column in SWEEP mode.
+// * @param: *chart: the chart.
+static void strip_gap(STRIP_CHART_t* chart)
+{
+    uint_t g;
+
+    if (chart->w <= STRIP_GAP)
+        return;
+
+    for (g = 0; g < STRIP_GAP; g++)
+        strip_column_screen(chart, (chart->head + g) % chart->w, chart->h, 0);
+
+    return;
+}
+
+
+// * Draw the k newest columns of the ring. In SCROLL mode they are drawn in
+// * the shadow at their place in the ring, and the shadow is flushed.
+// * @param: *chart: the chart.
+// * @param: k     : number of columns, at most w.
+static void strip_draw_newest(STRIP_CHART_t* chart, uint_t k)
+{
+    uint_t c;
+    uint_t i;
+
+    for (i = 0; i < k; i++)
+    {
+        c = (chart->head + chart->w - k + i) % chart->w;
+        if (chart->mode == STRIP_SCROLL)
+            strip_column(chart, chart->shadow + c, chart->w, chart->lo[c],
+                         chart->hi[c]);
+
+        else
+            strip_column_screen(chart, c, chart->lo[c], chart->hi[c]);
+    }
+
+    if (chart->mode == STRIP_SCROLL)
+        strip_flush(chart);
+
+    else
+        strip_gap(chart);
+
+    return;
+}
+
+
+// * Add a batch of samples and draw the columns they complete. Consecutive
+// * columns are joined so the trace has no holes.
+// * @param: *chart  : the chart.
+// * @param: *samples: the samples, oldest first.
+// * @param: n       : number of samples.
+// * @return: the number of columns completed.
+uint_t strip_chart_push(STRIP_CHART_t* chart, const int16_t* samples,
+                        uint_t n)
+{
+    uint_t i;
+    uint_t k;
+    int    s;
+    STAT_BEGIN();
+
+    if (!n)
+    {
+        STAT_END(STAT_STRIP_PUSH, 0, 0);
+        return 0;
+    }
+
+    if (!chart->samples)
+        chart->last = samples[0];
+
+    k = 0;
+    for (i = 0; i < n; i++)
+    {
+        s = samples[i];
+
+        // A column starts from the last sample of the previous one.
+        if (!chart->acc)
+        {
+            chart->acc_min = chart->last;
+            chart->acc_max = chart->last;
+        }
+
+        chart->acc_min = s < chart->acc_min ? s : chart->acc_min;
+        chart->acc_max = s > chart->acc_max ? s : chart->acc_max;
+        chart->last = s;
+        if (++chart->acc < chart->spc)
+            continue;
+
+        chart->lo[chart->head] = strip_row(chart, chart->acc_max);
+        chart->hi[chart->head] = strip_row(chart, chart->acc_min);
+        chart->head = chart->head + 1 < chart->w ? chart->head + 1 : 0;
+        chart->acc = 0;
+        k++;
+    }
+
+    chart->samples += n;
+    chart->columns += k;
+    chart->ncols = chart->ncols + k > chart->w ? chart->w : chart->ncols + k;
+    if (k)
+        strip_draw_newest(chart, k > chart->w ? chart->w : k);
+
+    STAT_END(STAT_STRIP_PUSH, n, 0);
+    return k;
+}
+
+
+// * Draw the whole chart from the column ring, after the area has been
+// * overwritten.
+// * @param: *chart: the chart.
+void strip_chart_redraw(STRIP_CHART_t* chart)
+{
+    if (chart->mode == STRIP_SCROLL)
+    {
+        strip_flush(chart);
+        return;
+    }
+
+    strip_clear(chart);
+    strip_draw_newest(chart, chart->ncols);
+    return;
+}
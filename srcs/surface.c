@@ -0,0 +1,325 @@
+#include "surface.h"
+
+
+// * Allocate an off-screen surface cleared to black.
+// * @param: *surf: the structure to initialize.
+// * @param: w    : width of the surface.
+// * @param: h    : height of the surface.
+// * @return: 1 in case of an error, 0 otherwise.
+int surface_init(SURFACE_t* surf, uint_t w, uint_t h)
+{
+    memset(surf, 0, sizeof(SURFACE_t));
+    surf->pix = calloc(w * h, sizeof(COLOR_t));
+    if (!surf->pix)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating a surface failed.\x1b[0m\n");
+        return 1;
+    }
+
+    surf->w = w;
+    surf->h = h;
+    surf->stride = w;
+    surf->format = SURFACE_RGB565;
+    surf->owner = 1;
+    return 0;
+}
+
+
+// * Free the pixels of a surface that owns them.
+// * @param: *surf: the surface to free.
+void surface_free(SURFACE_t* surf)
+{
+    if (surf->owner)
+        free(surf->pix);
+
+    memset(surf, 0, sizeof(SURFACE_t));
+    return;
+}
+
+
+// * Make a surface view over contiguous pixels, rows of w pixels.
+// * @param: *surf: the structure to initialize.
+// * @param: *pix : the pixels.
+// * @param: w    : width of the pixels.
+// * @param: h    : height of the pixels.
+void surface_from_pixels(SURFACE_t* surf, COLOR_t* pix, uint_t w, uint_t h)
+{
+    surf->pix = pix;
+    surf->w = w;
+    surf->h = h;
+    surf->stride = w;
+    surf->format = SURFACE_RGB565;
+    surf->owner = 0;
+    return;
+}
+
+
+// * Make a surface view over the pixels of a framebuffer.
+// * @param: *surf: the structure to initialize.
+// * @param: *fb  : the framebuffer.
+void surface_from_framebuffer(SURFACE_t* surf, FRAMEBUFFER_t* fb)
+{
+    surface_from_pixels(surf, fb->screen, fb->vinfo.xres, fb->vinfo.yres);
+    return;
+}
+
+
+// * Make a surface view over the pixels of a RECT_CP_t.
+// * @param: *surf: the structure to initialize.
+// * @param: *cp  : the copied rectangle.
+void surface_from_rect(SURFACE_t* surf, RECT_CP_t* cp)
+{
+    surface_from_pixels(surf, cp->buf, cp->w, cp->h);
+    return;
+}
+
+
+// * Make a surface view over an area of another surface, clipped to it.
+// * @param: *surf: the structure to initialize.
+// * @param: *src : the parent surface.
+// * @param: x    : x coordinate of the area in the parent.
+// * @param: y    : y coordinate of the area in the parent.
+// * @param: w    : width of the area.
+// * @param: h    : height of the area.
+void surface_sub(SURFACE_t* surf, SURFACE_t* src, uint_t x, uint_t y,
+                 uint_t w, uint_t h)
+{
+    x = x > src->w ? src->w : x;
+    y = y > src->h ? src->h : y;
+    surf->pix = src->pix + y * src->stride + x;
+    surf->w = w > src->w - x ? src->w - x : w;
+    surf->h = h > src->h - y ? src->h - y : h;
+    surf->stride = src->stride;
+    surf->format = src->format;
+    surf->owner = 0;
+    return;
+}
+
+
+// * Fill a FRAMEBUFFER_t that points to the surface pixels so every drawing
+// * function can render into it. Never call free_framebuffer on it.
+// * @param: *surf: the surface to render into.
+// * @param: *fb  : the framebuffer structure to fill.
+// * @return: 1 if the rows of the surface are not contiguous (a sub-surface
+// *          narrower than its parent), 0 otherwise.
+int surface_as_framebuffer(SURFACE_t* surf, FRAMEBUFFER_t* fb)
+{
+    // The primitives use xres as the row pitch.
+    if (surf->stride != surf->w)
+        return 1;
+
+    memset(fb, 0, sizeof(FRAMEBUFFER_t));
+    fb->fd = -1;
+    fb->fb_total_bytes_size = surf->w * surf->h * sizeof(COLOR_t);
+    fb->screen = surf->pix;
+    fb->vinfo.xres = surf->w;
+    fb->vinfo.yres = surf->h;
+    fb->vinfo.xres_virtual = surf->w;
+    fb->vinfo.yres_virtual = surf->h;
+    fb->vinfo.bits_per_pixel = sizeof(COLOR_t) * 8;
+    return 0;
+}
+
+
+// * Fill an area of a surface, clipped to it.
+// * @param: *surf : the surface.
+// * @param: x     : x coordinate of the area.
+// * @param: y     : y coordinate of the area.
+// * @param: w     : width of the area.
+// * @param: h     : height of the area.
+// * @param: color : the fill color.
+void surface_fill(SURFACE_t* surf, uint_t x, uint_t y, uint_t w, uint_t h,
+                  COLOR_t color)
+{
+    COLOR_t* row;
+    uint_t   i;
+    uint_t   j;
+
+    if (x >= surf->w || y >= surf->h)
+        return;
+
+    w = w > surf->w - x ? surf->w - x : w;
+    h = h > surf->h - y ? surf->h - y : h;
+    row = surf->pix + y * surf->stride + x;
+    if (!w || !h)
+        return;
+
+    // Fill the first row, then copy it.
+    for (j = 0; j < w; j++)
+        row[j] = color;
+
+    for (i = 1; i < h; i++)
+        memcpy(row + i * surf->stride, row, sizeof(COLOR_t) * w);
+
+    return;
+}
+
+
+// * Clip a blit to its source and its destination.
+// * @param: *dst: the destination surface.
+// * @param: *dx : x coordinate in the destination, updated.
+// * @param: *dy : y coordinate in the destination, updated.
+// * @param: *src: the source surface.
+// * @param: *sx : x coordinate in the source, updated.
+// * @param: *sy : y coordinate in the source, updated.
+// * @param: *w  : width of the area, updated.
+// * @param: *h  : height of the area, updated.
+// * @return: 1 if something is left to draw, 0 otherwise.
+static int surface_clip(SURFACE_t* dst, int* dx, int* dy, SURFACE_t* src,
+                        uint_t* sx, uint_t* sy, uint_t* w, uint_t* h)
+{
+    if (*sx >= src->w || *sy >= src->h)
+        return 0;
+
+    *w = *w > src->w - *sx ? src->w - *sx : *w;
+    *h = *h > src->h - *sy ? src->h - *sy : *h;
+    if (*dx < 0)
+    {
+        if (*w <= (uint_t)-*dx)
+            return 0;
+
+        *sx += -*dx;
+        *w -= -*dx;
+        *dx = 0;
+    }
+
+    if (*dy < 0)
+    {
+        if (*h <= (uint_t)-*dy)
+            return 0;
+
+        *sy += -*dy;
+        *h -= -*dy;
+        *dy = 0;
+    }
+
+    if ((uint_t)*dx >= dst->w || (uint_t)*dy >= dst->h)
+        return 0;
+
+    *w = *w > dst->w - *dx ? dst->w - *dx : *w;
+    *h = *h > dst->h - *dy ? dst->h - *dy : *h;
+    return *w && *h;
+}
+
+
+// * Copy an area of a surface into another one, clipped to both. Each row is
+// * a single memcpy, a whole contiguous area is copied at once and areas that
+// * overlap in the same buffer are handled.
+// * @param: *dst: the destination surface.
+// * @param: dx  : x coordinate in the destination, can be negative.
+// * @param: dy  : y coordinate in the destination, can be negative.
+// * @param: *src: the source surface.
+// * @param: sx  : x coordinate of the area in the source.
+// * @param: sy  : y coordinate of the area in the source.
+// * @param: w   : width of the area.
+// * @param: h   : height of the area.
+void surface_blit(SURFACE_t* dst, int dx, int dy, SURFACE_t* src, uint_t sx,
+                  uint_t sy, uint_t w, uint_t h)
+{
+    const COLOR_t* s;
+    COLOR_t*       d;
+    uint_t         i;
+
+    if (!surface_clip(dst, &dx, &dy, src, &sx, &sy, &w, &h))
+        return;
+
+    s = src->pix + sy * src->stride + sx;
+    d = dst->pix + dy * dst->stride + dx;
+    if (w == src->stride && w == dst->stride)
+    {
+        memmove(d, s, sizeof(COLOR_t) * w * h);
+        return;
+    }
+
+    // Copy from the bottom when the destination is below the source in the
+    // same buffer.
+    if (d > s)
+        for (i = h; i > 0; i--)
+            memmove(d + (i - 1) * dst->stride, s + (i - 1) * src->stride,
+                    sizeof(COLOR_t) * w);
+
+    else
+        for (i = 0; i < h; i++)
+            memmove(d + i * dst->stride, s + i * src->stride,
+                    sizeof(COLOR_t) * w);
+
+    return;
+}
+
+
+// * Copy an area of a surface into another one, pixels of the key color are
+// * not copied.
+// * @param: *dst: the destination surface.
+// * @param: dx  : x coordinate in the destination, can be negative.
+// * @param: dy  : y coordinate in the destination, can be negative.
+// * @param: *src: the source surface.
+// * @param: sx  : x coordinate of the area in the source.
+// * @param: sy  : y coordinate of the area in the source.
+// * @param: w   : width of the area.
+// * @param: h   : height of the area.
+// * @param: key : transparent color of the source.
+void surface_blit_keyed(SURFACE_t* dst, int dx, int dy, SURFACE_t* src,
+                        uint_t sx, uint_t sy, uint_t w, uint_t h,
+                        COLOR_t key)
+{
+    const COLOR_t* s;
+    COLOR_t*       d;
+    uint_t         i;
+    uint_t         j;
+
+    if (!surface_clip(dst, &dx, &dy, src, &sx, &sy, &w, &h))
+        return;
+
+    for (i = 0; i < h; i++)
+    {
+        s = src->pix + (sy + i) * src->stride + sx;
+        d = dst->pix + (dy + i) * dst->stride + dx;
+        for (j = 0; j < w; j++)
+            if (s[j] != key)
+                d[j] = s[j];
+    }
+
+    return;
+}
+
+
+// * Blend an area of a surface over another one with a global transparency.
+// * @param: *dst : the destination surface.
+// * @param: dx   : x coordinate in the destination, can be negative.
+// * @param: dy   : y coordinate in the destination, can be negative.
+// * @param: *src : the source surface.
+// * @param: sx   : x coordinate of the area in the source.
+// * @param: sy   : y coordinate of the area in the source.
+// * @param: w    : width of the area.
+// * @param: h    : height of the area.
+// * @param: alpha: opacity of the source (0 to 255).
+void surface_blit_alpha(SURFACE_t* dst, int dx, int dy, SURFACE_t* src,
+                        uint_t sx, uint_t sy, uint_t w, uint_t h,
+                        uint8_t alpha)
+{
+    const COLOR_t* s;
+    COLOR_t*       d;
+    uint8_t        a;
+    uint_t         i;
+    uint_t         j;
+
+    a = (alpha * 32 + 127) / 255;
+    if (a == 32)
+    {
+        surface_blit(dst, dx, dy, src, sx, sy, w, h);
+        return;
+    }
+
+    if (!a || !surface_clip(dst, &dx, &dy, src, &sx, &sy, &w, &h))
+        return;
+
+    for (i = 0; i < h; i++)
+    {
+        s = src->pix + (sy + i) * src->stride + sx;
+        d = dst->pix + (dy + i) * dst->stride + dx;
+        for (j = 0; j < w; j++)
+            d[j] = blend_565_a5(d[j], s[j], a);
+    }
+
+    return;
+}
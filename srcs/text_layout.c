@@ -0,0 +1,278 @@
+#include "text_layout.h"
+
+
+// * Initialize an empty layout cache.
+// * @param: *cache   : the structure to initialize.
+// * @param: nlayouts : number of layouts kept, one per text box on screen.
+// * @return: 1 in case of an error, 0 otherwise.
+int text_cache_init(TEXT_CACHE_t* cache, uint_t nlayouts)
+{
+    memset(cache, 0, sizeof(TEXT_CACHE_t));
+    cache->layouts = calloc(nlayouts, sizeof(TEXT_LAYOUT_t));
+    if (!cache->layouts)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the text cache failed.\x1b[0m\n");
+        return 1;
+    }
+
+    cache->nlayouts = nlayouts;
+    return 0;
+}
+
+
+// * Free the layouts of the cache.
+// * @param: *cache: the cache to free.
+void text_cache_free(TEXT_CACHE_t* cache)
+{
+    free(cache->layouts);
+    cache->layouts = NULL;
+    cache->nlayouts = 0;
+    return;
+}
+
+
+// * Break the line of a layout that starts at s.
+// * @param: *layout: the layout.
+// * @param: s      : offset of the first char of the line.
+// * @param: maxc   : number of chars that fit on a line.
+// * @param: *line  : filled with the line.
+// * @return: the offset of the first char of the next line.
+static uint_t layout_line(TEXT_LAYOUT_t* layout, uint_t s, uint_t maxc,
+                          TEXT_LINE_t* line)
+{
+    const char* t;
+    uint_t      i;
+    uint_t      brk;
+    uint_t      end;
+    uint_t      next;
+
+    t = layout->text;
+    brk = s;
+    for (i = s; i < layout->len && t[i] != '\n' && i - s < maxc; i++)
+        if (t[i] == ' ')
+            brk = i;
+
+    if (i >= layout->len || t[i] == '\n')
+    {
+        end = i;
+        next = i < layout->len ? i + 1 : i;
+    }
+
+    else
+    {
+        // Break after the last whole word, cut a word longer than the line.
+        end = t[i] == ' ' || brk == s ? i : brk;
+        next = end;
+        while (next < layout->len && t[next] == ' ')
+            next++;
+
+        if (next < layout->len && t[next] == '\n')
+            next++;
+    }
+
+    while (end > s && t[end - 1] == ' ')
+        end--;
+
+    line->start = s;
+    line->len = end - s;
+    line->ellipsis = 0;
+    return next;
+}
+
+
+// * Lay out the text from a line, the lines before it are kept.
+// * @param: *cache : the cache, for the statistics.
+// * @param: *layout: the layout.
+// * @param: k      : index of the first line laid out.
+// * @param: s      : offset of the first char of this line.
+static void layout_from(TEXT_CACHE_t* cache, TEXT_LAYOUT_t* layout, uint_t k,
+                        uint_t s)
+{
+    TEXT_LINE_t* last;
+    uint_t       maxc;
+    uint_t       maxl;
+
+    maxc = layout->w / ISO_CHAR_WIDTH;
+    maxl = layout->h / ISO_CHAR_HEIGHT;
+    maxl = maxl > TEXT_MAX_LINES ? TEXT_MAX_LINES : maxl;
+    if (!maxc)
+        maxl = 0;
+
+    while (s < layout->len && k < maxl)
+    {
+        s = layout_line(layout, s, maxc, &layout->lines[k++]);
+        cache->lines_laid++;
+    }
+
+    layout->nlines = k;
+
+    // Some text is left: make room for the ellipsis on the last line.
+    if (s < layout->len && k)
+    {
+        last = &layout->lines[k - 1];
+        if ((uint_t)last->len + TEXT_ELLIPSIS_LEN > maxc)
+            last->len = maxc > TEXT_ELLIPSIS_LEN ? maxc - TEXT_ELLIPSIS_LEN
+                                                 : 0;
+
+        while (last->len && layout->text[last->start + last->len - 1] == ' ')
+            last->len--;
+
+        last->ellipsis = 1;
+    }
+
+    return;
+}
+
+
+// * Return the layout of a string in a box. The same string in the same box
+// * is not laid out again, a changed string is laid out again from the line
+// * before the first changed one.
+// * @param: *cache: the layout cache.
+// * @param: *str  : the string, '\n' starts a new line.
+// * @param: x     : x coordinate of the box.
+// * @param: y     : y coordinate of the box.
+// * @param: w     : width of the box.
+// * @param: h     : height of the box.
+// * @param: align : TEXT_ALIGN_LEFT, CENTER or RIGHT.
+// * @return: the layout, valid until the next call.
+const TEXT_LAYOUT_t* text_layout(TEXT_CACHE_t* cache, const char* str,
+                                 uint_t x, uint_t y, uint_t w, uint_t h,
+                                 uint8_t align)
+{
+    TEXT_LAYOUT_t* layout;
+    TEXT_LAYOUT_t* lru;
+    uint_t         len;
+    uint_t         d;
+    uint_t         k;
+    uint_t         i;
+
+    len = strlen(str);
+    len = len >= TEXT_MAX ? TEXT_MAX - 1 : len;
+    layout = NULL;
+    lru = &cache->layouts[0];
+    for (i = 0; i < cache->nlayouts && !layout; i++)
+    {
+        if (cache->layouts[i].used && cache->layouts[i].x == x
+            && cache->layouts[i].y == y && cache->layouts[i].w == w
+            && cache->layouts[i].h == h && cache->layouts[i].align == align)
+            layout = &cache->layouts[i];
+
+        else if (!cache->layouts[i].used
+                 || (lru->used && cache->layouts[i].stamp < lru->stamp))
+            lru = &cache->layouts[i];
+    }
+
+    cache->clock++;
+    if (!layout)
+    {
+        layout = lru;
+        layout->used = 1;
+        layout->x = x;
+        layout->y = y;
+        layout->w = w;
+        layout->h = h;
+        layout->align = align;
+        layout->nlines = 0;
+        layout->len = len;
+        memcpy(layout->text, str, len);
+        layout->text[len] = '\0';
+        layout->stamp = cache->clock;
+        layout_from(cache, layout, 0, 0);
+        cache->misses++;
+        return layout;
+    }
+
+    layout->stamp = cache->clock;
+    for (d = 0; d < len && d < layout->len && str[d] == layout->text[d]; d++)
+        ;
+
+    if (d == len && d == layout->len)
+    {
+        cache->hits++;
+        return layout;
+    }
+
+    // The line before the changed one may now take the first changed word.
+    for (k = 0; k + 1 < layout->nlines && layout->lines[k + 1].start <= d;
+         k++)
+        ;
+
+    k = k ? k - 1 : 0;
+    memcpy(layout->text + d, str + d, len - d);
+    layout->text[len] = '\0';
+    layout->len = len;
+    if (k < layout->nlines)
+        layout_from(cache, layout, k, layout->lines[k].start);
+
+    else
+        layout_from(cache, layout, 0, 0);
+
+    cache->partial++;
+    return layout;
+}
+
+
+// * Draw a layout, the whole box is painted so the previous text is erased.
+// * @param: *fb     : the framebuffer where the text is drawn.
+// * @param: *layout : the layout.
+// * @param: fgcolor : color of the letters.
+// * @param: bgcolor : color of the box.
+void text_draw(FRAMEBUFFER_t* fb, const TEXT_LAYOUT_t* layout,
+               COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    const TEXT_LINE_t* line;
+    uint_t             maxc;
+    uint_t             n;
+    uint_t             off;
+    uint_t             ly;
+    uint_t             i;
+    uint_t             j;
+
+    maxc = layout->w / ISO_CHAR_WIDTH;
+    for (i = 0; i < layout->nlines; i++)
+    {
+        line = &layout->lines[i];
+        n = line->len + (line->ellipsis ? TEXT_ELLIPSIS_LEN : 0);
+        n = n > maxc ? maxc : n;
+        off = layout->w - n * ISO_CHAR_WIDTH;
+        off = layout->align == TEXT_ALIGN_RIGHT ? off :
+              layout->align == TEXT_ALIGN_CENTER ? off / 2 : 0;
+        ly = layout->y + i * ISO_CHAR_HEIGHT;
+
+        draw_rect(fb, layout->x, ly, off, ISO_CHAR_HEIGHT, bgcolor);
+        for (j = 0; j < n; j++)
+            print_char_coord(fb, j < line->len ? layout->text[line->start + j]
+                                 : TEXT_ELLIPSIS[j - line->len],
+                             layout->x + off + j * ISO_CHAR_WIDTH, ly,
+                             fgcolor, bgcolor);
+
+        draw_rect(fb, layout->x + off + n * ISO_CHAR_WIDTH, ly,
+                  layout->w - off - n * ISO_CHAR_WIDTH, ISO_CHAR_HEIGHT,
+                  bgcolor);
+    }
+
+    draw_rect(fb, layout->x, layout->y + i * ISO_CHAR_HEIGHT, layout->w,
+              layout->h - i * ISO_CHAR_HEIGHT, bgcolor);
+    return;
+}
+
+
+// * Lay out and draw a string in a box.
+// * @param: *fb     : the framebuffer where the text is drawn.
+// * @param: *cache  : the layout cache.
+// * @param: *str    : the string, '\n' starts a new line.
+// * @param: x       : x coordinate of the box.
+// * @param: y       : y coordinate of the box.
+// * @param: w       : width of the box.
+// * @param: h       : height of the box.
+// * @param: align   : TEXT_ALIGN_LEFT, CENTER or RIGHT.
+// * @param: fgcolor : color of the letters.
+// * @param: bgcolor : color of the box.
+void print_text_box(FRAMEBUFFER_t* fb, TEXT_CACHE_t* cache, const char* str,
+                    uint_t x, uint_t y, uint_t w, uint_t h, uint8_t align,
+                    COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    text_draw(fb, text_layout(cache, str, x, y, w, h, align), fgcolor,
+              bgcolor);
+    return;
+}
@@ -0,0 +1,524 @@
+#include "tile_pool.h"
+#include "fb_trace.h"
+
+
+// * Rasterize a RECT_CP_t pasted with transparency inside the clip area.
+// * @param: *fb : the framebuffer where the command is rendered.
+// * @param: *cmd: the command to rasterize.
+// * @param: cx0 : left edge of the clip area.
+// * @param: cy0 : top edge of the clip area.
+// * @param: cx1 : right edge of the clip area (excluded).
+// * @param: cy1 : bottom edge of the clip area (excluded).
+static void raster_alpha(FRAMEBUFFER_t* fb, TILE_CMD_t* cmd,
+                         uint_t cx0, uint_t cy0, uint_t cx1, uint_t cy1)
+{
+    const RECT_CP_t* cp;
+    const COLOR_t*   src;
+    COLOR_t*         dst;
+    uint_t           x;
+    uint_t           y;
+
+    cp = (const RECT_CP_t*)cmd->data;
+    for (y = cy0; y < cy1; y++)
+    {
+        dst = fb->screen + y * fb->vinfo.xres;
+        src = cp->buf + (y - cmd->y0) * cp->w - cmd->x0;
+        for (x = cx0; x < cx1; x++)
+            dst[x] = blend_16bits_color(dst[x], src[x], cmd->alpha);
+    }
+
+    return;
+}
+
+
+// * Rasterize a command clipped against an area of the screen.
+// * @param: *fb : the framebuffer where the command is rendered.
+// * @param: *cmd: the command to rasterize.
+// * @param: cx0 : left edge of the clip area.
+// * @param: cy0 : top edge of the clip area.
+// * @param: cx1 : right edge of the clip area (excluded).
+// * @param: cy1 : bottom edge of the clip area (excluded).
+static void raster_cmd(FRAMEBUFFER_t* fb, TILE_CMD_t* cmd,
+                       uint_t cx0, uint_t cy0, uint_t cx1, uint_t cy1)
+{
+    if (cmd->x0 > cx0)
+        cx0 = cmd->x0;
+
+    if (cmd->y0 > cy0)
+        cy0 = cmd->y0;
+
+    if (cmd->x1 < cx1)
+        cx1 = cmd->x1;
+
+    if (cmd->y1 < cy1)
+        cy1 = cmd->y1;
+
+    if (cx0 >= cx1 || cy0 >= cy1)
+        return;
+
+    switch (cmd->type)
+    {
+        case TILE_CMD_FILL:
+            fill_area(fb, cx0, cy0, cx1, cy1, cmd->fgcolor);
+            break;
+
+        case TILE_CMD_ALPHA:
+            raster_alpha(fb, cmd, cx0, cy0, cx1, cy1);
+            break;
+
+        case TILE_CMD_TEXT:
+            print_str_area(fb, (const char*)cmd->data, cmd->x0, cmd->y0, cx0,
+                           cy0, cx1, cy1, cmd->fgcolor, cmd->bgcolor);
+            break;
+    }
+
+    return;
+}
+
+
+#ifdef FB_THREADS
+
+// * Rasterize every command binned into a tile.
+// * @param: *pool: the pool that owns the tile.
+// * @param: tile : index of the tile.
+static void tile_render(TILE_POOL_t* pool, uint_t tile)
+{
+    uint_t cx0;
+    uint_t cy0;
+    uint_t cx1;
+    uint_t cy1;
+    uint_t i;
+
+    cx0 = (tile % pool->tiles_x) * pool->tile_w;
+    cy0 = (tile / pool->tiles_x) * pool->tile_h;
+    cx1 = cx0 + pool->tile_w;
+    cy1 = cy0 + pool->tile_h;
+
+    if (cx1 > pool->fb->vinfo.xres)
+        cx1 = pool->fb->vinfo.xres;
+
+    if (cy1 > pool->fb->vinfo.yres)
+        cy1 = pool->fb->vinfo.yres;
+
+    for (i = pool->bin_start[tile]; i < pool->bin_start[tile + 1]; i++)
+        raster_cmd(pool->fb, &pool->cmds[pool->bin_cmds[i]],
+                   cx0, cy0, cx1, cy1);
+
+    return;
+}
+
+
+// * Take tiles from the worker own range first, then steal from the others
+// * until every tile of the frame is rendered.
+// * @param: *pool: the pool to work on.
+// * @param: self : index of the calling worker.
+static void tile_work(TILE_POOL_t* pool, uint_t self)
+{
+    TILE_QUEUE_t* q;
+    uint_t        tile;
+    uint_t        k;
+
+    for (k = 0; k < pool->nthreads; k++)
+    {
+        q = &pool->queues[(self + k) % pool->nthreads];
+        while (1)
+        {
+            tile = __atomic_fetch_add(&q->next, 1, __ATOMIC_RELAXED);
+            if (tile >= q->end)
+                break;
+
+            tile_render(pool, tile);
+        }
+    }
+
+    return;
+}
+
+
+// * Main loop of a worker thread, wait for a new frame and render it.
+// * @param: *arg: the queue owned by the worker.
+static void* tile_worker(void* arg)
+{
+    TILE_QUEUE_t* q;
+    TILE_POOL_t*  pool;
+    uint_t        seen;
+
+    q = (TILE_QUEUE_t*)arg;
+    pool = q->pool;
+    seen = 0;
+
+    while (1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->quit && pool->generation == seen)
+            pthread_cond_wait(&pool->start_cond, &pool->lock);
+
+        if (pool->quit)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        tile_work(pool, q - pool->queues);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->running--;
+        if (!pool->running)
+            pthread_cond_signal(&pool->done_cond);
+
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+
+// * Sort the recorded commands into per tile lists, keeping submission order.
+// * @param: *pool: the pool to bin.
+// * @return: 1 in case of an error, 0 otherwise.
+static int tile_bin(TILE_POOL_t* pool)
+{
+    TILE_CMD_t* cmd;
+    uint_t*     tmp;
+    uint_t      tx;
+    uint_t      ty;
+    uint_t      t;
+    uint_t      i;
+
+    // Count the commands that touch each tile.
+    memset(pool->bin_start, 0, sizeof(uint_t) * (pool->ntiles + 1));
+    for (i = 0; i < pool->ncmds; i++)
+    {
+        cmd = &pool->cmds[i];
+        for (ty = cmd->y0 / pool->tile_h; ty <= (cmd->y1 - 1) / pool->tile_h; ty++)
+            for (tx = cmd->x0 / pool->tile_w; tx <= (cmd->x1 - 1) / pool->tile_w; tx++)
+                pool->bin_start[ty * pool->tiles_x + tx + 1]++;
+    }
+
+    for (t = 0; t < pool->ntiles; t++)
+        pool->bin_start[t + 1] += pool->bin_start[t];
+
+    if (pool->bin_start[pool->ntiles] > pool->bin_cap)
+    {
+        tmp = realloc(pool->bin_cmds,
+                      sizeof(uint_t) * pool->bin_start[pool->ntiles]);
+        if (!tmp)
+            return 1;
+
+        pool->bin_cmds = tmp;
+        pool->bin_cap = pool->bin_start[pool->ntiles];
+    }
+
+    // Fill the lists, bin_start is used as a cursor and ends up shifted by one
+    // tile so move it back afterwards.
+    for (i = 0; i < pool->ncmds; i++)
+    {
+        cmd = &pool->cmds[i];
+        for (ty = cmd->y0 / pool->tile_h; ty <= (cmd->y1 - 1) / pool->tile_h; ty++)
+            for (tx = cmd->x0 / pool->tile_w; tx <= (cmd->x1 - 1) / pool->tile_w; tx++)
+                pool->bin_cmds[pool->bin_start[ty * pool->tiles_x + tx]++] = i;
+    }
+
+    for (t = pool->ntiles; t > 0; t--)
+        pool->bin_start[t] = pool->bin_start[t - 1];
+
+    pool->bin_start[0] = 0;
+    return 0;
+}
+
+#endif
+
+
+// * Clip a command against the screen and record it, or draw it right away in
+// * the single thread build.
+// * @param: *pool: the pool where the command is recorded.
+// * @param: *cmd : the command, its bounding box may exceed the screen.
+// * @return: 1 if the command list is full, 0 otherwise.
+static int tile_push(TILE_POOL_t* pool, TILE_CMD_t* cmd)
+{
+    if (cmd->x1 > pool->fb->vinfo.xres)
+        cmd->x1 = pool->fb->vinfo.xres;
+
+    if (cmd->y1 > pool->fb->vinfo.yres)
+        cmd->y1 = pool->fb->vinfo.yres;
+
+    if (cmd->x0 >= cmd->x1 || cmd->y0 >= cmd->y1)
+        return 0;
+
+#ifdef FB_THREADS
+    if (pool->ncmds >= pool->max_cmds)
+        return 1;
+
+    pool->cmds[pool->ncmds] = *cmd;
+    pool->ncmds++;
+#else
+    raster_cmd(pool->fb, cmd, 0, 0, pool->fb->vinfo.xres, pool->fb->vinfo.yres);
+#endif
+
+    return 0;
+}
+
+
+// * Initialize the tile pool. Without FB_THREADS every command is drawn as soon
+// * as it is issued and no thread nor command list is created.
+// * @param: *pool    : the structure to initialize.
+// * @param: *fb      : the framebuffer where the commands will be rendered.
+// * @param: nthreads : number of rendering threads, including the caller.
+// * @param: max_cmds : maximum number of commands recorded between flushes.
+// * @return: 1 in case of an error, 0 otherwise.
+int tile_pool_init(TILE_POOL_t* pool, FRAMEBUFFER_t* fb,
+                   uint_t nthreads, uint_t max_cmds)
+{
+#ifdef FB_THREADS
+    uint_t i;
+#endif
+
+    memset(pool, 0, sizeof(TILE_POOL_t));
+    pool->fb = fb;
+    pool->tile_w = TILE_DEFAULT_W;
+    pool->tile_h = TILE_DEFAULT_H;
+    pool->tiles_x = (fb->vinfo.xres + pool->tile_w - 1) / pool->tile_w;
+    pool->tiles_y = (fb->vinfo.yres + pool->tile_h - 1) / pool->tile_h;
+    pool->ntiles = pool->tiles_x * pool->tiles_y;
+    pool->max_cmds = max_cmds;
+
+#ifdef FB_THREADS
+    if (!nthreads)
+        nthreads = 1;
+
+    // tile_pool_free() uses them on every error path below.
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    pool->nthreads = nthreads;
+    pool->cmds = malloc(sizeof(TILE_CMD_t) * max_cmds);
+    pool->bin_start = malloc(sizeof(uint_t) * (pool->ntiles + 1));
+    pool->queues = calloc(nthreads, sizeof(TILE_QUEUE_t));
+    pool->threads = calloc(nthreads, sizeof(pthread_t));
+    if (!pool->cmds || !pool->bin_start || !pool->queues || !pool->threads)
+    {
+        printf("\x1b[1;31m~[ERROR] Allocating the tile pool failed.\x1b[0m\n");
+        pool->nthreads = 1;
+        tile_pool_free(pool);
+        return 1;
+    }
+
+    // The caller is worker 0, only spawn the others.
+    for (i = 0; i < nthreads; i++)
+        pool->queues[i].pool = pool;
+
+    for (i = 1; i < nthreads; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, tile_worker,
+                           &pool->queues[i]))
+        {
+            pool->nthreads = i;
+            tile_pool_free(pool);
+            return 1;
+        }
+    }
+#else
+    (void)nthreads;
+#endif
+
+    return 0;
+}
+
+
+// * Stop the workers and free the memory used by the pool.
+// * @param: *pool: the pool to free.
+void tile_pool_free(TILE_POOL_t* pool)
+{
+#ifdef FB_THREADS
+    uint_t i;
+
+    // nthreads is set once the lock and conditions are initialized.
+    if (pool->nthreads)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->quit = 1;
+        pthread_cond_broadcast(&pool->start_cond);
+        pthread_mutex_unlock(&pool->lock);
+
+        for (i = 1; i < pool->nthreads; i++)
+            pthread_join(pool->threads[i], NULL);
+
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->start_cond);
+        pthread_cond_destroy(&pool->done_cond);
+        pool->nthreads = 0;
+    }
+
+    free(pool->threads);
+    free(pool->queues);
+    free(pool->bin_start);
+    free(pool->bin_cmds);
+    free(pool->cmds);
+    pool->threads = NULL;
+    pool->queues = NULL;
+    pool->bin_start = NULL;
+    pool->bin_cmds = NULL;
+    pool->cmds = NULL;
+#else
+    (void)pool;
+#endif
+
+    return;
+}
+
+
+// * Record a filled rectangle.
+// * @param: *pool : the pool where the command is recorded.
+// * @param: x     : start x coordinate.
+// * @param: y     : start y coordinate.
+// * @param: w     : width of the rectangle.
+// * @param: h     : height of the rectangle.
+// * @param: color : color of the rectangle.
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_draw_rect(TILE_POOL_t* pool, uint_t x, uint_t y,
+                   uint_t w, uint_t h, COLOR_t color)
+{
+    TILE_CMD_t cmd;
+
+    cmd.type = TILE_CMD_FILL;
+    cmd.fgcolor = color;
+    cmd.x0 = x;
+    cmd.y0 = y;
+    cmd.x1 = x + w;
+    cmd.y1 = y + h;
+    cmd.data = NULL;
+
+    return tile_push(pool, &cmd);
+}
+
+
+// * Record a fill of the entire screen.
+// * @param: *pool : the pool where the command is recorded.
+// * @param: color : color of the screen.
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_fill_screen(TILE_POOL_t* pool, COLOR_t color)
+{
+    return tile_draw_rect(pool, 0, 0, pool->fb->vinfo.xres,
+                          pool->fb->vinfo.yres, color);
+}
+
+
+// * Record a paste of a RECT_CP_t with transparency, the buffer must stay valid
+// * until the next flush.
+// * @param: *pool : the pool where the command is recorded.
+// * @param: *cp   : the RECT_CP_t buffer that contains data that will be drawn.
+// * @param: x     : x coordinate of the top-left corner.
+// * @param: y     : y coordinate of the top-left corner.
+// * @param: alpha : the value of transparency we want to apply (0 to 255).
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_write_rect_alpha(TILE_POOL_t* pool, RECT_CP_t* cp,
+                          uint_t x, uint_t y, uint8_t alpha)
+{
+    TILE_CMD_t cmd;
+
+    cmd.type = TILE_CMD_ALPHA;
+    cmd.alpha = alpha;
+    cmd.x0 = x;
+    cmd.y0 = y;
+    cmd.x1 = x + cp->w;
+    cmd.y1 = y + cp->h;
+    cmd.data = cp;
+
+    return tile_push(pool, &cmd);
+}
+
+
+// * Record a string drawn on a single line, the string must stay valid until
+// * the next flush.
+// * @param: *pool  : the pool where the command is recorded.
+// * @param: *str   : the string to draw.
+// * @param: x      : x position of the first char.
+// * @param: y      : y position of the first char.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the chars.
+// * @return: 1 if the command list is full, 0 otherwise.
+int tile_print_str(TILE_POOL_t* pool, const char* str, uint_t x, uint_t y,
+                   COLOR_t fgcolor, COLOR_t bgcolor)
+{
+    TILE_CMD_t cmd;
+
+    if (!str)
+        return 0;
+
+    cmd.type = TILE_CMD_TEXT;
+    cmd.fgcolor = fgcolor;
+    cmd.bgcolor = bgcolor;
+    cmd.x0 = x;
+    cmd.y0 = y;
+    cmd.x1 = x + strlen(str) * ISO_CHAR_WIDTH;
+    cmd.y1 = y + ISO_CHAR_HEIGHT;
+    cmd.data = str;
+
+    return tile_push(pool, &cmd);
+}
+
+
+// * Bin the recorded commands by tile and rasterize every tile, the call
+// * returns once the whole frame is drawn. Tiles are disjoint and each one runs
+// * its commands in submission order so the output is deterministic.
+// * @param: *pool: the pool to flush.
+void tile_pool_flush(TILE_POOL_t* pool)
+{
+#ifdef FB_THREADS
+    uint_t per_worker;
+    uint_t i;
+
+    if (!pool->ncmds)
+        return;
+
+    TRACE_BEGIN();
+
+    // Without memory for the bins, fall back to a single thread full screen
+    // pass so the frame is still drawn.
+    if (tile_bin(pool))
+    {
+        for (i = 0; i < pool->ncmds; i++)
+            raster_cmd(pool->fb, &pool->cmds[i], 0, 0,
+                       pool->fb->vinfo.xres, pool->fb->vinfo.yres);
+
+        pool->ncmds = 0;
+        TRACE_END(TRACE_FLUSH);
+        return;
+    }
+
+    // Give each worker a contiguous range of tiles.
+    per_worker = (pool->ntiles + pool->nthreads - 1) / pool->nthreads;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < pool->nthreads; i++)
+    {
+        pool->queues[i].next = i * per_worker;
+        pool->queues[i].end = (i + 1) * per_worker;
+        if (pool->queues[i].end > pool->ntiles)
+            pool->queues[i].end = pool->ntiles;
+    }
+
+    pool->running = pool->nthreads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    tile_work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+
+    pthread_mutex_unlock(&pool->lock);
+    pool->ncmds = 0;
+    TRACE_END(TRACE_FLUSH);
+#else
+    (void)pool;
+#endif
+
+    return;
+}
@@ -5,8 +5,11 @@ void print_help()
 {
     printf("Usage: ./fbtools <option>\n");
     printf("Option available: \n"); 
+    printf("\t-b : measure the samples per second of the strip chart.\n"); 
     printf("\t-h : print this message.\n"); 
     printf("\t-i : print screen information.\n"); 
+    printf("\t-r <deg> : rotate the display by 0, 90, 180 or 270 degrees.\n"); 
+    printf("\t-s : print drawing statistics on exit (needs FB_STATS).\n"); 
     printf("\t-t <str> : Show the str on the screen.\n\n");
     return;  
 }
\ No newline at end of file
@@ -0,0 +1,668 @@
+#include "widget.h"
+
+
+// * Check if a rectangle is empty.
+// * @param: *r: the rectangle.
+// * @return: 1 if it has no pixel, 0 otherwise.
+static int rect_empty(const WIDGET_RECT_t* r)
+{
+    return r->x0 >= r->x1 || r->y0 >= r->y1;
+}
+
+
+// * Intersect two rectangles.
+// * @param: a : the first rectangle.
+// * @param: *b: the second rectangle.
+// * @return: the common area, empty if they do not overlap.
+static WIDGET_RECT_t rect_clip(WIDGET_RECT_t a, const WIDGET_RECT_t* b)
+{
+    a.x0 = a.x0 > b->x0 ? a.x0 : b->x0;
+    a.y0 = a.y0 > b->y0 ? a.y0 : b->y0;
+    a.x1 = a.x1 < b->x1 ? a.x1 : b->x1;
+    a.y1 = a.y1 < b->y1 ? a.y1 : b->y1;
+    return a;
+}
+
+
+// * Grow a rectangle so it contains another one.
+// * @param: *dst: the rectangle to grow.
+// * @param: *r  : the rectangle to add.
+static void rect_union(WIDGET_RECT_t* dst, const WIDGET_RECT_t* r)
+{
+    if (rect_empty(r))
+        return;
+
+    if (rect_empty(dst))
+    {
+        *dst = *r;
+        return;
+    }
+
+    dst->x0 = dst->x0 < r->x0 ? dst->x0 : r->x0;
+    dst->y0 = dst->y0 < r->y0 ? dst->y0 : r->y0;
+    dst->x1 = dst->x1 > r->x1 ? dst->x1 : r->x1;
+    dst->y1 = dst->y1 > r->y1 ? dst->y1 : r->y1;
+    return;
+}
+
+
+// * Add an area to the damage of a widget, clipped to its bounds.
+// * @param: *w: the widget.
+// * @param: r : the area to repaint.
+static void widget_damage(WIDGET_t* w, WIDGET_RECT_t r)
+{
+    r = rect_clip(r, &w->bounds);
+    rect_union(&w->damage, &r);
+    return;
+}
+
+
+// * Return the widget of an id.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @return: the widget, NULL for an invalid id.
+static WIDGET_t* widget_get(WIDGET_TREE_t* tree, int id)
+{
+    if (id < 0 || (uint_t)id >= tree->nwidgets)
+        return NULL;
+
+    return &tree->widgets[id];
+}
+
+
+// * Format the string shown by a number.
+// * @param: *w   : the number widget.
+// * @param: value: the value to format.
+// * @param: *buf : WIDGET_TEXT_MAX chars where the string is written.
+static void number_str(WIDGET_t* w, int value, char* buf)
+{
+    // The unit is cut so the longest int still fits.
+    snprintf(buf, WIDGET_TEXT_MAX, "%d%.*s", value, WIDGET_TEXT_MAX - 12,
+             w->text);
+    return;
+}
+
+
+// * Return the area covered by the text of a label or a number. Labels are
+// * left aligned, numbers right aligned, both are vertically centered.
+// * @param: *w  : the widget.
+// * @param: *str: the string shown by the widget.
+// * @return: the area of the text, not clipped.
+static WIDGET_RECT_t text_rect(WIDGET_t* w, const char* str)
+{
+    WIDGET_RECT_t r;
+    uint_t        len;
+    uint_t        h;
+
+    len = strlen(str) * ISO_CHAR_WIDTH;
+    h = w->bounds.y1 - w->bounds.y0;
+    r.y0 = w->bounds.y0;
+    if (h > ISO_CHAR_HEIGHT)
+        r.y0 += (h - ISO_CHAR_HEIGHT) / 2;
+
+    r.y1 = r.y0 + ISO_CHAR_HEIGHT;
+    if (w->type == WIDGET_NUMBER)
+    {
+        r.x1 = w->bounds.x1 - WIDGET_PADDING;
+        r.x0 = r.x1 > len ? r.x1 - len : 0;
+    }
+
+    else
+    {
+        r.x0 = w->bounds.x0 + WIDGET_PADDING;
+        r.x1 = r.x0 + len;
+    }
+
+    return r;
+}
+
+
+// * Return the filled width of a bar.
+// * @param: *w   : the bar widget.
+// * @param: value: the value of the bar.
+// * @return: the number of filled columns.
+static uint_t bar_width(WIDGET_t* w, int value)
+{
+    if (w->max <= w->min)
+        return 0;
+
+    return (uint_t)((int64_t)(value - w->min) * (w->bounds.x1 - w->bounds.x0)
+                    / (w->max - w->min));
+}
+
+
+// * Compute the center and radius of a gauge, a half circle open at the
+// * bottom.
+// * @param: *w : the gauge widget.
+// * @param: *cx: x coordinate of the center.
+// * @param: *cy: y coordinate of the center.
+// * @param: *r : radius of the arc.
+static void gauge_geometry(WIDGET_t* w, int* cx, int* cy, int* r)
+{
+    int width;
+    int height;
+
+    width = w->bounds.x1 - w->bounds.x0;
+    height = w->bounds.y1 - w->bounds.y0;
+    *r = width / 2 - 1 < height - 1 ? width / 2 - 1 : height - 1;
+    *r = *r < 0 ? 0 : *r;
+    *cx = w->bounds.x0 + width / 2;
+    *cy = w->bounds.y0 + *r;
+    return;
+}
+
+
+// * Compute the tip of the needle of a gauge, the minimum points left and the
+// * maximum right.
+// * @param: *w   : the gauge widget.
+// * @param: value: the value shown.
+// * @param: *x   : x coordinate of the tip.
+// * @param: *y   : y coordinate of the tip.
+static void gauge_needle(WIDGET_t* w, int value, int* x, int* y)
+{
+    int32_t s;
+    int32_t c;
+    int     cx;
+    int     cy;
+    int     r;
+    int     angle;
+
+    gauge_geometry(w, &cx, &cy, &r);
+    angle = 180;
+    if (w->max > w->min)
+        angle += (int)((int64_t)(value - w->min) * 180 / (w->max - w->min));
+
+    blit_sincos(angle, &s, &c);
+    r = r > 2 ? r - 2 : 0;
+    *x = cx + ((c * r) >> 16);
+    *y = cy + ((s * r) >> 16);
+    return;
+}
+
+
+// * Return the area covered by the needle of a gauge.
+// * @param: *w   : the gauge widget.
+// * @param: value: the value shown.
+// * @return: the bounding box of the needle, one pixel larger.
+static WIDGET_RECT_t needle_rect(WIDGET_t* w, int value)
+{
+    WIDGET_RECT_t r;
+    int           cx;
+    int           cy;
+    int           rad;
+    int           x;
+    int           y;
+
+    gauge_geometry(w, &cx, &cy, &rad);
+    gauge_needle(w, value, &x, &y);
+    r.x0 = (x < cx ? x : cx) > 0 ? (x < cx ? x : cx) - 1 : 0;
+    r.y0 = (y < cy ? y : cy) > 0 ? (y < cy ? y : cy) - 1 : 0;
+    r.x1 = (x > cx ? x : cx) + 2;
+    r.y1 = (y > cy ? y : cy) + 2;
+    return r;
+}
+
+
+// * Fill the part of a rectangle inside the clip area.
+// * @param: *fb  : the framebuffer where the rectangle is drawn.
+// * @param: *clip: the area that can be modified.
+// * @param: r    : the rectangle.
+// * @param: color: color of the rectangle.
+static void draw_fill(FRAMEBUFFER_t* fb, const WIDGET_RECT_t* clip,
+                      WIDGET_RECT_t r, COLOR_t color)
+{
+    r = rect_clip(r, clip);
+    fill_area(fb, r.x0, r.y0, r.x1, r.y1, color);
+    return;
+}
+
+
+// * Draw the part of a string inside the clip area.
+// * @param: *fb    : the framebuffer where the string is drawn.
+// * @param: *clip  : the area that can be modified.
+// * @param: *str   : the string.
+// * @param: box    : the area covered by the string.
+// * @param: fgcolor: color of the letters.
+// * @param: bgcolor: color of the background of the letters.
+static void draw_text(FRAMEBUFFER_t* fb, const WIDGET_RECT_t* clip,
+                      const char* str, WIDGET_RECT_t box, COLOR_t fgcolor,
+                      COLOR_t bgcolor)
+{
+    WIDGET_RECT_t r;
+
+    r = rect_clip(box, clip);
+    print_str_area(fb, str, box.x0, box.y0, r.x0, r.y0, r.x1, r.y1, fgcolor,
+                   bgcolor);
+    return;
+}
+
+
+// * Draw a pixel if it is inside the clip area.
+// * @param: *fb  : the framebuffer where the pixel is drawn.
+// * @param: *clip: the area that can be modified.
+// * @param: x    : x coordinate of the pixel.
+// * @param: y    : y coordinate of the pixel.
+// * @param: color: color of the pixel.
+static inline void draw_plot(FRAMEBUFFER_t* fb, const WIDGET_RECT_t* clip,
+                             int x, int y, COLOR_t color)
+{
+    if (x < (int)clip->x0 || x >= (int)clip->x1
+        || y < (int)clip->y0 || y >= (int)clip->y1)
+        return;
+
+    fb->screen[y * fb->vinfo.xres + x] = color;
+    return;
+}
+
+
+// * Draw a gauge: its background, the upper half circle and the needle.
+// * @param: *fb  : the framebuffer where the gauge is drawn.
+// * @param: *clip: the area that can be modified.
+// * @param: *w   : the gauge widget.
+static void draw_gauge(FRAMEBUFFER_t* fb, const WIDGET_RECT_t* clip,
+                       WIDGET_t* w)
+{
+    int cx;
+    int cy;
+    int r;
+    int x;
+    int y;
+    int d;
+    int dx;
+    int dy;
+    int sx;
+    int sy;
+    int err;
+    int e2;
+
+    draw_fill(fb, clip, w->bounds, w->bgcolor);
+    gauge_geometry(w, &cx, &cy, &r);
+
+    // Midpoint circle, only the octants above the center.
+    x = r;
+    y = 0;
+    d = 1 - r;
+    while (x >= y)
+    {
+        draw_plot(fb, clip, cx + x, cy - y, w->fgcolor);
+        draw_plot(fb, clip, cx - x, cy - y, w->fgcolor);
+        draw_plot(fb, clip, cx + y, cy - x, w->fgcolor);
+        draw_plot(fb, clip, cx - y, cy - x, w->fgcolor);
+        y++;
+        if (d < 0)
+            d += 2 * y + 1;
+
+        else
+        {
+            x--;
+            d += 2 * (y - x) + 1;
+        }
+    }
+
+    // Bresenham line from the center to the tip of the needle.
+    gauge_needle(w, w->value, &x, &y);
+    dx = x > cx ? x - cx : cx - x;
+    dy = y > cy ? cy - y : y - cy;
+    sx = cx < x ? 1 : -1;
+    sy = cy < y ? 1 : -1;
+    err = dx + dy;
+    while (1)
+    {
+        draw_plot(fb, clip, cx, cy, w->fgcolor);
+        if (cx == x && cy == y)
+            break;
+
+        e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            cx += sx;
+        }
+
+        if (e2 <= dx)
+        {
+            err += dx;
+            cy += sy;
+        }
+    }
+
+    return;
+}
+
+
+// * Repaint the part of a widget inside the clip area.
+// * @param: *fb  : the framebuffer where the widget is drawn.
+// * @param: *clip: the area that can be modified, inside the bounds.
+// * @param: *w   : the widget.
+static void widget_draw(FRAMEBUFFER_t* fb, const WIDGET_RECT_t* clip,
+                        WIDGET_t* w)
+{
+    WIDGET_RECT_t r;
+    char          buf[WIDGET_TEXT_MAX];
+
+    switch (w->type)
+    {
+        case WIDGET_LABEL:
+        case WIDGET_NUMBER:
+            if (w->type == WIDGET_NUMBER)
+                number_str(w, w->value, buf);
+
+            else
+                memcpy(buf, w->text, WIDGET_TEXT_MAX);
+
+            draw_fill(fb, clip, w->bounds, w->bgcolor);
+            draw_text(fb, clip, buf, text_rect(w, buf), w->fgcolor,
+                      w->bgcolor);
+            break;
+
+        case WIDGET_BAR:
+            r = w->bounds;
+            r.x1 = r.x0 + bar_width(w, w->value);
+            draw_fill(fb, clip, r, w->fgcolor);
+            r.x0 = r.x1;
+            r.x1 = w->bounds.x1;
+            draw_fill(fb, clip, r, w->bgcolor);
+            break;
+
+        case WIDGET_GAUGE:
+            draw_gauge(fb, clip, w);
+            break;
+
+        default:
+            draw_fill(fb, clip, w->bounds, w->bgcolor);
+            break;
+    }
+
+    return;
+}
+
+
+// * Initialize an empty widget tree.
+// * @param: *tree       : the structure to initialize.
+// * @param: *fb         : the framebuffer where the widgets are rendered.
+// * @param: max_widgets : maximum number of widgets of the tree.
+// * @return: 1 in case of an error, 0 otherwise.
+int widget_tree_init(WIDGET_TREE_t* tree, FRAMEBUFFER_t* fb,
+                     uint_t max_widgets)
+{
+    memset(tree, 0, sizeof(WIDGET_TREE_t));
+    tree->fb = fb;
+    tree->max_widgets = max_widgets;
+
+    tree->widgets = malloc(sizeof(WIDGET_t) * max_widgets);
+    if (!tree->widgets)
+        return 1;
+
+    return 0;
+}
+
+
+// * Free the memory used by the widget tree.
+// * @param: *tree: the tree to free.
+void widget_tree_free(WIDGET_TREE_t* tree)
+{
+    if (tree->widgets)
+    {
+        free(tree->widgets);
+        tree->widgets = NULL;
+    }
+
+    tree->nwidgets = 0;
+    return;
+}
+
+
+// * Add a widget to the tree, it is fully invalidated.
+// * @param: *tree  : the tree where the widget is added.
+// * @param: parent : id of the parent, WIDGET_NONE for a root widget.
+// * @param: type   : WIDGET_PANEL, LABEL, NUMBER, BAR or GAUGE.
+// * @param: x      : x position relative to the parent.
+// * @param: y      : y position relative to the parent.
+// * @param: w      : width of the widget.
+// * @param: h      : height of the widget.
+// * @param: fgcolor: color of the text, bar or needle.
+// * @param: bgcolor: color of the background.
+// * @return: the id of the widget, WIDGET_NONE in case of an error.
+int widget_add(WIDGET_TREE_t* tree, int parent, uint8_t type, uint_t x,
+               uint_t y, uint_t w, uint_t h, COLOR_t fgcolor,
+               COLOR_t bgcolor)
+{
+    WIDGET_RECT_t area;
+    WIDGET_t*     p;
+    WIDGET_t*     widget;
+
+    if (tree->nwidgets >= tree->max_widgets)
+        return WIDGET_NONE;
+
+    // Children are placed in their parent and can not draw outside of it.
+    p = widget_get(tree, parent);
+    if (p)
+        area = p->bounds;
+
+    else
+    {
+        if (parent != WIDGET_NONE)
+            return WIDGET_NONE;
+
+        area.x0 = 0;
+        area.y0 = 0;
+        area.x1 = tree->fb->vinfo.xres;
+        area.y1 = tree->fb->vinfo.yres;
+    }
+
+    widget = &tree->widgets[tree->nwidgets];
+    memset(widget, 0, sizeof(WIDGET_t));
+    widget->type = type;
+    widget->visible = 1;
+    widget->parent = p ? parent : WIDGET_NONE;
+    widget->fgcolor = fgcolor;
+    widget->bgcolor = bgcolor;
+    widget->max = 100;
+    widget->bounds.x0 = area.x0 + x;
+    widget->bounds.y0 = area.y0 + y;
+    widget->bounds.x1 = widget->bounds.x0 + w;
+    widget->bounds.y1 = widget->bounds.y0 + h;
+    widget->bounds = rect_clip(widget->bounds, &area);
+    widget->damage = widget->bounds;
+    return tree->nwidgets++;
+}
+
+
+// * Set the text of a label or the unit of a number.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @param: *text: the new text, truncated to WIDGET_TEXT_MAX - 1 chars.
+void widget_set_text(WIDGET_TREE_t* tree, int id, const char* text)
+{
+    WIDGET_RECT_t r;
+    WIDGET_t*     w;
+    char          old[WIDGET_TEXT_MAX];
+    char          buf[WIDGET_TEXT_MAX];
+
+    w = widget_get(tree, id);
+    if (!w || !text || !strncmp(w->text, text, WIDGET_TEXT_MAX - 1))
+        return;
+
+    if (w->type == WIDGET_NUMBER)
+        number_str(w, w->value, old);
+
+    else
+        memcpy(old, w->text, WIDGET_TEXT_MAX);
+
+    strncpy(w->text, text, WIDGET_TEXT_MAX - 1);
+    w->text[WIDGET_TEXT_MAX - 1] = '\0';
+
+    if (w->type == WIDGET_NUMBER)
+        number_str(w, w->value, buf);
+
+    else
+        memcpy(buf, w->text, WIDGET_TEXT_MAX);
+
+    // The old and the new strings cover every pixel that can change.
+    r = text_rect(w, old);
+    widget_damage(w, r);
+    widget_damage(w, text_rect(w, buf));
+    return;
+}
+
+
+// * Set the value of a number, bar or gauge. Only the pixels that change are
+// * invalidated: the digits of a number, the columns between the old and the
+// * new end of a bar, the old and new needle of a gauge.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @param: value: the new value, clamped to the range of bars and gauges.
+void widget_set_value(WIDGET_TREE_t* tree, int id, int value)
+{
+    WIDGET_RECT_t r;
+    WIDGET_t*     w;
+    char          buf[WIDGET_TEXT_MAX];
+    uint_t        a;
+    uint_t        b;
+
+    w = widget_get(tree, id);
+    if (!w)
+        return;
+
+    if (w->type == WIDGET_BAR || w->type == WIDGET_GAUGE)
+        value = value < w->min ? w->min : value > w->max ? w->max : value;
+
+    if (value == w->value)
+        return;
+
+    switch (w->type)
+    {
+        case WIDGET_NUMBER:
+            number_str(w, w->value, buf);
+            widget_damage(w, text_rect(w, buf));
+            number_str(w, value, buf);
+            widget_damage(w, text_rect(w, buf));
+            break;
+
+        case WIDGET_BAR:
+            a = bar_width(w, w->value);
+            b = bar_width(w, value);
+            r = w->bounds;
+            r.x0 = w->bounds.x0 + (a < b ? a : b);
+            r.x1 = w->bounds.x0 + (a > b ? a : b);
+            widget_damage(w, r);
+            break;
+
+        case WIDGET_GAUGE:
+            widget_damage(w, needle_rect(w, w->value));
+            widget_damage(w, needle_rect(w, value));
+            break;
+
+        default:
+            break;
+    }
+
+    w->value = value;
+    return;
+}
+
+
+// * Set the range of a bar or a gauge.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+// * @param: min  : value of an empty bar.
+// * @param: max  : value of a full bar.
+void widget_set_range(WIDGET_TREE_t* tree, int id, int min, int max)
+{
+    WIDGET_t* w;
+
+    w = widget_get(tree, id);
+    if (!w || (w->min == min && w->max == max))
+        return;
+
+    w->min = min;
+    w->max = max;
+    w->value = w->value < min ? min : w->value > max ? max : w->value;
+    w->damage = w->bounds;
+    return;
+}
+
+
+// * Show or hide a widget and its children. A hidden widget is repainted by
+// * its parent, a hidden root widget keeps its pixels.
+// * @param: *tree  : the tree of the widget.
+// * @param: id     : id of the widget.
+// * @param: visible: 1 to show the widget, 0 to hide it.
+void widget_set_visible(WIDGET_TREE_t* tree, int id, int visible)
+{
+    WIDGET_t* w;
+    WIDGET_t* p;
+
+    w = widget_get(tree, id);
+    if (!w || w->visible == !!visible)
+        return;
+
+    w->visible = !!visible;
+    if (visible)
+        w->damage = w->bounds;
+
+    else
+    {
+        p = widget_get(tree, w->parent);
+        if (p)
+            widget_damage(p, w->bounds);
+    }
+
+    return;
+}
+
+
+// * Invalidate the whole widget.
+// * @param: *tree: the tree of the widget.
+// * @param: id   : id of the widget.
+void widget_invalidate(WIDGET_TREE_t* tree, int id)
+{
+    WIDGET_t* w;
+
+    w = widget_get(tree, id);
+    if (w)
+        w->damage = w->bounds;
+
+    return;
+}
+
+
+// * Repaint the invalidated widgets clipped to their damage, the widgets
+// * drawn over a repainted area are repainted too.
+// * @param: *tree: the tree to render.
+// * @return: the number of widgets repainted.
+uint_t widget_render(WIDGET_TREE_t* tree)
+{
+    WIDGET_RECT_t clip;
+    WIDGET_t*     w;
+    WIDGET_t*     p;
+    uint_t        drawn;
+    uint_t        i;
+    uint_t        j;
+
+    drawn = 0;
+    for (i = 0; i < tree->nwidgets; i++)
+    {
+        // Parents are before their children, their visibility is known.
+        w = &tree->widgets[i];
+        p = widget_get(tree, w->parent);
+        w->shown = w->visible && (!p || p->shown);
+
+        clip = w->damage;
+        memset(&w->damage, 0, sizeof(WIDGET_RECT_t));
+        if (!w->shown || rect_empty(&clip))
+            continue;
+
+        widget_draw(tree->fb, &clip, w);
+        drawn++;
+        tree->pixels_drawn += (unsigned long)(clip.x1 - clip.x0)
+                              * (clip.y1 - clip.y0);
+
+        // Everything painted later over this area has to be painted again.
+        for (j = i + 1; j < tree->nwidgets; j++)
+            widget_damage(&tree->widgets[j], clip);
+    }
+
+    tree->widgets_drawn += drawn;
+    return drawn;
+}
@@ -0,0 +1,365 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "psf_font.h"
+#include "atlas_font.h"
+
+
+// Unicode blocks exported in the atlas when the font has them.
+static const uint32_t RANGES[][2] = {
+    {0x0020, 0x007E}, {0x00A0, 0x00FF}, {0x0370, 0x03FF}, {0x0400, 0x04FF},
+    {0xFFFD, 0xFFFD}
+};
+
+
+// * Print the usage of the tool.
+static void usage(void)
+{
+    printf("Usage: fbatlas [-4] [-s factor] [-k kern.txt] <font.psf> <out>\n");
+    printf("\t-4 : store 4 bits coverage instead of 8 bits.\n");
+    printf("\t-s : downscale factor, each output pixel averages s*s font\n");
+    printf("\t     pixels (default 2).\n");
+    printf("\t-k : kerning pairs, one \"left right adjust\" per line.\n");
+    return;
+}
+
+
+// * Compare two kerning pairs, for qsort.
+// * @param: *a: the first pair.
+// * @param: *b: the second pair.
+// * @return: the order of the pairs.
+static int kern_cmp(const void* a, const void* b)
+{
+    const ATLAS_KERN_t* ka;
+    const ATLAS_KERN_t* kb;
+
+    ka = (const ATLAS_KERN_t*)a;
+    kb = (const ATLAS_KERN_t*)b;
+    if (ka->left != kb->left)
+        return ka->left < kb->left ? -1 : 1;
+
+    return ka->right < kb->right ? -1 : ka->right > kb->right;
+}
+
+
+// * Load the kerning pairs of a text file.
+// * @param: *path : path of the kerning file.
+// * @param: **out : allocated array of pairs, sorted.
+// * @return: the number of pairs, -1 in case of an error.
+static int load_kerning(const char* path, ATLAS_KERN_t** out)
+{
+    ATLAS_KERN_t* pairs;
+    ATLAS_KERN_t* tmp;
+    FILE*         file;
+    char          line[128];
+    long          left;
+    long          right;
+    long          adjust;
+    int           n;
+    int           cap;
+
+    file = fopen(path, "r");
+    if (!file)
+    {
+        printf("~[ERROR] Opening %s failed.\n", path);
+        return -1;
+    }
+
+    pairs = NULL;
+    n = 0;
+    cap = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "%li %li %li", &left, &right, &adjust) != 3)
+            continue;
+
+        if (n == cap)
+        {
+            cap = cap ? cap * 2 : 64;
+            tmp = realloc(pairs, sizeof(ATLAS_KERN_t) * cap);
+            if (!tmp)
+            {
+                free(pairs);
+                fclose(file);
+                return -1;
+            }
+
+            pairs = tmp;
+        }
+
+        pairs[n].left = left;
+        pairs[n].right = right;
+        pairs[n].adjust = adjust;
+        pairs[n].pad = 0;
+        n++;
+    }
+
+    fclose(file);
+    if (n)
+        qsort(pairs, n, sizeof(ATLAS_KERN_t), kern_cmp);
+
+    *out = pairs;
+    return n;
+}
+
+
+// * Downscale a glyph into 8 bits coverage values.
+// * @param: *font : the PSF font.
+// * @param: glyph : index of the glyph.
+// * @param: s     : downscale factor.
+// * @param: *cov  : output, ow * oh coverage values.
+// * @param: ow    : width of the output.
+// * @param: oh    : height of the output.
+static void glyph_coverage(PSF_FONT_t* font, uint_t glyph, uint_t s,
+                           uint8_t* cov, uint_t ow, uint_t oh)
+{
+    const uint8_t* bits;
+    uint_t         x;
+    uint_t         y;
+    uint_t         i;
+    uint_t         j;
+    uint_t         n;
+
+    bits = font->glyphs + glyph * font->charsize;
+    for (y = 0; y < oh; y++)
+    {
+        for (x = 0; x < ow; x++)
+        {
+            // Pixels outside the font count as empty.
+            n = 0;
+            for (i = y * s; i < (y + 1) * s && i < font->height; i++)
+                for (j = x * s; j < (x + 1) * s && j < font->width; j++)
+                    if (bits[i * font->row_bytes + (j >> 3)] & (0x80 >> (j & 7)))
+                        n++;
+
+            cov[y * ow + x] = (n * 255 + s * s / 2) / (s * s);
+        }
+    }
+
+    return;
+}
+
+
+// * Append the trimmed bitmap of a glyph to the bitmap buffer.
+// * @param: *g     : the glyph entry, filled with the bitmap metrics.
+// * @param: *cov   : ow * oh coverage values.
+// * @param: ow     : width of the coverage grid.
+// * @param: oh     : height of the coverage grid.
+// * @param: bpp    : 4 or 8.
+// * @param: **buf  : the bitmap buffer, grown as needed.
+// * @param: *size  : size of the buffer in bytes.
+// * @return: 1 in case of an error, 0 otherwise.
+static int glyph_pack(ATLAS_GLYPH_t* g, const uint8_t* cov, uint_t ow,
+                      uint_t oh, uint_t bpp, uint8_t** buf, size_t* size)
+{
+    uint8_t* tmp;
+    uint8_t* dst;
+    uint_t   x0;
+    uint_t   y0;
+    uint_t   x1;
+    uint_t   y1;
+    uint_t   pitch;
+    uint_t   x;
+    uint_t   y;
+    uint8_t  v;
+
+    // Trim the grid to the ink of the glyph.
+    x0 = ow;
+    y0 = oh;
+    x1 = 0;
+    y1 = 0;
+    for (y = 0; y < oh; y++)
+    {
+        for (x = 0; x < ow; x++)
+        {
+            if (!cov[y * ow + x])
+                continue;
+
+            x0 = x < x0 ? x : x0;
+            y0 = y < y0 ? y : y0;
+            x1 = x + 1 > x1 ? x + 1 : x1;
+            y1 = y + 1 > y1 ? y + 1 : y1;
+        }
+    }
+
+    g->offset = *size;
+    if (x0 >= x1)
+    {
+        g->w = 0;
+        g->h = 0;
+        g->off_x = 0;
+        g->off_y = 0;
+        return 0;
+    }
+
+    g->w = x1 - x0;
+    g->h = y1 - y0;
+    g->off_x = x0;
+    g->off_y = y0;
+
+    pitch = bpp == 4 ? (g->w + 1) / 2 : g->w;
+    tmp = realloc(*buf, *size + pitch * g->h);
+    if (!tmp)
+        return 1;
+
+    *buf = tmp;
+    dst = *buf + *size;
+    memset(dst, 0, pitch * g->h);
+    for (y = 0; y < g->h; y++)
+    {
+        for (x = 0; x < g->w; x++)
+        {
+            v = cov[(y + y0) * ow + x + x0];
+            if (bpp == 8)
+                dst[y * pitch + x] = v;
+
+            else
+                dst[y * pitch + (x >> 1)] |= ((v * 15 + 127) / 255)
+                                             << (x & 1 ? 0 : 4);
+        }
+    }
+
+    *size += pitch * g->h;
+    return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+    ATLAS_HEADER_t hdr;
+    ATLAS_GLYPH_t* glyphs;
+    ATLAS_KERN_t*  kerns;
+    PSF_FONT_t     font;
+    FILE*          out;
+    uint8_t*       bitmaps;
+    uint8_t*       cov;
+    size_t         bitmap_size;
+    const char*    kern_path;
+    uint32_t       cp;
+    uint_t         bpp;
+    uint_t         s;
+    uint_t         ow;
+    uint_t         oh;
+    uint_t         n;
+    uint_t         r;
+    int            nkern;
+    int            opt;
+
+    bpp = 8;
+    s = 2;
+    kern_path = NULL;
+    while ((opt = getopt(argc, argv, "4s:k:h")) != -1)
+    {
+        switch (opt)
+        {
+            case '4':
+                bpp = 4;
+                break;
+
+            case 's':
+                s = atoi(optarg);
+                break;
+
+            case 'k':
+                kern_path = optarg;
+                break;
+
+            default:
+                usage();
+                return opt != 'h';
+        }
+    }
+
+    if (argc - optind != 2 || !s)
+    {
+        usage();
+        return 1;
+    }
+
+    if (psf_load(&font, argv[optind]))
+        return 1;
+
+    kerns = NULL;
+    nkern = 0;
+    if (kern_path)
+    {
+        nkern = load_kerning(kern_path, &kerns);
+        if (nkern < 0)
+            return 1;
+    }
+
+    ow = (font.width + s - 1) / s;
+    oh = (font.height + s - 1) / s;
+    n = 0;
+    for (r = 0; r < sizeof(RANGES) / sizeof(RANGES[0]); r++)
+        n += RANGES[r][1] - RANGES[r][0] + 1;
+
+    cov = malloc(ow * oh);
+    glyphs = malloc(sizeof(ATLAS_GLYPH_t) * n);
+    if (!cov || !glyphs)
+        return 1;
+
+    // Export every code point of the ranges the font really has, the ranges
+    // are sorted so the glyph table is too.
+    bitmaps = NULL;
+    bitmap_size = 0;
+    n = 0;
+    for (r = 0; r < sizeof(RANGES) / sizeof(RANGES[0]); r++)
+    {
+        for (cp = RANGES[r][0]; cp <= RANGES[r][1]; cp++)
+        {
+            if (cp != UTF8_REPLACEMENT && !psf_has_glyph(&font, cp))
+                continue;
+
+            glyph_coverage(&font, psf_glyph_index(&font, cp), s, cov, ow, oh);
+            memset(&glyphs[n], 0, sizeof(ATLAS_GLYPH_t));
+            glyphs[n].cp = cp;
+            glyphs[n].advance = ow;
+            if (glyph_pack(&glyphs[n], cov, ow, oh, bpp, &bitmaps,
+                           &bitmap_size))
+                return 1;
+
+            n++;
+        }
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = ATLAS_MAGIC;
+    hdr.version = ATLAS_VERSION;
+    hdr.bpp = bpp;
+    hdr.line_height = oh;
+    hdr.space_advance = ow;
+    hdr.nglyphs = n;
+    hdr.nkern = nkern;
+    hdr.glyph_off = sizeof(hdr);
+    hdr.kern_off = hdr.glyph_off + n * sizeof(ATLAS_GLYPH_t);
+    hdr.bitmap_off = hdr.kern_off + nkern * sizeof(ATLAS_KERN_t);
+
+    out = fopen(argv[optind + 1], "wb");
+    if (!out)
+    {
+        printf("~[ERROR] Opening %s failed.\n", argv[optind + 1]);
+        return 1;
+    }
+
+    fwrite(&hdr, sizeof(hdr), 1, out);
+    fwrite(glyphs, sizeof(ATLAS_GLYPH_t), n, out);
+    if (nkern)
+        fwrite(kerns, sizeof(ATLAS_KERN_t), nkern, out);
+
+    if (bitmap_size)
+        fwrite(bitmaps, 1, bitmap_size, out);
+
+    fclose(out);
+    printf("~%u glyphs, %d kerning pairs, %lu bytes of A%u bitmaps.\n",
+           n, nkern, (unsigned long)bitmap_size, bpp);
+
+    free(glyphs);
+    free(kerns);
+    free(bitmaps);
+    free(cov);
+    psf_free(&font);
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rle_sprite.h"
+
+
+// * Print the usage of the tool.
+static void usage(void)
+{
+    printf("Usage: fbrle [-k RRGGBB] [-c name] <image.ppm> <out>\n");
+    printf("\t-k : transparent color of the image (default FF00FF).\n");
+    printf("\t-c : write a C array called name instead of a sprite file,\n");
+    printf("\t     so the sprite can stay in flash.\n");
+    return;
+}
+
+
+// * Convert a 0xRRGGBB color to 16 bits.
+// * @param: rgb: the color.
+// * @return: the 16 bits color.
+static COLOR_t rgb888_to_565(uint32_t rgb)
+{
+    return ((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x1F);
+}
+
+
+// * Skip the blanks and the comments of a PPM header.
+// * @param: *file: the image.
+static void ppm_skip(FILE* file)
+{
+    int c;
+
+    while ((c = fgetc(file)) != EOF)
+    {
+        if (c == '#')
+            while ((c = fgetc(file)) != EOF && c != '\n')
+                ;
+
+        else if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        {
+            ungetc(c, file);
+            return;
+        }
+    }
+
+    return;
+}
+
+
+// * Read the header of a binary PPM (P6, 8 bits).
+// * @param: *file: the image.
+// * @param: *w   : filled with the width of the image.
+// * @param: *h   : filled with the height of the image.
+// * @return: 1 in case of an error, 0 otherwise.
+static int ppm_header(FILE* file, uint_t* w, uint_t* h)
+{
+    uint_t maxval;
+
+    if (fgetc(file) != 'P' || fgetc(file) != '6')
+        return 1;
+
+    ppm_skip(file);
+    if (fscanf(file, "%u", w) != 1)
+        return 1;
+
+    ppm_skip(file);
+    if (fscanf(file, "%u", h) != 1)
+        return 1;
+
+    ppm_skip(file);
+    if (fscanf(file, "%u", &maxval) != 1 || maxval != 255 || !*w || !*h)
+        return 1;
+
+    // A single blank separates the header from the pixels.
+    fgetc(file);
+    return 0;
+}
+
+
+// * Load a binary PPM as 16 bits colors. A pixel that is not the key but
+// * would be converted to it gets its lowest blue bit flipped.
+// * @param: *path: path of the image.
+// * @param: key  : transparent color as 0xRRGGBB.
+// * @param: *w   : filled with the width of the image.
+// * @param: *h   : filled with the height of the image.
+// * @return: the pixels to free(), NULL in case of an error.
+static COLOR_t* ppm_load(const char* path, uint32_t key, uint_t* w,
+                         uint_t* h)
+{
+    COLOR_t*  pix;
+    FILE*     file;
+    uint8_t   rgb[3];
+    uint_t    i;
+
+    file = fopen(path, "rb");
+    if (!file)
+    {
+        printf("~[ERROR] Opening %s failed.\n", path);
+        return NULL;
+    }
+
+    pix = NULL;
+    if (!ppm_header(file, w, h))
+        pix = malloc(sizeof(COLOR_t) * *w * *h);
+
+    for (i = 0; pix && i < *w * *h; i++)
+    {
+        if (fread(rgb, 1, 3, file) != 3)
+        {
+            free(pix);
+            pix = NULL;
+            break;
+        }
+
+        pix[i] = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3)
+                 | (rgb[2] >> 3);
+        if (pix[i] == rgb888_to_565(key)
+            && ((uint32_t)rgb[0] << 16 | rgb[1] << 8 | rgb[2]) != key)
+            pix[i] ^= 1;
+    }
+
+    if (!pix)
+        printf("~[ERROR] %s is not a 8 bits binary PPM.\n", path);
+
+    fclose(file);
+    return pix;
+}
+
+
+// * Write the sprite as a C array of 32 bits words, which keeps the 4 bytes
+// * alignment rle_sprite_from_memory() needs.
+// * @param: *out : the output file.
+// * @param: *name: name of the array.
+// * @param: *data: the sprite.
+// * @param: size : size of the sprite in bytes.
+static void write_c_array(FILE* out, const char* name, const uint8_t* data,
+                          size_t size)
+{
+    uint32_t word;
+    size_t   i;
+
+    fprintf(out, "// Generated by fbrle, %lu bytes.\n", (unsigned long)size);
+    fprintf(out, "#include <stdint.h>\n\n");
+    fprintf(out, "const uint32_t %s_size = %lu;\n", name, (unsigned long)size);
+    fprintf(out, "const uint32_t %s[] = {", name);
+    for (i = 0; i < size; i += 4)
+    {
+        word = 0;
+        memcpy(&word, data + i, size - i < 4 ? size - i : 4);
+        fprintf(out, "%s0x%08X,", i % 24 ? " " : "\n    ", word);
+    }
+
+    fprintf(out, "\n};\n");
+    return;
+}
+
+
+int main(int argc, char** argv)
+{
+    COLOR_t*    pix;
+    uint8_t*    data;
+    FILE*       out;
+    const char* name;
+    size_t      size;
+    uint32_t    key;
+    uint_t      w;
+    uint_t      h;
+    int         opt;
+
+    key = 0xFF00FF;
+    name = NULL;
+    while ((opt = getopt(argc, argv, "k:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'k':
+                key = strtoul(optarg, NULL, 16) & 0xFFFFFF;
+                break;
+
+            case 'c':
+                name = optarg;
+                break;
+
+            default:
+                usage();
+                return opt != 'h';
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        usage();
+        return 1;
+    }
+
+    pix = ppm_load(argv[optind], key, &w, &h);
+    if (!pix)
+        return 1;
+
+    data = rle_sprite_encode(pix, w, h, rgb888_to_565(key), &size);
+    if (!data)
+    {
+        printf("~[ERROR] Encoding %s failed.\n", argv[optind]);
+        return 1;
+    }
+
+    out = fopen(argv[optind + 1], name ? "w" : "wb");
+    if (!out)
+    {
+        printf("~[ERROR] Opening %s failed.\n", argv[optind + 1]);
+        return 1;
+    }
+
+    if (name)
+        write_c_array(out, name, data, size);
+
+    else
+        fwrite(data, 1, size, out);
+
+    fclose(out);
+    printf("~%ux%u: %lu bytes, raw %lu bytes\n", w, h, (unsigned long)size,
+           (unsigned long)(sizeof(COLOR_t) * w * h));
+    free(data);
+    free(pix);
+    return 0;
+}